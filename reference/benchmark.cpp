@@ -0,0 +1,285 @@
+#include "bevel.h"
+#include "bisect.h"
+#include "boundary.h"
+#include "collapse.h"
+#include "decimation.h"
+#include "extrude.h"
+#include "falloff.h"
+#include "geodesic.h"
+#include "mesh.h"
+#include "mesh_cache.h"
+#include "mesh_map.h"
+#include "smoothing.h"
+#include "snapshot.h"
+#include "subdivision.h"
+#include "topology.h"
+#include "uv_seams.h"
+#include "weld.h"
+
+#include <lx_value.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+
+// Times the wrapper hot paths on a torus held by the reference mesh and
+// checks their results; the exit code is the number of failed checks.
+// Usage: wrapper_benchmark [segments = 256] [host call cost in ns = 50]
+namespace {
+	int Failures = 0;
+
+	void Check(const char* name, bool passed)
+	{
+		if (!passed) {
+			std::printf("  check failed: %s\n", name);
+			++Failures;
+		}
+	}
+
+	bool Closed(TMesh& mesh)
+	{
+		const TMeshSnapshot snapshot(mesh);
+		const TTopology topology(snapshot);
+		return TBoundaryLoops(topology).Loops().empty();
+	}
+
+	// material tags show whether created polygons take after their source
+	void Tag(TMesh& mesh)
+	{
+		auto polygon = mesh.InitPolygon();
+		CLxUser_StringTag tag(polygon);
+		for (unsigned index = 0; index < mesh.PolygonCount(); ++index) {
+			polygon.SelectByIndex(index);
+			tag.Set(LXi_PTAG_MATR, "Torus");
+		}
+	}
+
+	bool Tagged(TMesh& mesh)
+	{
+		auto polygon = mesh.InitPolygon();
+		CLxUser_StringTag tag(polygon);
+		const char* material = nullptr;
+		for (unsigned index = 0; index < mesh.PolygonCount(); ++index) {
+			polygon.SelectByIndex(index);
+			if (!LXx_OK(tag.Get(LXi_PTAG_MATR, &material))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Run(const char* name, const std::function<void()>& lambda)
+	{
+		NReference::ResetCallCount();
+		const auto start = std::chrono::steady_clock::now();
+		lambda();
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::printf("%-28s %10.2f ms %12llu calls\n", name, elapsed.count(), static_cast<unsigned long long>(NReference::CallCount()));
+	}
+
+	// quads only, every point has valence 4
+	void Torus(TMesh& mesh, unsigned segments)
+	{
+		const unsigned sides = std::max(3u, segments / 4);
+		std::vector<LXtPointID> points;
+		mesh.BeginEditBatch();
+		for (unsigned ring = 0; ring < segments; ++ring) {
+			const float u = 6.2831853f * ring / segments;
+			for (unsigned side = 0; side < sides; ++side) {
+				const float v = 6.2831853f * side / sides;
+				const float radius = 1.0f + 0.3f * std::cos(v);
+				points.push_back(mesh.CreatePoint(TVectorF(radius * std::cos(u), 0.3f * std::sin(v), radius * std::sin(u))));
+			}
+		}
+		for (unsigned ring = 0; ring < segments; ++ring) {
+			const unsigned next = (ring + 1) % segments;
+			for (unsigned side = 0; side < sides; ++side) {
+				const unsigned up = (side + 1) % sides;
+				mesh.CreatePolygon({points[ring * sides + side], points[ring * sides + up], points[next * sides + up], points[next * sides + side]});
+			}
+		}
+		mesh.EndEditBatch();
+	}
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+	const unsigned segments = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 256;
+	NReference::SetCallCost(argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 50);
+
+	CLxUser_Mesh userMesh = CLxUser_Mesh::Create();
+	CLxUser_LayerScan layerScan;
+	TMesh::InitModes();
+	TMesh mesh(userMesh, layerScan, 0);
+
+	Run("build torus", [&]() {
+		Torus(mesh, segments);
+	});
+	std::printf("%u points, %u polygons, %u edges\n", mesh.PointCount(), mesh.PolygonCount(), mesh.EdgeCount());
+
+	std::unique_ptr<TMeshSnapshot> snapshot;
+	Run("snapshot", [&]() {
+		snapshot = std::make_unique<TMeshSnapshot>(mesh);
+	});
+
+	std::unique_ptr<TTopology> topology;
+	Run("topology", [&]() {
+		topology = std::make_unique<TTopology>(*snapshot);
+	});
+
+	TBitSet half(snapshot->PolygonCount());
+	for (unsigned polygon = 0; polygon < snapshot->PolygonCount() / 2; ++polygon) {
+		half.Set(polygon);
+	}
+	Run("mark polygons", [&]() {
+		snapshot->MarkPolygons(mesh, half, TMesh::ModeSelect);
+	});
+	Run("read marked polygons", [&]() {
+		snapshot->MarkedPolygons(mesh, TMesh::ModeSelect);
+	});
+
+	// the cache tracks every edit below until it goes out of scope
+	auto cache = std::make_unique<TMeshCache>(mesh);
+	Run("taubin x10 + write", [&]() {
+		std::vector<TVectorF> positions = snapshot->Positions;
+		TSmoothing(*topology).Taubin(positions, 10);
+		snapshot->SetPositions(mesh, positions);
+	});
+	Run("cache refresh, all moved", [&]() {
+		Check("cache rebuilds past the ratio", cache->Refresh() == TMeshCache::ERefresh::Rebuild);
+	});
+
+	std::vector<unsigned> edges;
+	auto refresh = [&]() {
+		snapshot = std::make_unique<TMeshSnapshot>(mesh);
+		topology = std::make_unique<TTopology>(*snapshot);
+		edges.clear();
+		for (unsigned edge = 0; edge < topology->EdgeCount(); edge += 7) {
+			edges.push_back(edge);
+		}
+	};
+
+	refresh();
+	Run("falloff + write", [&]() {
+		TBitSet selected(snapshot->PointCount());
+		selected.Set(0);
+		std::vector<float> weights(snapshot->PointCount());
+		TFalloff::Selection(snapshot->Positions, selected, 0.3f, TFalloff::EShape::Smooth).Evaluate(snapshot->Positions, weights);
+		std::vector<TVectorF> raised = snapshot->Positions;
+		for (auto& pos : raised) {
+			pos.y += 0.1f;
+		}
+		std::vector<TVectorF> positions;
+		TFalloffStack::Blend(snapshot->Positions, raised, weights, positions);
+		snapshot->SetPositions(mesh, positions);
+	});
+	Run("cache refresh, falloff", [&]() {
+		Check("cache patches a local move", cache->Refresh() == TMeshCache::ERefresh::Patch);
+	});
+	refresh();
+	Check("patched positions match the mesh", cache->Snapshot().Positions == snapshot->Positions);
+	Check("cached topology matches the mesh", cache->Topology().EdgeCount() == topology->EdgeCount());
+	cache.reset();
+
+	Run("uv write + seams", [&]() {
+		LXtMeshMapID id;
+		mesh.InitMeshMap().New(LXi_VMAP_TEXTUREUV, "Texture", &id);
+		TMeshMapView uv(mesh, *snapshot, LXi_VMAP_TEXTUREUV, "Texture");
+		for (unsigned point = 0; point < snapshot->PointCount(); ++point) {
+			const TVectorF& pos = snapshot->Positions[point];
+			uv.PointSet[point] = 1;
+			uv.PointValues[2 * point] = 0.5f + std::atan2(pos.z, pos.x) / 6.2831853f;
+			uv.PointValues[2 * point + 1] = pos.y;
+		}
+		uv.Commit(mesh);
+
+		const TMeshMapView read(mesh, *snapshot, LXi_VMAP_TEXTUREUV, "Texture");
+		const TUVSeams seams(*topology, read);
+		Check("uv values round trip", read.PointValues == uv.PointValues);
+		Check("continuous uvs have no seams", !seams.Seams.Count() && seams.IslandCount() == 1);
+	});
+
+	Run("subdivide level 2", [&]() {
+		TSubdivision subdivision(*topology, 2);
+		subdivision.Evaluate();
+	});
+
+	Run("edge distance", [&]() {
+		TBitSet seeds(snapshot->PointCount());
+		seeds.Set(0);
+		TEdgeDistance(*topology).Distances(seeds);
+	});
+
+	Run("heat distance", [&]() {
+		TBitSet seeds(snapshot->PointCount());
+		seeds.Set(0);
+		const std::vector<float> distances = THeatDistance(*topology).Distances(seeds);
+		Check("heat reaches the whole torus", std::all_of(distances.begin(), distances.end(), [](float distance) {
+			return std::isfinite(distance);
+		}));
+	});
+
+	Run("weld", [&]() {
+		TWeld(*snapshot, 1e-6f);
+	});
+
+	// each edit below is planned on a fresh snapshot of the edited mesh
+	Tag(mesh);
+	Run("extrude half + apply", [&]() {
+		TExtrude extrude(*topology, half, 0.05f);
+		extrude.Apply(mesh);
+		Check("extrude adds its points", mesh.PointCount() == snapshot->PointCount() + extrude.NewPointCount());
+	});
+	Check("closed after extrude", Closed(mesh));
+	Check("extrude keeps material tags", Tagged(mesh));
+
+	refresh();
+	Run("collapse + apply", [&]() {
+		TEdgeCollapse(*topology, edges).Apply(mesh);
+	});
+	Check("closed after collapse", Closed(mesh));
+
+	refresh();
+	Run("dissolve + apply", [&]() {
+		TEdgeDissolve(*topology, edges).Apply(mesh);
+	});
+	Check("closed after dissolve", Closed(mesh));
+
+	refresh();
+	Run("bevel + apply", [&]() {
+		TBevel bevel(*topology, edges, 0.002f, 2);
+		bevel.Apply(mesh);
+		const size_t created = bevel.CreatedStart.size() - 1;
+		Check("bevel point count", mesh.PointCount() == snapshot->PointCount() + bevel.NewPointCount() - bevel.Unused.size());
+		Check("bevel polygon count", mesh.PolygonCount() == snapshot->PolygonCount() + created);
+	});
+	Check("closed after bevel", Closed(mesh));
+
+	refresh();
+	Run("decimate half + apply", [&]() {
+		TDecimation decimation(*topology);
+		decimation.Run(topology->PolygonCount() / 2);
+		decimation.Apply(mesh);
+		Check("decimation polygon count", mesh.PolygonCount() == decimation.PolygonCount());
+		Check("decimation point count", mesh.PointCount() <= snapshot->PointCount() - decimation.RemovedPointCount());
+	});
+	Check("closed after decimation", Closed(mesh));
+
+	// a side cut crosses the ring twice, giving two separate caps
+	refresh();
+	Tag(mesh);
+	Run("bisect + fill + apply", [&]() {
+		TBisect bisect(*topology, {glm::vec4(1.0f, 0.0f, 0.0f, -0.05f)}, TBisect::EKeep::Above, true);
+		bisect.Apply(mesh);
+		Check("bisect polygon count", mesh.PolygonCount() == bisect.Result.PolygonCount());
+	});
+	Check("no boundary after fill", Closed(mesh));
+	Check("bisect keeps material tags", Tagged(mesh));
+	std::printf("%u points, %u polygons, %u edges\n", mesh.PointCount(), mesh.PolygonCount(), mesh.EdgeCount());
+
+	return Failures;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "lx_mesh.hpp"
+#include "lxu_matrix.hpp"
+
+// Layer scan of the reference mesh: change flags are kept, Update clears them.
+class CLxUser_LayerScan
+{
+public:
+	LxResult SetMeshChange(unsigned index, unsigned change);
+	LxResult Update();
+	LxResult MeshTransform(unsigned index, CLxMatrix4& matrix);
+
+	unsigned PendingChange() const;
+
+private:
+	unsigned Change = 0;
+};
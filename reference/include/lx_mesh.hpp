@@ -0,0 +1,199 @@
+#pragma once
+
+#include <lxmesh.h>
+#include <lxresult.h>
+
+#include "lx_visitor.hpp"
+
+#include <cstdint>
+#include <memory>
+
+// In-memory stand-in for the SDK mesh wrappers, covering the point, edge,
+// polygon, tag and mark calls the wrapper makes. Elements live in their own heap
+// nodes and every call goes through an out of line function that is counted
+// and pays the configured host call cost. Mesh maps keep values per point
+// and per polygon corner, and trackers log the elements edited while they
+// are started.
+namespace NReference {
+	class TMeshStore;
+	struct TPointNode;
+	struct TPolygonNode;
+	struct TEdgeNode;
+	struct TMapNode;
+	struct TChangeLog;
+
+	// busy wait added to every call, 0 by default
+	void SetCallCost(unsigned nanoseconds);
+	uint64_t CallCount();
+	void ResetCallCount();
+} // namespace NReference
+
+class CLxUser_MeshTracker;
+
+class CLxUser_Mesh
+{
+public:
+	CLxUser_Mesh() = default;
+	CLxUser_Mesh(ILxUnknownID obj);
+	explicit CLxUser_Mesh(std::shared_ptr<NReference::TMeshStore> store);
+
+	// empty mesh owned by the returned handle and its copies
+	static CLxUser_Mesh Create();
+
+	bool test() const;
+	operator ILxUnknownID() const;
+
+	int NPoints() const;
+	int NPolygons() const;
+	int NEdges() const;
+
+	LxResult BeginEditBatch();
+	LxResult EndEditBatch();
+	LxResult TrackChanges(CLxUser_MeshTracker& tracker);
+
+public:
+	std::shared_ptr<NReference::TMeshStore> Store;
+};
+
+class CLxUser_Point
+{
+public:
+	bool test() const;
+	bool fromMesh(CLxUser_Mesh& mesh);
+
+	LxResult Enumerate(LXtMarkMode mode, CLxVisitor& visitor, ILxUnknownID monitor);
+	LxResult TestMarks(LXtMarkMode mode) const;
+	LxResult SetMarks(LXtMarkMode mode);
+
+	LxResult Select(LXtPointID point);
+	LxResult SelectByIndex(unsigned index);
+	LXtPointID ID() const;
+	LxResult Index(unsigned* index) const;
+	LxResult Pos(float* pos) const;
+	LxResult SetPos(const double* pos);
+	LxResult New(const double* pos, LXtPointID* point);
+	LxResult Remove();
+
+	LxResult PolygonCount(unsigned* count) const;
+	LxResult PolygonByIndex(unsigned index, LXtPolygonID* polygon) const;
+	LxResult EdgeCount(unsigned* count) const;
+	LxResult EdgeByIndex(unsigned index, LXtEdgeID* edge) const;
+	LxResult Mesh(CLxUser_Mesh& mesh) const;
+
+	LxResult MapValue(LXtMeshMapID map, float* value);
+	LxResult SetMapValue(LXtMeshMapID map, const float* value);
+	LxResult ClearMapValue(LXtMeshMapID map);
+
+private:
+	std::shared_ptr<NReference::TMeshStore> Store;
+	NReference::TPointNode* Node = nullptr;
+};
+
+class CLxUser_Polygon
+{
+public:
+	bool test() const;
+	bool fromMesh(CLxUser_Mesh& mesh);
+
+	LxResult Enumerate(LXtMarkMode mode, CLxVisitor& visitor, ILxUnknownID monitor);
+	LxResult TestMarks(LXtMarkMode mode) const;
+	LxResult SetMarks(LXtMarkMode mode);
+
+	LxResult Select(LXtPolygonID polygon);
+	LxResult SelectByIndex(unsigned index);
+	LXtPolygonID ID() const;
+	LxResult Index(int* index) const;
+	LxResult Type(LXtID4* type) const;
+	LxResult VertexCount(unsigned* count) const;
+	LxResult VertexByIndex(unsigned index, LXtPointID* point) const;
+	LxResult Normal(double* normal) const;
+	LxResult New(LXtID4 type, const LXtPointID* points, unsigned count, unsigned reverse, LXtPolygonID* polygon);
+	// like New, with the tags of the selected polygon
+	LxResult NewProto(LXtID4 type, const LXtPointID* points, unsigned count, unsigned reverse, LXtPolygonID* polygon);
+	LxResult SetVertexList(const LXtPointID* points, unsigned count, unsigned reverse);
+	LxResult Remove();
+	LxResult Mesh(CLxUser_Mesh& mesh) const;
+
+	LxResult MapValue(LXtMeshMapID map, LXtPointID point, float* value);
+	LxResult SetMapValue(LXtPointID point, LXtMeshMapID map, const float* value);
+	LxResult ClearMapValue(LXtPointID point, LXtMeshMapID map);
+
+private:
+	friend class CLxUser_StringTag;
+
+	std::shared_ptr<NReference::TMeshStore> Store;
+	NReference::TPolygonNode* Node = nullptr;
+};
+
+class CLxUser_Edge
+{
+public:
+	CLxUser_Edge() = default;
+	CLxUser_Edge(std::nullptr_t) {}
+
+	bool test() const;
+	bool fromMesh(CLxUser_Mesh& mesh);
+
+	LxResult Enumerate(LXtMarkMode mode, CLxVisitor& visitor, ILxUnknownID monitor);
+	LxResult TestMarks(LXtMarkMode mode) const;
+	LxResult SetMarks(LXtMarkMode mode);
+
+	LxResult Select(LXtEdgeID edge);
+	LxResult SelectEndpoints(LXtPointID a, LXtPointID b);
+	LXtEdgeID ID() const;
+	LxResult Index(unsigned* index) const;
+	LxResult Endpoints(LXtPointID* a, LXtPointID* b) const;
+	LxResult PolygonCount(unsigned* count) const;
+	LxResult PolygonByIndex(unsigned index, LXtPolygonID* polygon) const;
+	LxResult Mesh(CLxUser_Mesh& mesh) const;
+
+private:
+	std::shared_ptr<NReference::TMeshStore> Store;
+	NReference::TEdgeNode* Node = nullptr;
+};
+
+class CLxUser_MeshMap
+{
+public:
+	bool test() const;
+	bool fromMesh(CLxUser_Mesh& mesh);
+
+	// a null name selects the first map of the type
+	LxResult SelectByName(LXtID4 type, const char* name);
+	// selects the existing map when there is one
+	LxResult New(LXtID4 type, const char* name, LXtMeshMapID* map);
+	LXtMeshMapID ID() const;
+	LxResult Dimension(unsigned* dimension) const;
+	LxResult IsContinuous() const;
+
+private:
+	std::shared_ptr<NReference::TMeshStore> Store;
+	NReference::TMapNode* Node = nullptr;
+};
+
+// edits are logged while started; edit masks are LXf_ELTEDIT_*, 0 for all
+class CLxUser_MeshTracker
+{
+public:
+	LxResult Start();
+	LxResult Stop();
+	LxResult Active() const;
+	LxResult Reset();
+	// LXf_MESHEDIT_* flags of the logged edits
+	LxResult Changes(unsigned* edit);
+	LxResult EnumeratePoints(unsigned edit, CLxVisitor& visitor, CLxUser_Point& point);
+	LxResult EnumeratePolygons(unsigned edit, CLxVisitor& visitor, CLxUser_Polygon& polygon);
+
+private:
+	friend class CLxUser_Mesh;
+
+	std::shared_ptr<NReference::TMeshStore> Store;
+	std::shared_ptr<NReference::TChangeLog> Log;
+};
+
+class CLxUser_MeshService
+{
+public:
+	// set and clear mark names, either may be null
+	LxResult ModeCompose(const char* set, const char* clear, LXtMarkMode* mode);
+};
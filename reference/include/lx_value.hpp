@@ -0,0 +1,23 @@
+#pragma once
+
+#include "lx_mesh.hpp"
+
+// String tags of the polygon selected in the accessor it was set from, so
+// it follows later selections like the SDK interface queried from it.
+class CLxUser_StringTag
+{
+public:
+	CLxUser_StringTag() = default;
+	explicit CLxUser_StringTag(CLxUser_Polygon& polygon);
+
+	bool test() const;
+	bool set(CLxUser_Polygon& polygon);
+
+	// LXe_NOTFOUND when the polygon has no tag of the type
+	LxResult Get(LXtID4 type, const char** tag) const;
+	// tag is null to clear
+	LxResult Set(LXtID4 type, const char* tag);
+
+private:
+	CLxUser_Polygon* Polygon = nullptr;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <lxresult.h>
+
+// Visitor passed to the reference Enumerate calls, same contract as the SDK one.
+class CLxVisitor
+{
+public:
+	virtual ~CLxVisitor() = default;
+
+	virtual void evaluate() {}
+	virtual LxResult eval_RC()
+	{
+		evaluate();
+		return LXe_OK;
+	}
+};
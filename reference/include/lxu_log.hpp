@@ -0,0 +1,19 @@
+#pragma once
+
+#include <lxresult.h>
+
+#include <sstream>
+#include <string>
+
+// Log messages of the reference build go to stderr.
+class CLxLogMessage
+{
+public:
+	virtual ~CLxLogMessage() = default;
+
+	void Info(const char* msg);
+	void Info(const std::string& msg)
+	{
+		Info(msg.c_str());
+	}
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+// Identity by default, the only transform the reference layer scan reports.
+class CLxMatrix4
+{
+public:
+	CLxMatrix4();
+
+	double* operator[](unsigned row);
+	const double* operator[](unsigned row) const;
+
+private:
+	double Values[4][4];
+};
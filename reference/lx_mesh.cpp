@@ -0,0 +1,735 @@
+#include <lx_layer.hpp>
+#include <lx_mesh.hpp>
+#include <lx_value.hpp>
+#include <lxu_log.hpp>
+#include <lxu_matrix.hpp>
+
+#include "mesh_store.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace NReference;
+
+namespace {
+	// visits unremoved nodes passing the mode, removals are renumbered afterwards
+	template<typename TNode>
+	LxResult Visit(TMeshStore& store, std::vector<std::unique_ptr<TNode>>& nodes, TNode*& selected, LXtMarkMode mode, CLxVisitor& visitor)
+	{
+		Call();
+		store.Settle();
+		store.BeginBatch();
+		LxResult result = LXe_OK;
+		const size_t count = nodes.size();
+		for (size_t index = 0; index < count && LXx_OK(result); ++index) {
+			TNode* node = nodes[index].get();
+			if (node->Removed || !TestMarks(node->Marks, mode)) {
+				continue;
+			}
+			selected = node;
+			result = visitor.eval_RC();
+		}
+		store.EndBatch();
+		return LXx_OK(result) ? LXe_OK : result;
+	}
+
+	// visits the logged elements matching edit, 0 matches all
+	template<typename TNode, typename F>
+	LxResult VisitEdits(TMeshStore& store, const TEditList<TNode>& list, unsigned edit, CLxVisitor& visitor, F&& select)
+	{
+		Call();
+		store.BeginBatch();
+		// the visitor may edit and log more elements
+		const auto entries = list.Entries;
+		LxResult result = LXe_OK;
+		for (size_t index = 0; index < entries.size() && LXx_OK(result); ++index) {
+			if (edit && !(entries[index].second & edit)) {
+				continue;
+			}
+			select(entries[index].first);
+			result = visitor.eval_RC();
+		}
+		store.EndBatch();
+		return LXx_OK(result) ? LXe_OK : result;
+	}
+
+	// copies the stored value, LXe_FALSE when there is none
+	template<typename TKey, typename TValues>
+	LxResult ReadValue(const TValues& values, const TKey& key, float* value)
+	{
+		const auto found = values.find(key);
+		if (found == values.end()) {
+			return LXe_FALSE;
+		}
+		std::copy(found->second.begin(), found->second.end(), value);
+		return LXe_OK;
+	}
+
+	template<typename TNode>
+	LxResult SelectIndex(TMeshStore& store, std::vector<std::unique_ptr<TNode>>& nodes, TNode*& selected, unsigned index)
+	{
+		Call();
+		store.Settle();
+		if (index >= nodes.size() || nodes[index]->Removed) {
+			return LXe_OUTOFBOUNDS;
+		}
+		selected = nodes[index].get();
+		return LXe_OK;
+	}
+} // anonymous namespace
+
+CLxUser_Mesh::CLxUser_Mesh(ILxUnknownID obj)
+{
+	if (obj) {
+		Store = reinterpret_cast<TMeshStore*>(obj)->shared_from_this();
+	}
+}
+
+CLxUser_Mesh::CLxUser_Mesh(std::shared_ptr<TMeshStore> store)
+	: Store(std::move(store))
+{
+}
+
+CLxUser_Mesh CLxUser_Mesh::Create()
+{
+	return CLxUser_Mesh(std::make_shared<TMeshStore>());
+}
+
+bool CLxUser_Mesh::test() const
+{
+	return Store != nullptr;
+}
+
+CLxUser_Mesh::operator ILxUnknownID() const
+{
+	return reinterpret_cast<ILxUnknownID>(Store.get());
+}
+
+int CLxUser_Mesh::NPoints() const
+{
+	Call();
+	return static_cast<int>(Store->PointCount());
+}
+
+int CLxUser_Mesh::NPolygons() const
+{
+	Call();
+	return static_cast<int>(Store->PolygonCount());
+}
+
+int CLxUser_Mesh::NEdges() const
+{
+	Call();
+	return static_cast<int>(Store->EdgeCount());
+}
+
+LxResult CLxUser_Mesh::BeginEditBatch()
+{
+	Call();
+	Store->BeginBatch();
+	return LXe_OK;
+}
+
+LxResult CLxUser_Mesh::EndEditBatch()
+{
+	Call();
+	Store->EndBatch();
+	return LXe_OK;
+}
+
+LxResult CLxUser_Mesh::TrackChanges(CLxUser_MeshTracker& tracker)
+{
+	Call();
+	tracker.Store = Store;
+	tracker.Log = Store->Track();
+	return LXe_OK;
+}
+
+bool CLxUser_Point::test() const
+{
+	return Store != nullptr;
+}
+
+bool CLxUser_Point::fromMesh(CLxUser_Mesh& mesh)
+{
+	Store = mesh.Store;
+	Node = nullptr;
+	return test();
+}
+
+LxResult CLxUser_Point::Enumerate(LXtMarkMode mode, CLxVisitor& visitor, ILxUnknownID)
+{
+	return Visit(*Store, Store->Points, Node, mode, visitor);
+}
+
+LxResult CLxUser_Point::TestMarks(LXtMarkMode mode) const
+{
+	Call();
+	return NReference::TestMarks(Node->Marks, mode) ? LXe_TRUE : LXe_FALSE;
+}
+
+LxResult CLxUser_Point::SetMarks(LXtMarkMode mode)
+{
+	Call();
+	Node->Marks = ApplyMarks(Node->Marks, mode);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::Select(LXtPointID point)
+{
+	Call();
+	Node = NReference::Node(point);
+	return Node ? LXe_OK : LXe_NOTFOUND;
+}
+
+LxResult CLxUser_Point::SelectByIndex(unsigned index)
+{
+	return SelectIndex(*Store, Store->Points, Node, index);
+}
+
+LXtPointID CLxUser_Point::ID() const
+{
+	Call();
+	return reinterpret_cast<LXtPointID>(Node);
+}
+
+LxResult CLxUser_Point::Index(unsigned* index) const
+{
+	Call();
+	Store->Settle();
+	*index = Node->Index;
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::Pos(float* pos) const
+{
+	Call();
+	for (int axis = 0; axis < 3; ++axis) {
+		pos[axis] = Node->Pos[axis];
+	}
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::SetPos(const double* pos)
+{
+	Call();
+	Store->SetPos(Node, pos);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::New(const double* pos, LXtPointID* point)
+{
+	Call();
+	*point = reinterpret_cast<LXtPointID>(Store->NewPoint(pos));
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::Remove()
+{
+	Call();
+	Store->RemovePoint(Node);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::PolygonCount(unsigned* count) const
+{
+	Call();
+	*count = static_cast<unsigned>(Node->Polygons.size());
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::PolygonByIndex(unsigned index, LXtPolygonID* polygon) const
+{
+	Call();
+	if (index >= Node->Polygons.size()) {
+		return LXe_OUTOFBOUNDS;
+	}
+	*polygon = reinterpret_cast<LXtPolygonID>(Node->Polygons[index]);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::EdgeCount(unsigned* count) const
+{
+	Call();
+	*count = static_cast<unsigned>(Node->Edges.size());
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::EdgeByIndex(unsigned index, LXtEdgeID* edge) const
+{
+	Call();
+	if (index >= Node->Edges.size()) {
+		return LXe_OUTOFBOUNDS;
+	}
+	*edge = reinterpret_cast<LXtEdgeID>(Node->Edges[index]);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::Mesh(CLxUser_Mesh& mesh) const
+{
+	Call();
+	mesh.Store = Store;
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::MapValue(LXtMeshMapID map, float* value)
+{
+	Call();
+	return ReadValue(NReference::Node(map)->PointValues, Node, value);
+}
+
+LxResult CLxUser_Point::SetMapValue(LXtMeshMapID map, const float* value)
+{
+	Call();
+	Store->SetMapValue(NReference::Node(map), nullptr, Node, value);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Point::ClearMapValue(LXtMeshMapID map)
+{
+	Call();
+	Store->SetMapValue(NReference::Node(map), nullptr, Node, nullptr);
+	return LXe_OK;
+}
+
+bool CLxUser_Polygon::test() const
+{
+	return Store != nullptr;
+}
+
+bool CLxUser_Polygon::fromMesh(CLxUser_Mesh& mesh)
+{
+	Store = mesh.Store;
+	Node = nullptr;
+	return test();
+}
+
+LxResult CLxUser_Polygon::Enumerate(LXtMarkMode mode, CLxVisitor& visitor, ILxUnknownID)
+{
+	return Visit(*Store, Store->Polygons, Node, mode, visitor);
+}
+
+LxResult CLxUser_Polygon::TestMarks(LXtMarkMode mode) const
+{
+	Call();
+	return NReference::TestMarks(Node->Marks, mode) ? LXe_TRUE : LXe_FALSE;
+}
+
+LxResult CLxUser_Polygon::SetMarks(LXtMarkMode mode)
+{
+	Call();
+	Node->Marks = ApplyMarks(Node->Marks, mode);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::Select(LXtPolygonID polygon)
+{
+	Call();
+	Node = NReference::Node(polygon);
+	return Node ? LXe_OK : LXe_NOTFOUND;
+}
+
+LxResult CLxUser_Polygon::SelectByIndex(unsigned index)
+{
+	return SelectIndex(*Store, Store->Polygons, Node, index);
+}
+
+LXtPolygonID CLxUser_Polygon::ID() const
+{
+	Call();
+	return reinterpret_cast<LXtPolygonID>(Node);
+}
+
+LxResult CLxUser_Polygon::Index(int* index) const
+{
+	Call();
+	Store->Settle();
+	*index = static_cast<int>(Node->Index);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::Type(LXtID4* type) const
+{
+	Call();
+	*type = Node ? Node->Type : LXiPTYP_FACE;
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::VertexCount(unsigned* count) const
+{
+	Call();
+	*count = static_cast<unsigned>(Node->Vertices.size());
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::VertexByIndex(unsigned index, LXtPointID* point) const
+{
+	Call();
+	if (index >= Node->Vertices.size()) {
+		return LXe_OUTOFBOUNDS;
+	}
+	*point = reinterpret_cast<LXtPointID>(Node->Vertices[index]);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::Normal(double* normal) const
+{
+	Call();
+	double sum[3] = {};
+	const auto& vertices = Node->Vertices;
+	for (size_t vertex = 0; vertex < vertices.size(); ++vertex) {
+		const float* a = vertices[vertex]->Pos;
+		const float* b = vertices[(vertex + 1) % vertices.size()]->Pos;
+		sum[0] += (double(a[1]) - b[1]) * (double(a[2]) + b[2]);
+		sum[1] += (double(a[2]) - b[2]) * (double(a[0]) + b[0]);
+		sum[2] += (double(a[0]) - b[0]) * (double(a[1]) + b[1]);
+	}
+	const double length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+	for (int axis = 0; axis < 3; ++axis) {
+		normal[axis] = length > 0.0 ? sum[axis] / length : 0.0;
+	}
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::New(LXtID4 type, const LXtPointID* points, unsigned count, unsigned reverse, LXtPolygonID* polygon)
+{
+	Call();
+	*polygon = reinterpret_cast<LXtPolygonID>(Store->NewPolygon(type, points, count, reverse != 0));
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::NewProto(LXtID4 type, const LXtPointID* points, unsigned count, unsigned reverse, LXtPolygonID* polygon)
+{
+	Call();
+	*polygon = reinterpret_cast<LXtPolygonID>(Store->NewPolygon(type, points, count, reverse != 0, Node));
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::SetVertexList(const LXtPointID* points, unsigned count, unsigned reverse)
+{
+	Call();
+	Store->SetVertexList(Node, points, count, reverse != 0);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::Remove()
+{
+	Call();
+	Store->RemovePolygon(Node);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::Mesh(CLxUser_Mesh& mesh) const
+{
+	Call();
+	mesh.Store = Store;
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::MapValue(LXtMeshMapID map, LXtPointID point, float* value)
+{
+	Call();
+	return ReadValue(NReference::Node(map)->CornerValues, std::pair<const TPolygonNode*, const TPointNode*>(Node, NReference::Node(point)), value);
+}
+
+LxResult CLxUser_Polygon::SetMapValue(LXtPointID point, LXtMeshMapID map, const float* value)
+{
+	Call();
+	TMapNode* node = NReference::Node(map);
+	if (node->Continuous) {
+		return LXe_FAILED;
+	}
+	Store->SetMapValue(node, Node, NReference::Node(point), value);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Polygon::ClearMapValue(LXtPointID point, LXtMeshMapID map)
+{
+	Call();
+	Store->SetMapValue(NReference::Node(map), Node, NReference::Node(point), nullptr);
+	return LXe_OK;
+}
+
+CLxUser_StringTag::CLxUser_StringTag(CLxUser_Polygon& polygon)
+	: Polygon(&polygon)
+{
+}
+
+bool CLxUser_StringTag::test() const
+{
+	return Polygon != nullptr && Polygon->test();
+}
+
+bool CLxUser_StringTag::set(CLxUser_Polygon& polygon)
+{
+	Polygon = &polygon;
+	return test();
+}
+
+LxResult CLxUser_StringTag::Get(LXtID4 type, const char** tag) const
+{
+	Call();
+	for (const auto& entry : Polygon->Node->Tags) {
+		if (entry.first == type) {
+			*tag = entry.second.c_str();
+			return LXe_OK;
+		}
+	}
+	*tag = nullptr;
+	return LXe_NOTFOUND;
+}
+
+LxResult CLxUser_StringTag::Set(LXtID4 type, const char* tag)
+{
+	Call();
+	Polygon->Store->SetTag(Polygon->Node, type, tag);
+	return LXe_OK;
+}
+
+bool CLxUser_Edge::test() const
+{
+	return Store != nullptr;
+}
+
+bool CLxUser_Edge::fromMesh(CLxUser_Mesh& mesh)
+{
+	Store = mesh.Store;
+	Node = nullptr;
+	return test();
+}
+
+LxResult CLxUser_Edge::Enumerate(LXtMarkMode mode, CLxVisitor& visitor, ILxUnknownID)
+{
+	return Visit(*Store, Store->Edges, Node, mode, visitor);
+}
+
+LxResult CLxUser_Edge::TestMarks(LXtMarkMode mode) const
+{
+	Call();
+	return NReference::TestMarks(Node->Marks, mode) ? LXe_TRUE : LXe_FALSE;
+}
+
+LxResult CLxUser_Edge::SetMarks(LXtMarkMode mode)
+{
+	Call();
+	Node->Marks = ApplyMarks(Node->Marks, mode);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Edge::Select(LXtEdgeID edge)
+{
+	Call();
+	Node = NReference::Node(edge);
+	return Node ? LXe_OK : LXe_NOTFOUND;
+}
+
+LxResult CLxUser_Edge::SelectEndpoints(LXtPointID a, LXtPointID b)
+{
+	Call();
+	TEdgeNode* edge = Store->FindEdge(NReference::Node(a), NReference::Node(b));
+	if (!edge) {
+		return LXe_NOTFOUND;
+	}
+	Node = edge;
+	return LXe_OK;
+}
+
+LXtEdgeID CLxUser_Edge::ID() const
+{
+	Call();
+	return reinterpret_cast<LXtEdgeID>(Node);
+}
+
+LxResult CLxUser_Edge::Index(unsigned* index) const
+{
+	Call();
+	Store->Settle();
+	*index = Node->Index;
+	return LXe_OK;
+}
+
+LxResult CLxUser_Edge::Endpoints(LXtPointID* a, LXtPointID* b) const
+{
+	Call();
+	*a = reinterpret_cast<LXtPointID>(Node->Points[0]);
+	*b = reinterpret_cast<LXtPointID>(Node->Points[1]);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Edge::PolygonCount(unsigned* count) const
+{
+	Call();
+	*count = static_cast<unsigned>(Node->Polygons.size());
+	return LXe_OK;
+}
+
+LxResult CLxUser_Edge::PolygonByIndex(unsigned index, LXtPolygonID* polygon) const
+{
+	Call();
+	if (index >= Node->Polygons.size()) {
+		return LXe_OUTOFBOUNDS;
+	}
+	*polygon = reinterpret_cast<LXtPolygonID>(Node->Polygons[index]);
+	return LXe_OK;
+}
+
+LxResult CLxUser_Edge::Mesh(CLxUser_Mesh& mesh) const
+{
+	Call();
+	mesh.Store = Store;
+	return LXe_OK;
+}
+
+bool CLxUser_MeshMap::test() const
+{
+	return Store != nullptr;
+}
+
+bool CLxUser_MeshMap::fromMesh(CLxUser_Mesh& mesh)
+{
+	Store = mesh.Store;
+	Node = nullptr;
+	return test();
+}
+
+LxResult CLxUser_MeshMap::SelectByName(LXtID4 type, const char* name)
+{
+	Call();
+	Node = Store->FindMap(type, name);
+	return Node ? LXe_OK : LXe_NOTFOUND;
+}
+
+LxResult CLxUser_MeshMap::New(LXtID4 type, const char* name, LXtMeshMapID* map)
+{
+	Call();
+	Node = Store->NewMap(type, name);
+	*map = reinterpret_cast<LXtMeshMapID>(Node);
+	return LXe_OK;
+}
+
+LXtMeshMapID CLxUser_MeshMap::ID() const
+{
+	Call();
+	return reinterpret_cast<LXtMeshMapID>(Node);
+}
+
+LxResult CLxUser_MeshMap::Dimension(unsigned* dimension) const
+{
+	Call();
+	*dimension = Node ? Node->Dimension : 0;
+	return Node ? LXe_OK : LXe_NOTFOUND;
+}
+
+LxResult CLxUser_MeshMap::IsContinuous() const
+{
+	Call();
+	return Node && Node->Continuous ? LXe_TRUE : LXe_FALSE;
+}
+
+LxResult CLxUser_MeshTracker::Start()
+{
+	Call();
+	Log->Active = true;
+	return LXe_OK;
+}
+
+LxResult CLxUser_MeshTracker::Stop()
+{
+	Call();
+	Log->Active = false;
+	return LXe_OK;
+}
+
+LxResult CLxUser_MeshTracker::Active() const
+{
+	Call();
+	return Log->Active ? LXe_TRUE : LXe_FALSE;
+}
+
+LxResult CLxUser_MeshTracker::Reset()
+{
+	Call();
+	Log->Changes = 0;
+	Log->Points.Clear();
+	Log->Polygons.Clear();
+	return LXe_OK;
+}
+
+LxResult CLxUser_MeshTracker::Changes(unsigned* edit)
+{
+	Call();
+	*edit = Log->Changes;
+	return LXe_OK;
+}
+
+LxResult CLxUser_MeshTracker::EnumeratePoints(unsigned edit, CLxVisitor& visitor, CLxUser_Point& point)
+{
+	return VisitEdits(*Store, Log->Points, edit, visitor, [&point](TPointNode* node) {
+		point.Select(reinterpret_cast<LXtPointID>(node));
+	});
+}
+
+LxResult CLxUser_MeshTracker::EnumeratePolygons(unsigned edit, CLxVisitor& visitor, CLxUser_Polygon& polygon)
+{
+	return VisitEdits(*Store, Log->Polygons, edit, visitor, [&polygon](TPolygonNode* node) {
+		polygon.Select(reinterpret_cast<LXtPolygonID>(node));
+	});
+}
+
+LxResult CLxUser_MeshService::ModeCompose(const char* set, const char* clear, LXtMarkMode* mode)
+{
+	Call();
+	*mode = ComposeMode(set, clear);
+	return LXe_OK;
+}
+
+LxResult CLxUser_LayerScan::SetMeshChange(unsigned, unsigned change)
+{
+	Call();
+	Change |= change;
+	return LXe_OK;
+}
+
+LxResult CLxUser_LayerScan::Update()
+{
+	Call();
+	Change = 0;
+	return LXe_OK;
+}
+
+LxResult CLxUser_LayerScan::MeshTransform(unsigned, CLxMatrix4& matrix)
+{
+	Call();
+	matrix = CLxMatrix4();
+	return LXe_OK;
+}
+
+unsigned CLxUser_LayerScan::PendingChange() const
+{
+	return Change;
+}
+
+CLxMatrix4::CLxMatrix4()
+{
+	for (unsigned row = 0; row < 4; ++row) {
+		for (unsigned column = 0; column < 4; ++column) {
+			Values[row][column] = row == column ? 1.0 : 0.0;
+		}
+	}
+}
+
+double* CLxMatrix4::operator[](unsigned row)
+{
+	return Values[row];
+}
+
+const double* CLxMatrix4::operator[](unsigned row) const
+{
+	return Values[row];
+}
+
+void CLxLogMessage::Info(const char* msg)
+{
+	std::fprintf(stderr, "%s\n", msg);
+}
@@ -0,0 +1,500 @@
+#include "mesh_store.h"
+
+#include <lx_mesh.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iterator>
+
+namespace NReference {
+
+	namespace {
+		std::atomic<uint64_t> Calls{0};
+		std::atomic<unsigned> Cost{0};
+
+		constexpr const char* MarkNames[] = {
+			LXsMARK_HIDE,
+			LXsMARK_HALO,
+			LXsMARK_LOCK,
+			LXsMARK_SELECT,
+			LXsMARK_DELTA,
+			LXsMARK_USER_0,
+			LXsMARK_USER_1,
+			LXsMARK_USER_2,
+			LXsMARK_USER_3,
+			LXsMARK_USER_4,
+			LXsMARK_USER_5,
+			LXsMARK_USER_6,
+			LXsMARK_USER_7,
+		};
+
+		LXtMarkMode MarkBit(const char* name)
+		{
+			if (!name) {
+				return 0;
+			}
+			for (unsigned bit = 0; bit < std::size(MarkNames); ++bit) {
+				if (!std::strcmp(name, MarkNames[bit])) {
+					return 1u << bit;
+				}
+			}
+			return 0;
+		}
+
+		// per type: dimension, and whether polygons may hold their own values
+		struct TMapType
+		{
+			LXtID4 Type;
+			unsigned Dimension;
+			bool Continuous;
+		};
+
+		constexpr TMapType MapTypes[] = {
+			{LXi_VMAP_TEXTUREUV, 2, false},
+			{LXi_VMAP_WEIGHT, 1, true},
+			{LXi_VMAP_MORPH, 3, true},
+			{LXi_VMAP_SPOT, 3, true},
+			{LXi_VMAP_OBJECTPOS, 3, true},
+			{LXi_VMAP_NORMAL, 3, false},
+			{LXi_VMAP_RGB, 3, false},
+			{LXi_VMAP_RGBA, 4, false},
+			{LXi_VMAP_VECTOR, 3, false},
+			{LXi_VMAP_SUBDIV, 1, true},
+			{LXi_VMAP_PICK, 0, true},
+		};
+
+		unsigned MapChange(LXtID4 type)
+		{
+			switch (type) {
+			case LXi_VMAP_TEXTUREUV:
+				return LXf_MESHEDIT_MAP_UV;
+			case LXi_VMAP_MORPH:
+			case LXi_VMAP_SPOT:
+				return LXf_MESHEDIT_MAP_MORPH;
+			default:
+				return LXf_MESHEDIT_MAP_OTHER;
+			}
+		}
+
+		// drops removed nodes and renumbers the rest, keeping their order;
+		// with retired given, removed nodes are moved there instead of freed
+		template<typename T>
+		void Compact(std::vector<std::unique_ptr<T>>& nodes, std::vector<std::unique_ptr<T>>* retired = nullptr)
+		{
+			const auto kept = std::stable_partition(nodes.begin(), nodes.end(), [](const std::unique_ptr<T>& node) {
+				return !node->Removed;
+			});
+			if (retired) {
+				std::move(kept, nodes.end(), std::back_inserter(*retired));
+			}
+			nodes.erase(kept, nodes.end());
+			for (unsigned index = 0; index < nodes.size(); ++index) {
+				nodes[index]->Index = index;
+			}
+		}
+
+		template<typename T>
+		void Erase(std::vector<T*>& values, const T* value)
+		{
+			const auto found = std::find(values.begin(), values.end(), value);
+			if (found != values.end()) {
+				values.erase(found);
+			}
+		}
+	} // anonymous namespace
+
+	void SetCallCost(unsigned nanoseconds)
+	{
+		Cost.store(nanoseconds, std::memory_order_relaxed);
+	}
+
+	uint64_t CallCount()
+	{
+		return Calls.load(std::memory_order_relaxed);
+	}
+
+	void ResetCallCount()
+	{
+		Calls.store(0, std::memory_order_relaxed);
+	}
+
+	void Call()
+	{
+		Calls.fetch_add(1, std::memory_order_relaxed);
+		const unsigned cost = Cost.load(std::memory_order_relaxed);
+		if (!cost) {
+			return;
+		}
+		const auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(cost);
+		while (std::chrono::steady_clock::now() < until) {
+		}
+	}
+
+	LXtMarkMode ComposeMode(const char* set, const char* clear)
+	{
+		return MarkBit(set) | (MarkBit(clear) << 16);
+	}
+
+	bool TestMarks(LXtMarkMode marks, LXtMarkMode mode)
+	{
+		const LXtMarkMode set = mode & 0xFFFF;
+		const LXtMarkMode clear = mode >> 16;
+		return (marks & set) == set && !(marks & clear);
+	}
+
+	LXtMarkMode ApplyMarks(LXtMarkMode marks, LXtMarkMode mode)
+	{
+		return (marks | (mode & 0xFFFF)) & ~(mode >> 16);
+	}
+
+	template<typename TNode>
+	void TEditList<TNode>::Add(TNode* node, unsigned edit)
+	{
+		const auto found = Slots.emplace(node, static_cast<unsigned>(Entries.size()));
+		if (found.second) {
+			Entries.emplace_back(node, edit);
+		}
+		else {
+			Entries[found.first->second].second |= edit;
+		}
+	}
+
+	template<typename TNode>
+	void TEditList<TNode>::Clear()
+	{
+		Entries.clear();
+		Slots.clear();
+	}
+
+	template struct TEditList<TPointNode>;
+	template struct TEditList<TPolygonNode>;
+
+	unsigned TMeshStore::PointCount() const
+	{
+		return LivePoints;
+	}
+
+	unsigned TMeshStore::PolygonCount() const
+	{
+		return LivePolygons;
+	}
+
+	unsigned TMeshStore::EdgeCount() const
+	{
+		return LiveEdges;
+	}
+
+	TPointNode* TMeshStore::NewPoint(const double* pos)
+	{
+		auto node = std::make_unique<TPointNode>();
+		node->Index = static_cast<unsigned>(Points.size());
+		for (int axis = 0; axis < 3; ++axis) {
+			node->Pos[axis] = static_cast<float>(pos[axis]);
+		}
+		Points.push_back(std::move(node));
+		++LivePoints;
+		Record(Points.back().get(), LXf_ELTEDIT_ADD, LXf_MESHEDIT_POINTS);
+		return Points.back().get();
+	}
+
+	void TMeshStore::SetPos(TPointNode* point, const double* pos)
+	{
+		for (int axis = 0; axis < 3; ++axis) {
+			point->Pos[axis] = static_cast<float>(pos[axis]);
+		}
+		Record(point, LXf_ELTEDIT_POINT_POS, LXf_MESHEDIT_POSITION);
+	}
+
+	TPolygonNode* TMeshStore::NewPolygon(LXtID4 type, const LXtPointID* points, unsigned count, bool reverse, const TPolygonNode* proto)
+	{
+		auto node = std::make_unique<TPolygonNode>();
+		node->Index = static_cast<unsigned>(Polygons.size());
+		node->Type = type ? type : LXiPTYP_FACE;
+		if (proto) {
+			node->Tags = proto->Tags;
+		}
+		Polygons.push_back(std::move(node));
+		++LivePolygons;
+
+		TPolygonNode* polygon = Polygons.back().get();
+		Assign(polygon, points, count, reverse);
+		Link(polygon);
+		Record(polygon, LXf_ELTEDIT_ADD, LXf_MESHEDIT_POLYGONS);
+		return polygon;
+	}
+
+	void TMeshStore::SetVertexList(TPolygonNode* polygon, const LXtPointID* points, unsigned count, bool reverse)
+	{
+		const std::vector<TPointNode*> previous = polygon->Vertices;
+		Unlink(polygon);
+		Assign(polygon, points, count, reverse);
+		Link(polygon);
+		DropCorners(polygon, previous);
+		Record(polygon, LXf_ELTEDIT_POLY_VLIST, LXf_MESHEDIT_POLYGONS);
+	}
+
+	void TMeshStore::RemovePoint(TPointNode* point)
+	{
+		if (point->Removed) {
+			return;
+		}
+
+		const std::vector<TPolygonNode*> polygons = point->Polygons;
+		for (TPolygonNode* polygon : polygons) {
+			Unlink(polygon);
+			Erase(polygon->Vertices, point);
+			Link(polygon);
+			DropCorners(polygon, {point});
+			Record(polygon, LXf_ELTEDIT_POLY_VLIST, LXf_MESHEDIT_POLYGONS);
+		}
+		for (const auto& map : Maps) {
+			map->PointValues.erase(point);
+		}
+		point->Removed = true;
+		--LivePoints;
+		Dirty = true;
+		Record(point, LXf_ELTEDIT_DELETE, LXf_MESHEDIT_POINTS);
+	}
+
+	void TMeshStore::RemovePolygon(TPolygonNode* polygon)
+	{
+		if (polygon->Removed) {
+			return;
+		}
+
+		const std::vector<TPointNode*> previous = polygon->Vertices;
+		Unlink(polygon);
+		polygon->Vertices.clear();
+		DropCorners(polygon, previous);
+		polygon->Removed = true;
+		--LivePolygons;
+		Dirty = true;
+		Record(polygon, LXf_ELTEDIT_DELETE, LXf_MESHEDIT_POLYGONS);
+	}
+
+	void TMeshStore::SetTag(TPolygonNode* polygon, LXtID4 type, const char* tag)
+	{
+		auto& tags = polygon->Tags;
+		const auto found = std::find_if(tags.begin(), tags.end(), [type](const std::pair<LXtID4, std::string>& entry) {
+			return entry.first == type;
+		});
+		if (!tag) {
+			if (found != tags.end()) {
+				tags.erase(found);
+			}
+		}
+		else if (found != tags.end()) {
+			found->second = tag;
+		}
+		else {
+			tags.emplace_back(type, tag);
+		}
+		Record(polygon, LXf_ELTEDIT_POLY_TAGS, LXf_MESHEDIT_POL_TAGS);
+	}
+
+	TEdgeNode* TMeshStore::FindEdge(const TPointNode* a, const TPointNode* b) const
+	{
+		const auto found = EdgeMap.find(std::minmax(a, b));
+		return found != EdgeMap.end() ? found->second : nullptr;
+	}
+
+	TMapNode* TMeshStore::NewMap(LXtID4 type, const char* name)
+	{
+		if (TMapNode* existing = FindMap(type, name)) {
+			return existing;
+		}
+		auto map = std::make_unique<TMapNode>();
+		map->Type = type;
+		map->Name = name ? name : "";
+		map->Dimension = 1;
+		for (const auto& known : MapTypes) {
+			if (known.Type == type) {
+				map->Dimension = known.Dimension;
+				map->Continuous = known.Continuous;
+			}
+		}
+		Maps.push_back(std::move(map));
+		return Maps.back().get();
+	}
+
+	TMapNode* TMeshStore::FindMap(LXtID4 type, const char* name) const
+	{
+		for (const auto& map : Maps) {
+			if (map->Type == type && (!name || map->Name == name)) {
+				return map.get();
+			}
+		}
+		return nullptr;
+	}
+
+	void TMeshStore::SetMapValue(TMapNode* map, TPolygonNode* polygon, TPointNode* point, const float* value)
+	{
+		if (polygon) {
+			if (value) {
+				map->CornerValues[{polygon, point}].assign(value, value + map->Dimension);
+			}
+			else {
+				map->CornerValues.erase({polygon, point});
+			}
+			Record(polygon, LXf_ELTEDIT_VMAP_VAL, MapChange(map->Type) | LXf_MESHEDIT_MAP_CONTINUITY);
+			return;
+		}
+		if (value) {
+			map->PointValues[point].assign(value, value + map->Dimension);
+		}
+		else {
+			map->PointValues.erase(point);
+		}
+		Record(point, LXf_ELTEDIT_VMAP_VAL, MapChange(map->Type));
+	}
+
+	std::shared_ptr<TChangeLog> TMeshStore::Track()
+	{
+		auto log = std::make_shared<TChangeLog>();
+		Logs.push_back(log);
+		return log;
+	}
+
+	void TMeshStore::BeginBatch()
+	{
+		++Batch;
+	}
+
+	void TMeshStore::EndBatch()
+	{
+		if (Batch) {
+			--Batch;
+		}
+	}
+
+	void TMeshStore::Assign(TPolygonNode* polygon, const LXtPointID* points, unsigned count, bool reverse)
+	{
+		polygon->Vertices.resize(count);
+		for (unsigned vertex = 0; vertex < count; ++vertex) {
+			polygon->Vertices[vertex] = Node(points[reverse ? count - 1 - vertex : vertex]);
+		}
+	}
+
+	void TMeshStore::DropCorners(TPolygonNode* polygon, const std::vector<TPointNode*>& points)
+	{
+		for (const auto& map : Maps) {
+			if (map->CornerValues.empty()) {
+				continue;
+			}
+			for (const TPointNode* point : points) {
+				if (std::find(polygon->Vertices.begin(), polygon->Vertices.end(), point) == polygon->Vertices.end()) {
+					map->CornerValues.erase({polygon, point});
+				}
+			}
+		}
+	}
+
+	void TMeshStore::Record(TPointNode* point, unsigned edit, unsigned change)
+	{
+		for (const auto& weak : Logs) {
+			const auto log = weak.lock();
+			if (log && log->Active) {
+				log->Points.Add(point, edit);
+				log->Changes |= change;
+			}
+		}
+	}
+
+	void TMeshStore::Record(TPolygonNode* polygon, unsigned edit, unsigned change)
+	{
+		for (const auto& weak : Logs) {
+			const auto log = weak.lock();
+			if (log && log->Active) {
+				log->Polygons.Add(polygon, edit);
+				log->Changes |= change;
+			}
+		}
+	}
+
+	bool TMeshStore::Tracked()
+	{
+		Logs.erase(std::remove_if(Logs.begin(), Logs.end(), [](const std::weak_ptr<TChangeLog>& log) {
+			return log.expired();
+		}), Logs.end());
+		return !Logs.empty();
+	}
+
+	void TMeshStore::Link(TPolygonNode* polygon)
+	{
+		const auto& vertices = polygon->Vertices;
+		const size_t count = vertices.size();
+		for (size_t vertex = 0; vertex < count; ++vertex) {
+			TPointNode* point = vertices[vertex];
+			if (std::find(point->Polygons.begin(), point->Polygons.end(), polygon) == point->Polygons.end()) {
+				point->Polygons.push_back(polygon);
+			}
+
+			TPointNode* next = vertices[(vertex + 1) % count];
+			if (count < 2 || next == point) {
+				continue;
+			}
+			TEdgeNode*& edge = EdgeMap[std::minmax<const TPointNode*>(point, next)];
+			if (!edge) {
+				auto node = std::make_unique<TEdgeNode>();
+				node->Index = static_cast<unsigned>(Edges.size());
+				node->Points = {point, next};
+				edge = node.get();
+				Edges.push_back(std::move(node));
+				point->Edges.push_back(edge);
+				next->Edges.push_back(edge);
+				++LiveEdges;
+			}
+			if (std::find(edge->Polygons.begin(), edge->Polygons.end(), polygon) == edge->Polygons.end()) {
+				edge->Polygons.push_back(polygon);
+			}
+		}
+	}
+
+	void TMeshStore::Unlink(TPolygonNode* polygon)
+	{
+		const auto& vertices = polygon->Vertices;
+		const size_t count = vertices.size();
+		for (size_t vertex = 0; vertex < count; ++vertex) {
+			TPointNode* point = vertices[vertex];
+			Erase(point->Polygons, polygon);
+
+			TPointNode* next = vertices[(vertex + 1) % count];
+			const auto found = EdgeMap.find(std::minmax<const TPointNode*>(point, next));
+			if (found == EdgeMap.end()) {
+				continue;
+			}
+			TEdgeNode* edge = found->second;
+			Erase(edge->Polygons, polygon);
+			if (edge->Polygons.empty()) {
+				Erase(edge->Points[0]->Edges, edge);
+				Erase(edge->Points[1]->Edges, edge);
+				edge->Removed = true;
+				--LiveEdges;
+				EdgeMap.erase(found);
+				Dirty = true;
+			}
+		}
+	}
+
+	void TMeshStore::Settle()
+	{
+		if (!Dirty || Batch) {
+			return;
+		}
+
+		// logs may still hold removed points and polygons
+		const bool tracked = Tracked();
+		Compact(Points, tracked ? &RetiredPoints : nullptr);
+		Compact(Polygons, tracked ? &RetiredPolygons : nullptr);
+		Compact(Edges);
+		if (!tracked) {
+			RetiredPoints.clear();
+			RetiredPolygons.clear();
+		}
+		Dirty = false;
+	}
+
+} // namespace NReference
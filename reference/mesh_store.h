@@ -0,0 +1,188 @@
+#pragma once
+
+#include <lxmesh.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace NReference {
+
+	struct TPolygonNode;
+	struct TEdgeNode;
+
+	struct TPointNode
+	{
+		unsigned Index = 0;
+		float Pos[3] = {};
+		LXtMarkMode Marks = 0;
+		bool Removed = false;
+		std::vector<TPolygonNode*> Polygons;
+		std::vector<TEdgeNode*> Edges;
+	};
+
+	struct TPolygonNode
+	{
+		unsigned Index = 0;
+		LXtID4 Type = 0;
+		LXtMarkMode Marks = 0;
+		bool Removed = false;
+		std::vector<TPointNode*> Vertices;
+		std::vector<std::pair<LXtID4, std::string>> Tags;
+	};
+
+	// edges exist while a polygon side uses them, like in the host
+	struct TEdgeNode
+	{
+		unsigned Index = 0;
+		LXtMarkMode Marks = 0;
+		bool Removed = false;
+		std::array<TPointNode*, 2> Points = {};
+		std::vector<TPolygonNode*> Polygons;
+	};
+
+	struct TPairHash
+	{
+		template<typename A, typename B>
+		size_t operator()(const std::pair<A*, B*>& key) const
+		{
+			const size_t a = std::hash<const void*>()(key.first);
+			const size_t b = std::hash<const void*>()(key.second);
+			return a ^ (b + 0x9e3779b97f4a7c15ull + (a << 6) + (a >> 2));
+		}
+	};
+
+	// values per point, and per polygon corner for maps that allow them
+	struct TMapNode
+	{
+		LXtID4 Type = 0;
+		std::string Name;
+		unsigned Dimension = 0;
+		bool Continuous = true;
+		std::unordered_map<const TPointNode*, std::vector<float>> PointValues;
+		std::unordered_map<std::pair<const TPolygonNode*, const TPointNode*>, std::vector<float>, TPairHash> CornerValues;
+	};
+
+	// elements edited while a tracker was active, in order of their first edit
+	template<typename TNode>
+	struct TEditList
+	{
+		std::vector<std::pair<TNode*, unsigned>> Entries;
+		std::unordered_map<const TNode*, unsigned> Slots;
+
+		void Add(TNode* node, unsigned edit);
+		void Clear();
+	};
+
+	// what one mesh tracker has seen since its last reset
+	struct TChangeLog
+	{
+		bool Active = false;
+		// LXf_MESHEDIT_* flags
+		unsigned Changes = 0;
+		// LXf_ELTEDIT_* flags per element
+		TEditList<TPointNode> Points;
+		TEditList<TPolygonNode> Polygons;
+	};
+
+	// counts the call and waits out the configured cost
+	void Call();
+
+	// modes keep the marks to set in the low half and the marks to clear in the high half
+	LXtMarkMode ComposeMode(const char* set, const char* clear);
+	bool TestMarks(LXtMarkMode marks, LXtMarkMode mode);
+	LXtMarkMode ApplyMarks(LXtMarkMode marks, LXtMarkMode mode);
+
+	// Node based mesh. Ids are node addresses; removed nodes stay in place
+	// until an index is read outside an edit batch, then the survivors are
+	// renumbered in order. While trackers are attached removed nodes are
+	// retired instead of freed, so change logs never hold dangling ids.
+	// Every edit goes through the store, which feeds the active logs.
+	class TMeshStore : public std::enable_shared_from_this<TMeshStore>
+	{
+	public:
+		TMeshStore() = default;
+		TMeshStore(const TMeshStore& rhs) = delete;
+		TMeshStore& operator=(const TMeshStore& rhs) = delete;
+
+		unsigned PointCount() const;
+		unsigned PolygonCount() const;
+		unsigned EdgeCount() const;
+
+		TPointNode* NewPoint(const double* pos);
+		void SetPos(TPointNode* point, const double* pos);
+		// tags are copied from proto when given
+		TPolygonNode* NewPolygon(LXtID4 type, const LXtPointID* points, unsigned count, bool reverse, const TPolygonNode* proto = nullptr);
+		void SetVertexList(TPolygonNode* polygon, const LXtPointID* points, unsigned count, bool reverse);
+		// polygons using the point lose that vertex
+		void RemovePoint(TPointNode* point);
+		void RemovePolygon(TPolygonNode* polygon);
+		// tag is null to clear
+		void SetTag(TPolygonNode* polygon, LXtID4 type, const char* tag);
+		TEdgeNode* FindEdge(const TPointNode* a, const TPointNode* b) const;
+
+		TMapNode* NewMap(LXtID4 type, const char* name);
+		TMapNode* FindMap(LXtID4 type, const char* name) const;
+		// value is null to clear, polygon is null for the point value
+		void SetMapValue(TMapNode* map, TPolygonNode* polygon, TPointNode* point, const float* value);
+
+		std::shared_ptr<TChangeLog> Track();
+
+		void BeginBatch();
+		void EndBatch();
+		// renumbers after removals, called before indices are read
+		void Settle();
+
+	public:
+		std::vector<std::unique_ptr<TPointNode>> Points;
+		std::vector<std::unique_ptr<TPolygonNode>> Polygons;
+		std::vector<std::unique_ptr<TEdgeNode>> Edges;
+		std::vector<std::unique_ptr<TMapNode>> Maps;
+
+	private:
+		void Link(TPolygonNode* polygon);
+		void Unlink(TPolygonNode* polygon);
+		void Assign(TPolygonNode* polygon, const LXtPointID* points, unsigned count, bool reverse);
+		// drops the corner values of points the polygon no longer uses
+		void DropCorners(TPolygonNode* polygon, const std::vector<TPointNode*>& points);
+		void Record(TPointNode* point, unsigned edit, unsigned change);
+		void Record(TPolygonNode* polygon, unsigned edit, unsigned change);
+		bool Tracked();
+
+	private:
+		unsigned Batch = 0;
+		bool Dirty = false;
+		unsigned LivePoints = 0;
+		unsigned LivePolygons = 0;
+		unsigned LiveEdges = 0;
+		std::unordered_map<std::pair<const TPointNode*, const TPointNode*>, TEdgeNode*, TPairHash> EdgeMap;
+		std::vector<std::weak_ptr<TChangeLog>> Logs;
+		std::vector<std::unique_ptr<TPointNode>> RetiredPoints;
+		std::vector<std::unique_ptr<TPolygonNode>> RetiredPolygons;
+	};
+
+	inline TPointNode* Node(LXtPointID id)
+	{
+		return reinterpret_cast<TPointNode*>(id);
+	}
+
+	inline TPolygonNode* Node(LXtPolygonID id)
+	{
+		return reinterpret_cast<TPolygonNode*>(id);
+	}
+
+	inline TEdgeNode* Node(LXtEdgeID id)
+	{
+		return reinterpret_cast<TEdgeNode*>(id);
+	}
+
+	inline TMapNode* Node(LXtMeshMapID id)
+	{
+		return reinterpret_cast<TMapNode*>(id);
+	}
+
+} // namespace NReference
@@ -0,0 +1,592 @@
+#include "bevel.h"
+
+#include "geo_util.h"
+#include "mesh.h"
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+	constexpr size_t PolygonGrain = 1024;
+
+	// chunk-local polygon lists joined in chunk order
+	struct TPolygonList
+	{
+		std::vector<unsigned> Owners;
+		std::vector<unsigned> Counts;
+		std::vector<unsigned> Vertices;
+	};
+
+	void Join(const std::vector<TPolygonList>& chunks, std::vector<unsigned>* owners, std::vector<unsigned>& start, std::vector<unsigned>& vertices)
+	{
+		start.assign(1, 0);
+		for (const auto& chunk : chunks) {
+			if (owners) {
+				owners->insert(owners->end(), chunk.Owners.begin(), chunk.Owners.end());
+			}
+			for (const unsigned count : chunk.Counts) {
+				start.push_back(start.back() + count);
+			}
+			vertices.insert(vertices.end(), chunk.Vertices.begin(), chunk.Vertices.end());
+		}
+	}
+
+	// drops repeats of the previous point, wrapping around
+	void PushPolygon(TPolygonList& list, unsigned owner, std::vector<unsigned>& points)
+	{
+		points.erase(std::unique(points.begin(), points.end()), points.end());
+		while (points.size() > 1 && points.front() == points.back()) {
+			points.pop_back();
+		}
+		if (points.size() < 3) {
+			return;
+		}
+		list.Owners.push_back(owner);
+		list.Counts.push_back(static_cast<unsigned>(points.size()));
+		list.Vertices.insert(list.Vertices.end(), points.begin(), points.end());
+	}
+} // anonymous namespace
+
+TBevel::TBevel(const TTopology& topology, const std::vector<unsigned>& edges, float width, unsigned segments, float profile)
+	: Topology(topology)
+	, Segments(std::max(segments, 1u))
+{
+	std::vector<unsigned> requested(edges);
+	std::sort(requested.begin(), requested.end());
+	requested.erase(std::unique(requested.begin(), requested.end()), requested.end());
+
+	std::vector<uint8_t> accepted(requested.size(), 0);
+	NParallel::For(requested.size(), [&](size_t i) {
+		const unsigned edge = requested[i];
+		if (edge >= Topology.EdgeCount() || Topology.EdgePolygonCount(edge) != 2) {
+			return;
+		}
+		const unsigned slot = Topology.EdgeCornerStart[edge];
+		const auto& vertices = Topology.Snapshot.PolygonVertices;
+		accepted[i] = vertices[Topology.EdgeCorners[slot]] != vertices[Topology.EdgeCorners[slot + 1]]
+			&& PlainFan(Topology.Edges[edge][0]) && PlainFan(Topology.Edges[edge][1]);
+	}, 256);
+
+	EdgeBevel.assign(Topology.EdgeCount(), TTopology::Invalid);
+	for (unsigned i = 0; i < requested.size(); ++i) {
+		if (accepted[i]) {
+			EdgeBevel[requested[i]] = static_cast<unsigned>(BevelEdges.size());
+			BevelEdges.push_back(requested[i]);
+		}
+	}
+
+	Offset(width);
+	Profiles(profile);
+	Rewrite();
+	Strips();
+	Caps();
+	CollectUnused();
+}
+
+unsigned TBevel::NewPointCount() const
+{
+	return static_cast<unsigned>(NewPositions.size());
+}
+
+bool TBevel::PlainFan(unsigned point) const
+{
+	const auto& vertices = Topology.Snapshot.PolygonVertices;
+	for (unsigned slot = Topology.PointCornerStart[point]; slot < Topology.PointCornerStart[point + 1]; ++slot) {
+		const unsigned corner = Topology.PointCorners[slot];
+		if (Topology.CornerEdge[corner] == TTopology::Invalid || Topology.CornerEdge[Topology.PrevCorner(corner)] == TTopology::Invalid) {
+			return false;
+		}
+	}
+	for (unsigned slot = Topology.PointEdgeStart[point]; slot < Topology.PointEdgeStart[point + 1]; ++slot) {
+		const unsigned edge = Topology.PointEdges[slot];
+		const unsigned count = Topology.EdgePolygonCount(edge);
+		const unsigned first = Topology.EdgeCornerStart[edge];
+		if (count > 2 || (count == 2 && vertices[Topology.EdgeCorners[first]] == vertices[Topology.EdgeCorners[first + 1]])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+unsigned TBevel::OtherCorner(unsigned corner) const
+{
+	const unsigned edge = Topology.CornerEdge[corner];
+	if (edge == TTopology::Invalid || Topology.EdgePolygonCount(edge) != 2) {
+		return TTopology::Invalid;
+	}
+	const unsigned first = Topology.EdgeCorners[Topology.EdgeCornerStart[edge]];
+	return first == corner ? Topology.EdgeCorners[Topology.EdgeCornerStart[edge] + 1] : first;
+}
+
+void TBevel::Offset(float width)
+{
+	const TMeshSnapshot& snapshot = Topology.Snapshot;
+	const auto& vertices = snapshot.PolygonVertices;
+	const auto& positions = snapshot.Positions;
+	const unsigned polygonCount = snapshot.PolygonCount();
+	const unsigned cornerCount = Topology.CornerCount();
+
+	auto bevelled = [this](unsigned corner) {
+		const unsigned edge = Topology.CornerEdge[corner];
+		return edge != TTopology::Invalid && EdgeBevel[edge] != TTopology::Invalid;
+	};
+	auto inOnly = [&](unsigned corner) {
+		return bevelled(Topology.PrevCorner(corner)) && !bevelled(corner);
+	};
+	auto outOnly = [&](unsigned corner) {
+		return bevelled(corner) && !bevelled(Topology.PrevCorner(corner));
+	};
+	// corners on both sides of an edge that is not bevelled slide along it to one shared point,
+	// owned by the side whose outgoing edge is bevelled
+	auto sharedOwner = [&](unsigned corner) {
+		if (!inOnly(corner)) {
+			return TTopology::Invalid;
+		}
+		const unsigned other = OtherCorner(corner);
+		if (other == TTopology::Invalid || !outOnly(Topology.NextCorner(other))) {
+			return TTopology::Invalid;
+		}
+		return Topology.NextCorner(other);
+	};
+	auto sharedPartner = [&](unsigned corner) {
+		if (!outOnly(corner)) {
+			return TTopology::Invalid;
+		}
+		const unsigned other = OtherCorner(Topology.PrevCorner(corner));
+		return other != TTopology::Invalid && inOnly(other) ? other : TTopology::Invalid;
+	};
+
+	std::vector<TVectorF> normals(polygonCount);
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		TVectorF normal(0.0f);
+		for (unsigned corner = snapshot.PolygonStart[polygon]; corner < snapshot.PolygonStart[polygon + 1]; ++corner) {
+			normal += glm::cross(positions[vertices[corner]], positions[vertices[Topology.NextCorner(corner)]]);
+		}
+		const float length = glm::length(normal);
+		normals[polygon] = length > 0.0f ? normal / length : normal;
+	}, PolygonGrain);
+
+	auto cornerOffset = [&](unsigned corner) {
+		const TVectorF& normal = normals[Topology.CornerPolygon[corner]];
+		auto inward = [&](const TVectorF& a, const TVectorF& b) {
+			const TVectorF side = glm::cross(normal, b - a);
+			const float sideLength = glm::length(side);
+			return sideLength > 0.0f ? side * (width / sideLength) : side;
+		};
+		// point on the segment from, to closest to the offset line
+		auto slide = [](const TVectorF& lineA, const TVectorF& lineB, const TVectorF& from, const TVectorF& to) {
+			const auto hit = NGeometry::IntersectLineLine(lineA, lineB, from, to);
+			if (!hit) {
+				return lineA;
+			}
+			const TVectorF along = to - from;
+			const float t = std::clamp(dot((*hit)[1] - from, along) / std::max(dot(along, along), std::numeric_limits<float>::min()), 0.0f, 1.0f);
+			return from + along * t;
+		};
+
+		const TVectorF& prev = positions[vertices[Topology.PrevCorner(corner)]];
+		const TVectorF& pos = positions[vertices[corner]];
+		const TVectorF& following = positions[vertices[Topology.NextCorner(corner)]];
+		const TVectorF offsetIn = inward(prev, pos);
+		const TVectorF offsetOut = inward(pos, following);
+
+		if (inOnly(corner)) {
+			return slide(prev + offsetIn, pos + offsetIn, pos, following);
+		}
+		if (outOnly(corner)) {
+			return slide(pos + offsetOut, following + offsetOut, pos, prev);
+		}
+		const auto hit = NGeometry::IntersectLineLine(prev + offsetIn, pos + offsetIn, pos + offsetOut, following + offsetOut);
+		return hit ? ((*hit)[0] + (*hit)[1]) * 0.5f : pos + offsetOut;
+	};
+
+	auto ownsPoint = [&](unsigned corner) {
+		return (bevelled(corner) || bevelled(Topology.PrevCorner(corner))) && sharedOwner(corner) == TTopology::Invalid;
+	};
+
+	std::vector<unsigned> offsetBase(polygonCount + 1, 0);
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		for (unsigned corner = snapshot.PolygonStart[polygon]; corner < snapshot.PolygonStart[polygon + 1]; ++corner) {
+			offsetBase[polygon] += ownsPoint(corner) ? 1 : 0;
+		}
+	}, PolygonGrain);
+	NewPositions.resize(NParallel::ExclusiveScan(offsetBase));
+
+	const unsigned pointCount = snapshot.PointCount();
+	CornerPoint.resize(cornerCount);
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		unsigned next = offsetBase[polygon];
+		for (unsigned corner = snapshot.PolygonStart[polygon]; corner < snapshot.PolygonStart[polygon + 1]; ++corner) {
+			CornerPoint[corner] = vertices[corner];
+			if (!ownsPoint(corner)) {
+				continue;
+			}
+
+			const unsigned partner = sharedPartner(corner);
+			NewPositions[next] = partner == TTopology::Invalid ? cornerOffset(corner) : (cornerOffset(corner) + cornerOffset(partner)) * 0.5f;
+			CornerPoint[corner] = pointCount + next;
+			++next;
+		}
+	}, PolygonGrain);
+
+	NParallel::For(cornerCount, [&](size_t corner) {
+		const unsigned owner = sharedOwner(static_cast<unsigned>(corner));
+		if (owner != TTopology::Invalid) {
+			CornerPoint[corner] = CornerPoint[owner];
+		}
+	});
+}
+
+bool TBevel::PassThrough(unsigned point) const
+{
+	unsigned bevelled = 0;
+	for (unsigned slot = Topology.PointEdgeStart[point]; slot < Topology.PointEdgeStart[point + 1]; ++slot) {
+		const unsigned edge = Topology.PointEdges[slot];
+		if (Topology.IsBoundary(edge)) {
+			return false;
+		}
+		bevelled += EdgeBevel[edge] != TTopology::Invalid ? 1 : 0;
+	}
+	if (bevelled != 2) {
+		return false;
+	}
+
+	// every corner slid to one of the two profile ends
+	std::array<unsigned, 2> ends = {TTopology::Invalid, TTopology::Invalid};
+	for (unsigned slot = Topology.PointCornerStart[point]; slot < Topology.PointCornerStart[point + 1]; ++slot) {
+		const unsigned corner = CornerPoint[Topology.PointCorners[slot]];
+		if (corner == ends[0] || corner == ends[1]) {
+			continue;
+		}
+		if (ends[1] != TTopology::Invalid) {
+			return false;
+		}
+		ends[ends[0] == TTopology::Invalid ? 0 : 1] = corner;
+	}
+	return true;
+}
+
+unsigned TBevel::ProfilePoint(unsigned bevelEdge, unsigned end, unsigned sample) const
+{
+	const unsigned index = bevelEdge * 2 + end;
+	return ProfileBase[index] + (ProfileReversed[index] ? Segments - 2 - sample : sample);
+}
+
+void TBevel::Profiles(float profile)
+{
+	const TMeshSnapshot& snapshot = Topology.Snapshot;
+	const unsigned pointCount = snapshot.PointCount();
+	const unsigned endCount = static_cast<unsigned>(BevelEdges.size()) * 2;
+	ProfileBase.assign(endCount, TTopology::Invalid);
+	ProfileReversed.assign(endCount, 0);
+	if (Segments == 1) {
+		return;
+	}
+
+	// corners of the first and second polygon at an end, end 0 is where the first corner starts
+	auto corners = [this](unsigned index) {
+		const unsigned slot = Topology.EdgeCornerStart[BevelEdges[index / 2]];
+		const unsigned first = Topology.EdgeCorners[slot];
+		const unsigned second = Topology.EdgeCorners[slot + 1];
+		return index % 2 == 0 ? std::array<unsigned, 2>{first, Topology.NextCorner(second)} : std::array<unsigned, 2>{Topology.NextCorner(first), second};
+	};
+	// the other end meeting this one at a pass through point, Invalid if there is none
+	std::vector<unsigned> partner(endCount, TTopology::Invalid);
+	NParallel::For(endCount, [&](size_t index) {
+		const unsigned point = snapshot.PolygonVertices[corners(static_cast<unsigned>(index))[0]];
+		if (!PassThrough(point)) {
+			return;
+		}
+		for (unsigned slot = Topology.PointEdgeStart[point]; slot < Topology.PointEdgeStart[point + 1]; ++slot) {
+			const unsigned bevelEdge = EdgeBevel[Topology.PointEdges[slot]];
+			if (bevelEdge != TTopology::Invalid && bevelEdge != index / 2) {
+				const unsigned other = bevelEdge * 2 + (snapshot.PolygonVertices[corners(bevelEdge * 2)[0]] == point ? 0 : 1);
+				partner[index] = other;
+			}
+		}
+	}, 256);
+
+	// the lower end of a pair owns the points
+	unsigned next = pointCount + NewPointCount();
+	for (unsigned index = 0; index < endCount; ++index) {
+		if (partner[index] == TTopology::Invalid || partner[index] > index) {
+			ProfileBase[index] = next;
+			next += Segments - 1;
+		}
+		else {
+			ProfileBase[index] = ProfileBase[partner[index]];
+			ProfileReversed[index] = CornerPoint[corners(index)[0]] != CornerPoint[corners(partner[index])[0]];
+		}
+	}
+	NewPositions.resize(next - pointCount);
+
+	auto position = [&](unsigned point) {
+		return point < pointCount ? snapshot.Positions[point] : NewPositions[point - pointCount];
+	};
+	auto samples = [&](unsigned index) {
+		const auto ends = corners(index);
+		const TVectorF center = snapshot.Positions[snapshot.PolygonVertices[ends[0]]];
+		const TVectorF a = position(CornerPoint[ends[0]]);
+		const TVectorF b = position(CornerPoint[ends[1]]);
+		return NGeometry::InterpolateBezier(a, a + (center - a) * profile, b + (center - b) * profile, b, Segments);
+	};
+
+	NParallel::For(endCount, [&](size_t index) {
+		if (partner[index] != TTopology::Invalid && partner[index] < index) {
+			return;
+		}
+		auto own = samples(static_cast<unsigned>(index));
+		if (partner[index] != TTopology::Invalid) {
+			const auto other = samples(partner[index]);
+			const bool reversed = ProfileReversed[partner[index]];
+			for (unsigned sample = 1; sample < Segments; ++sample) {
+				own[sample] = (own[sample] + other[reversed ? Segments - sample : sample]) * 0.5f;
+			}
+		}
+		for (unsigned sample = 1; sample < Segments; ++sample) {
+			NewPositions[ProfileBase[index] + sample - 1 - pointCount] = own[sample];
+		}
+	}, 256);
+}
+
+void TBevel::Rewrite()
+{
+	const TMeshSnapshot& snapshot = Topology.Snapshot;
+	const unsigned pointCount = snapshot.PointCount();
+	const auto& vertices = snapshot.PolygonVertices;
+
+	auto position = [&](unsigned point) {
+		return point < pointCount ? snapshot.Positions[point] : NewPositions[point - pointCount];
+	};
+	auto distance2 = [&](unsigned a, unsigned b) {
+		const TVectorF d = position(a) - position(b);
+		return dot(d, d);
+	};
+
+	std::vector<TPolygonList> chunks(NParallel::ChunkCount(snapshot.PolygonCount(), PolygonGrain));
+	NParallel::ForChunks(snapshot.PolygonCount(), [&](unsigned chunk, size_t begin, size_t end) {
+		std::vector<unsigned> points;
+		for (size_t polygon = begin; polygon < end; ++polygon) {
+			points.clear();
+			bool changed = false;
+			for (unsigned corner = snapshot.PolygonStart[polygon]; corner < snapshot.PolygonStart[polygon + 1]; ++corner) {
+				const unsigned next = Topology.NextCorner(corner);
+				const unsigned own = CornerPoint[corner];
+				points.push_back(own);
+				changed |= own != vertices[corner];
+
+				const unsigned edge = Topology.CornerEdge[corner];
+				const unsigned other = OtherCorner(corner);
+				if (other == TTopology::Invalid || EdgeBevel[edge] != TTopology::Invalid) {
+					continue;
+				}
+
+				// points the polygon across moved along this edge, unless ours moved further;
+				// a corner that could not slide, at a straight angle, still gets a point of its own
+				auto further = [&](unsigned moved, unsigned kept, unsigned end) {
+					const float movedDistance = distance2(moved, end);
+					const float keptDistance = distance2(kept, end);
+					return movedDistance > keptDistance || (movedDistance == keptDistance && kept == end);
+				};
+				const unsigned start = vertices[corner];
+				const unsigned across = CornerPoint[Topology.NextCorner(other)];
+				if (across != own && further(across, own, start)) {
+					points.push_back(across);
+					changed = true;
+				}
+				const unsigned finish = vertices[next];
+				const unsigned acrossNext = CornerPoint[other];
+				if (acrossNext != CornerPoint[next] && further(acrossNext, CornerPoint[next], finish)) {
+					points.push_back(acrossNext);
+					changed = true;
+				}
+			}
+			if (changed) {
+				PushPolygon(chunks[chunk], static_cast<unsigned>(polygon), points);
+			}
+		}
+	}, PolygonGrain);
+
+	Join(chunks, &Rewritten, RewrittenStart, RewrittenVertices);
+}
+
+void TBevel::Strips()
+{
+	CreatedStart.assign(1, 0);
+	for (unsigned bevelEdge = 0; bevelEdge < BevelEdges.size(); ++bevelEdge) {
+		const unsigned slot = Topology.EdgeCornerStart[BevelEdges[bevelEdge]];
+		const unsigned first = Topology.EdgeCorners[slot];
+		const unsigned second = Topology.EdgeCorners[slot + 1];
+
+		std::array<std::vector<unsigned>, 2> profiles;
+		profiles[0].push_back(CornerPoint[first]);
+		profiles[1].push_back(CornerPoint[Topology.NextCorner(first)]);
+		for (unsigned sample = 0; sample + 1 < Segments; ++sample) {
+			profiles[0].push_back(ProfilePoint(bevelEdge, 0, sample));
+			profiles[1].push_back(ProfilePoint(bevelEdge, 1, sample));
+		}
+		profiles[0].push_back(CornerPoint[Topology.NextCorner(second)]);
+		profiles[1].push_back(CornerPoint[second]);
+
+		// runs against both neighbours: end 1 to end 0 along the first polygon
+		for (unsigned segment = 0; segment < Segments; ++segment) {
+			CreatedVertices.insert(CreatedVertices.end(), {
+				profiles[1][segment],
+				profiles[0][segment],
+				profiles[0][segment + 1],
+				profiles[1][segment + 1],
+			});
+			CreatedStart.push_back(static_cast<unsigned>(CreatedVertices.size()));
+		}
+	}
+}
+
+void TBevel::Caps()
+{
+	const auto& vertices = Topology.Snapshot.PolygonVertices;
+
+	std::vector<unsigned> points;
+	for (const unsigned edge : BevelEdges) {
+		points.push_back(Topology.Edges[edge][0]);
+		points.push_back(Topology.Edges[edge][1]);
+	}
+	std::sort(points.begin(), points.end());
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+
+	std::vector<TPolygonList> chunks(NParallel::ChunkCount(points.size(), 256));
+	NParallel::ForChunks(points.size(), [&](unsigned chunk, size_t begin, size_t end) {
+		std::vector<unsigned> cap;
+		for (size_t i = begin; i < end; ++i) {
+			const unsigned point = points[i];
+			if (PassThrough(point)) {
+				continue;
+			}
+
+			// an open fan is walked from the corner after its border
+			unsigned start = Topology.PointCorners[Topology.PointCornerStart[point]];
+			bool open = false;
+			for (unsigned slot = Topology.PointCornerStart[point]; slot < Topology.PointCornerStart[point + 1]; ++slot) {
+				const unsigned corner = Topology.PointCorners[slot];
+				if (OtherCorner(Topology.PrevCorner(corner)) == TTopology::Invalid) {
+					start = corner;
+					open = true;
+					break;
+				}
+			}
+
+			// turns across the edge leaving the point in each polygon
+			cap.clear();
+			unsigned corner = start;
+			do {
+				cap.push_back(CornerPoint[corner]);
+				const unsigned edge = Topology.CornerEdge[corner];
+				const unsigned other = OtherCorner(corner);
+				if (other == TTopology::Invalid) {
+					break;
+				}
+
+				const unsigned bevelEdge = EdgeBevel[edge];
+				if (bevelEdge != TTopology::Invalid) {
+					const unsigned first = Topology.EdgeCorners[Topology.EdgeCornerStart[edge]];
+					const unsigned profileEnd = vertices[first] == point ? 0 : 1;
+					for (unsigned sample = 0; sample + 1 < Segments; ++sample) {
+						const unsigned index = first == corner ? sample : Segments - 2 - sample;
+						cap.push_back(ProfilePoint(bevelEdge, profileEnd, index));
+					}
+				}
+				corner = Topology.NextCorner(other);
+			} while (corner != start);
+
+			if (open) {
+				cap.push_back(point);
+			}
+			// the walk runs against the winding of the polygons around
+			std::reverse(cap.begin(), cap.end());
+			PushPolygon(chunks[chunk], point, cap);
+		}
+	}, 256);
+
+	std::vector<unsigned> capStart;
+	std::vector<unsigned> capVertices;
+	Join(chunks, nullptr, capStart, capVertices);
+	for (unsigned cap = 0; cap + 1 < capStart.size(); ++cap) {
+		CreatedVertices.insert(CreatedVertices.end(), capVertices.begin() + capStart[cap], capVertices.begin() + capStart[cap + 1]);
+		CreatedStart.push_back(static_cast<unsigned>(CreatedVertices.size()));
+	}
+}
+
+void TBevel::CollectUnused()
+{
+	const unsigned pointCount = Topology.Snapshot.PointCount();
+	std::vector<uint8_t> used(pointCount, 0);
+	auto use = [&](unsigned point) {
+		if (point < pointCount) {
+			std::atomic_ref<uint8_t>(used[point]).store(1, std::memory_order_relaxed);
+		}
+	};
+	NParallel::For(CornerPoint.size(), [&](size_t corner) {
+		use(CornerPoint[corner]);
+	});
+	NParallel::For(RewrittenVertices.size(), [&](size_t slot) {
+		use(RewrittenVertices[slot]);
+	});
+	NParallel::For(CreatedVertices.size(), [&](size_t slot) {
+		use(CreatedVertices[slot]);
+	});
+
+	for (const unsigned edge : BevelEdges) {
+		for (const unsigned point : Topology.Edges[edge]) {
+			if (!used[point]) {
+				Unused.push_back(point);
+			}
+		}
+	}
+	std::sort(Unused.begin(), Unused.end());
+	Unused.erase(std::unique(Unused.begin(), Unused.end()), Unused.end());
+}
+
+void TBevel::Apply(TMesh& mesh) const
+{
+	if (BevelEdges.empty()) {
+		return;
+	}
+
+	const TMeshSnapshot& snapshot = Topology.Snapshot;
+	mesh.BeginEditBatch();
+
+	std::vector<LXtPointID> ids(snapshot.PointIds);
+	for (const auto& pos : NewPositions) {
+		ids.push_back(mesh.CreatePoint(pos));
+	}
+
+	auto polygon = mesh.InitPolygon();
+	std::vector<LXtPointID> points;
+	auto gather = [&](const std::vector<unsigned>& start, const std::vector<unsigned>& vertices, unsigned index) {
+		points.clear();
+		for (unsigned slot = start[index]; slot < start[index + 1]; ++slot) {
+			points.push_back(ids[vertices[slot]]);
+		}
+	};
+
+	for (unsigned rewritten = 0; rewritten < Rewritten.size(); ++rewritten) {
+		gather(RewrittenStart, RewrittenVertices, rewritten);
+		polygon.Select(snapshot.PolygonIds[Rewritten[rewritten]]);
+		polygon.SetVertexList(points.data(), static_cast<unsigned>(points.size()), 0);
+	}
+	mesh.AddChange(LXf_MESHEDIT_POLYGONS);
+
+	for (unsigned created = 0; created + 1 < CreatedStart.size(); ++created) {
+		gather(CreatedStart, CreatedVertices, created);
+		mesh.CreatePolygon(points);
+	}
+
+	auto point = mesh.InitPoint();
+	for (const unsigned unused : Unused) {
+		point.Select(snapshot.PointIds[unused]);
+		point.Remove();
+	}
+
+	mesh.EndEditBatch();
+}
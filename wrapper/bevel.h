@@ -0,0 +1,71 @@
+#pragma once
+
+#include "topology.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <vector>
+
+class TMesh;
+
+// Edge bevel computed over the topology tables, then written in one edit batch.
+// Every polygon corner touching a bevelled edge gets its own point: moved
+// inward by width along the neighbouring edge, or to the meeting point of
+// both offset lines when both of its edges are bevelled. Each bevelled edge
+// becomes a strip of segments quads following a Bezier profile, and every
+// bevelled end point is capped by a polygon closing the fan around it,
+// except where two edges pass through a point and simply share a profile.
+//
+// Points are numbered like the snapshot, new points follow the old ones.
+class TBevel
+{
+public:
+	// profile shapes the strip: 0 is flat, about 0.55 is round and 1 keeps the sharp edge
+	TBevel(const TTopology& topology, const std::vector<unsigned>& edges, float width, unsigned segments = 1, float profile = 0.55f);
+
+	unsigned NewPointCount() const;
+
+	// rewrites touched polygons, creates strips and caps and removes points left unused
+	void Apply(TMesh& mesh) const;
+
+public:
+	// requested edges that could be bevelled: two consistently wound polygons and plain fans at both ends
+	std::vector<unsigned> BevelEdges;
+	std::vector<TVectorF> NewPositions;
+
+	// point taking the place of each corner
+	std::vector<unsigned> CornerPoint;
+
+	std::vector<unsigned> Rewritten;
+	std::vector<unsigned> RewrittenStart;
+	std::vector<unsigned> RewrittenVertices;
+
+	std::vector<unsigned> CreatedStart;
+	std::vector<unsigned> CreatedVertices;
+
+	std::vector<unsigned> Unused;
+
+private:
+	bool PlainFan(unsigned point) const;
+	unsigned OtherCorner(unsigned corner) const;
+	void Offset(float width);
+	// two bevelled edges meeting without a cap share their profile at the point
+	bool PassThrough(unsigned point) const;
+	void Profiles(float profile);
+	void Rewrite();
+	void Strips();
+	void Caps();
+	void CollectUnused();
+
+	// interior profile point of a bevelled edge end, counted from the first polygon of the edge to the second
+	unsigned ProfilePoint(unsigned bevelEdge, unsigned end, unsigned sample) const;
+
+private:
+	const TTopology& Topology;
+	const unsigned Segments;
+	std::vector<unsigned> EdgeBevel;
+
+	// first interior point per bevelled edge end, reversed where it reuses the profile of a pass through partner
+	std::vector<unsigned> ProfileBase;
+	std::vector<uint8_t> ProfileReversed;
+};
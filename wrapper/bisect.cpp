@@ -0,0 +1,439 @@
+#include "bisect.h"
+
+#include "boundary.h"
+#include "mesh.h"
+#include "parallel.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+
+namespace {
+	constexpr unsigned BlockSize = 64;
+
+	struct TItem
+	{
+		unsigned Point;
+		int Side;
+	};
+
+	struct TPiece
+	{
+		int Side = 0;
+		std::vector<unsigned> Points;
+	};
+
+	// keeps the items on side, with the on-plane items next to that side
+	void Filter(const std::vector<TItem>& loop, const std::vector<int>& prev, const std::vector<int>& next, int side, std::vector<TPiece>& pieces)
+	{
+		TPiece piece;
+		piece.Side = side;
+		for (size_t k = 0; k < loop.size(); ++k) {
+			if (loop[k].Side == side || (!loop[k].Side && (prev[k] == side || next[k] == side))) {
+				piece.Points.push_back(loop[k].Point);
+			}
+		}
+		pieces.push_back(std::move(piece));
+	}
+
+	// polygon outline with crossings inserted, split into pieces on either side
+	void Split(const std::vector<TItem>& loop, const std::vector<TVectorF>& positions, const TVectorF& planeNormal, std::vector<TPiece>& pieces)
+	{
+		const size_t count = loop.size();
+		const bool above = std::any_of(loop.begin(), loop.end(), [](const TItem& item) { return item.Side > 0; });
+		const bool below = std::any_of(loop.begin(), loop.end(), [](const TItem& item) { return item.Side < 0; });
+		if (!above || !below) {
+			TPiece piece;
+			piece.Side = above ? 1 : (below ? -1 : 0);
+			for (const auto& item : loop) {
+				piece.Points.push_back(item.Point);
+			}
+			pieces.push_back(std::move(piece));
+			return;
+		}
+
+		// nearest side around each item, skipping on-plane items
+		std::vector<int> prev(count);
+		std::vector<int> next(count);
+		for (size_t k = 0; k < count; ++k) {
+			size_t j = k;
+			do {
+				j = (j + count - 1) % count;
+			} while (!loop[j].Side);
+			prev[k] = loop[j].Side;
+			j = k;
+			do {
+				j = (j + 1) % count;
+			} while (!loop[j].Side);
+			next[k] = loop[j].Side;
+		}
+
+		// on-plane items where the outline changes side
+		std::vector<unsigned> cuts;
+		std::vector<uint8_t> isCut(count, 0);
+		bool runs = false;
+		for (size_t k = 0; k < count; ++k) {
+			if (!loop[k].Side && prev[k] != next[k]) {
+				isCut[k] = 1;
+				cuts.push_back(static_cast<unsigned>(k));
+				runs |= k > 0 && isCut[k - 1];
+			}
+		}
+		runs |= isCut[0] && isCut[count - 1] && count > 1;
+
+		// convex outlines, and edges lying in the plane, which the pairing can not order
+		if (cuts.size() <= 2 || runs || cuts.size() % 2) {
+			Filter(loop, prev, next, 1, pieces);
+			Filter(loop, prev, next, -1, pieces);
+			return;
+		}
+
+		TVectorF normal(0.0f);
+		for (size_t k = 0; k < count; ++k) {
+			normal += glm::cross(positions[loop[k].Point], positions[loop[(k + 1) % count].Point]);
+		}
+		const TVectorF direction = glm::cross(planeNormal, normal);
+		std::sort(cuts.begin(), cuts.end(), [&](unsigned a, unsigned b) {
+			return glm::dot(positions[loop[a].Point], direction) < glm::dot(positions[loop[b].Point], direction);
+		});
+		std::vector<unsigned> partner(count, 0);
+		for (size_t i = 0; i < cuts.size(); i += 2) {
+			partner[cuts[i]] = cuts[i + 1];
+			partner[cuts[i + 1]] = cuts[i];
+		}
+
+		// walk the outline, crossing over to the partner at every cut
+		const size_t first = pieces.size();
+		std::vector<uint8_t> visited(count, 0);
+		for (size_t start = 0; start < count; ++start) {
+			if (isCut[start] || visited[start]) {
+				continue;
+			}
+			TPiece piece;
+			size_t k = start;
+			size_t steps = 0;
+			do {
+				piece.Points.push_back(loop[k].Point);
+				visited[k] = 1;
+				piece.Side = piece.Side ? piece.Side : loop[k].Side;
+				if (isCut[k]) {
+					k = partner[k];
+					piece.Points.push_back(loop[k].Point);
+				}
+				k = (k + 1) % count;
+			} while (k != start && ++steps <= 2 * count);
+
+			if (steps > 2 * count) {
+				pieces.resize(first);
+				Filter(loop, prev, next, 1, pieces);
+				Filter(loop, prev, next, -1, pieces);
+				return;
+			}
+			pieces.push_back(std::move(piece));
+		}
+	}
+
+	// coordinates in the plane, dropping the axis the normal is largest along
+	glm::vec2 Flatten(const TVectorF& pos, int axis)
+	{
+		return axis == 0 ? glm::vec2(pos.y, pos.z) : (axis == 1 ? glm::vec2(pos.z, pos.x) : glm::vec2(pos.x, pos.y));
+	}
+
+	// even-odd test of p against a closed outline
+	bool Inside(const std::vector<glm::vec2>& outline, const glm::vec2& p)
+	{
+		bool inside = false;
+		for (size_t i = 0, j = outline.size() - 1; i < outline.size(); j = i++) {
+			const glm::vec2& a = outline[i];
+			const glm::vec2& b = outline[j];
+			if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y)) {
+				inside = !inside;
+			}
+		}
+		return inside;
+	}
+} // anonymous namespace
+
+TBisect::TBisect(const TTopology& topology, const std::vector<glm::vec4>& planes, EKeep keep, bool fill, float epsilon)
+	: Result(topology.Snapshot)
+	, Topology(topology)
+{
+	PointOrigin.resize(Result.PointCount());
+	std::iota(PointOrigin.begin(), PointOrigin.end(), 0u);
+	PolygonOrigin.resize(Result.PolygonCount());
+	std::iota(PolygonOrigin.begin(), PolygonOrigin.end(), 0u);
+	PolygonSource = PolygonOrigin;
+
+	std::unique_ptr<TTopology> current;
+	for (size_t plane = 0; plane < planes.size(); ++plane) {
+		TMeshSnapshot next;
+		std::vector<uint8_t> onPlane;
+		Cut(current ? *current : Topology, planes[plane], keep, epsilon, next, onPlane);
+		if (fill && keep != EKeep::Both) {
+			Fill(next, onPlane, TVectorF(planes[plane].x, planes[plane].y, planes[plane].z));
+		}
+
+		// the topology refers to Result, rebuilt for the next plane
+		current.reset();
+		Result = std::move(next);
+		if (plane + 1 < planes.size()) {
+			current = std::make_unique<TTopology>(Result);
+		}
+	}
+	std::fill(Result.PointIds.begin(), Result.PointIds.end(), nullptr);
+	std::fill(Result.PolygonIds.begin(), Result.PolygonIds.end(), nullptr);
+}
+
+void TBisect::Cut(const TTopology& current, const glm::vec4& plane, EKeep keep, float epsilon, TMeshSnapshot& next, std::vector<uint8_t>& onPlane)
+{
+	const auto& source = current.Snapshot;
+	const unsigned pointCount = source.PointCount();
+	const TVectorF normal(plane.x, plane.y, plane.z);
+
+	std::vector<float> distances(pointCount);
+	std::vector<int> sides(pointCount);
+	NParallel::ForChunks(pointCount, [&](unsigned, size_t begin, size_t end) {
+		float x[BlockSize];
+		float y[BlockSize];
+		float z[BlockSize];
+		for (size_t first = begin; first < end; first += BlockSize) {
+			const unsigned count = static_cast<unsigned>(std::min<size_t>(BlockSize, end - first));
+			for (unsigned i = 0; i < count; ++i) {
+				x[i] = source.Positions[first + i].x;
+				y[i] = source.Positions[first + i].y;
+				z[i] = source.Positions[first + i].z;
+			}
+			float* d = &distances[first];
+			int* s = &sides[first];
+			for (unsigned i = 0; i < count; ++i) {
+				d[i] = plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w;
+				s[i] = (d[i] > epsilon) - (d[i] < -epsilon);
+			}
+		}
+	});
+
+	// one point per crossing edge
+	const unsigned edgeCount = current.EdgeCount();
+	std::vector<unsigned> crossing(edgeCount + 1, 0);
+	NParallel::For(edgeCount, [&](size_t edge) {
+		crossing[edge] = sides[current.Edges[edge][0]] * sides[current.Edges[edge][1]] < 0 ? 1 : 0;
+	});
+	const unsigned crossingCount = NParallel::ExclusiveScan(crossing);
+	CrossingCountValue += crossingCount;
+
+	next.Positions.resize(pointCount + crossingCount);
+	std::copy(source.Positions.begin(), source.Positions.end(), next.Positions.begin());
+	NParallel::For(edgeCount, [&](size_t edge) {
+		if (crossing[edge + 1] == crossing[edge]) {
+			return;
+		}
+		const unsigned a = current.Edges[edge][0];
+		const unsigned b = current.Edges[edge][1];
+		const float t = distances[a] / (distances[a] - distances[b]);
+		next.Positions[pointCount + crossing[edge]] = source.Positions[a] + t * (source.Positions[b] - source.Positions[a]);
+	});
+	next.PointIds.resize(next.Positions.size());
+	PointOrigin.resize(next.Positions.size(), Invalid);
+
+	onPlane.assign(next.Positions.size(), 1);
+	for (unsigned point = 0; point < pointCount; ++point) {
+		onPlane[point] = sides[point] ? 0 : 1;
+	}
+
+	const int dropped = keep == EKeep::Above ? -1 : (keep == EKeep::Below ? 1 : 2);
+	const unsigned polygonCount = source.PolygonCount();
+	const unsigned chunks = NParallel::ChunkCount(polygonCount, 1024);
+	std::vector<std::vector<unsigned>> chunkSizes(chunks);
+	std::vector<std::vector<unsigned>> chunkVertices(chunks);
+	std::vector<std::vector<unsigned>> chunkOrigins(chunks);
+	std::vector<std::vector<unsigned>> chunkSources(chunks);
+	NParallel::ForChunks(polygonCount, [&](unsigned chunk, size_t begin, size_t end) {
+		std::vector<TItem> loop;
+		std::vector<TPiece> pieces;
+		for (size_t polygon = begin; polygon < end; ++polygon) {
+			loop.clear();
+			pieces.clear();
+			for (unsigned corner = source.PolygonStart[polygon]; corner < source.PolygonStart[polygon + 1]; ++corner) {
+				const unsigned point = source.PolygonVertices[corner];
+				loop.push_back({point, sides[point]});
+				const unsigned edge = current.CornerEdge[corner];
+				if (edge != TTopology::Invalid && crossing[edge + 1] != crossing[edge]) {
+					loop.push_back({pointCount + crossing[edge], 0});
+				}
+			}
+			Split(loop, next.Positions, normal, pieces);
+
+			for (const auto& piece : pieces) {
+				if (piece.Side == dropped || piece.Points.size() < 3) {
+					continue;
+				}
+				chunkSizes[chunk].push_back(static_cast<unsigned>(piece.Points.size()));
+				chunkVertices[chunk].insert(chunkVertices[chunk].end(), piece.Points.begin(), piece.Points.end());
+				chunkOrigins[chunk].push_back(PolygonOrigin[polygon]);
+				chunkSources[chunk].push_back(PolygonSource[polygon]);
+			}
+		}
+	}, 1024);
+
+	std::vector<unsigned> origins;
+	std::vector<unsigned> sources;
+	next.PolygonStart.assign(1, 0);
+	for (unsigned chunk = 0; chunk < chunks; ++chunk) {
+		for (const unsigned size : chunkSizes[chunk]) {
+			next.PolygonStart.push_back(next.PolygonStart.back() + size);
+		}
+		next.PolygonVertices.insert(next.PolygonVertices.end(), chunkVertices[chunk].begin(), chunkVertices[chunk].end());
+		origins.insert(origins.end(), chunkOrigins[chunk].begin(), chunkOrigins[chunk].end());
+		sources.insert(sources.end(), chunkSources[chunk].begin(), chunkSources[chunk].end());
+	}
+	next.PolygonIds.resize(origins.size());
+	PolygonOrigin.swap(origins);
+	PolygonSource.swap(sources);
+}
+
+void TBisect::Fill(TMeshSnapshot& next, const std::vector<uint8_t>& onPlane, const TVectorF& normal)
+{
+	std::vector<std::vector<unsigned>> fills;
+	// a fill takes after the polygon along the first edge of its loop
+	std::vector<unsigned> sources;
+	{
+		const TTopology topology(next);
+		const TBoundaryLoops boundary(topology);
+		for (const auto& loop : boundary.Loops()) {
+			const bool cut = loop.Closed && loop.Points.size() >= 3 && std::all_of(loop.Points.begin(), loop.Points.end(), [&onPlane](unsigned point) {
+				return onPlane[point] != 0;
+			});
+			if (cut) {
+				fills.emplace_back(loop.Points.rbegin(), loop.Points.rend());
+				const unsigned corner = topology.EdgeCorners[topology.EdgeCornerStart[loop.Edges[0]]];
+				sources.push_back(PolygonSource[topology.CornerPolygon[corner]]);
+			}
+		}
+	}
+
+	// cut loops never cross, so one edge midpoint tells whether a loop lies inside another;
+	// it is a hole when wound against the innermost such loop, else a separate piece
+	// like an island in a hole or a fold of the surface
+	const TVectorF magnitude = glm::abs(normal);
+	const int axis = magnitude.x >= magnitude.y && magnitude.x >= magnitude.z ? 0 : (magnitude.y >= magnitude.z ? 1 : 2);
+	std::vector<std::vector<glm::vec2>> outlines(fills.size());
+	std::vector<glm::vec2> lows(fills.size(), glm::vec2(std::numeric_limits<float>::max()));
+	std::vector<glm::vec2> highs(fills.size(), glm::vec2(std::numeric_limits<float>::lowest()));
+	std::vector<float> areas(fills.size(), 0.0f);
+	for (size_t fill = 0; fill < fills.size(); ++fill) {
+		for (const unsigned point : fills[fill]) {
+			const glm::vec2 pos = Flatten(next.Positions[point], axis);
+			outlines[fill].push_back(pos);
+			lows[fill] = glm::vec2(std::min(lows[fill].x, pos.x), std::min(lows[fill].y, pos.y));
+			highs[fill] = glm::vec2(std::max(highs[fill].x, pos.x), std::max(highs[fill].y, pos.y));
+		}
+		for (size_t i = 0, j = outlines[fill].size() - 1; i < outlines[fill].size(); j = i++) {
+			areas[fill] += outlines[fill][j].x * outlines[fill][i].y - outlines[fill][i].x * outlines[fill][j].y;
+		}
+	}
+	std::vector<uint8_t> nested(fills.size(), 0);
+	NParallel::For(fills.size(), [&](size_t fill) {
+		const glm::vec2 probe = (outlines[fill][0] + outlines[fill][1]) * 0.5f;
+		size_t inner = fill;
+		for (size_t other = 0; other < fills.size(); ++other) {
+			if (other != fill && lows[other].x <= lows[fill].x && lows[other].y <= lows[fill].y && highs[other].x >= highs[fill].x && highs[other].y >= highs[fill].y
+				&& (inner == fill || std::abs(areas[other]) < std::abs(areas[inner])) && Inside(outlines[other], probe)) {
+				inner = other;
+			}
+		}
+		nested[fill] = inner != fill && (areas[inner] < 0.0f) != (areas[fill] < 0.0f);
+	});
+	size_t kept = 0;
+	for (size_t fill = 0; fill < fills.size(); ++fill) {
+		if (!nested[fill]) {
+			fills[kept].swap(fills[fill]);
+			sources[kept++] = sources[fill];
+		}
+	}
+	fills.resize(kept);
+	sources.resize(kept);
+
+	for (size_t fill = 0; fill < fills.size(); ++fill) {
+		next.PolygonVertices.insert(next.PolygonVertices.end(), fills[fill].begin(), fills[fill].end());
+		next.PolygonStart.push_back(static_cast<unsigned>(next.PolygonVertices.size()));
+		next.PolygonIds.push_back(nullptr);
+		PolygonOrigin.push_back(Invalid);
+		PolygonSource.push_back(sources[fill]);
+	}
+}
+
+unsigned TBisect::CrossingCount() const
+{
+	return CrossingCountValue;
+}
+
+void TBisect::Apply(TMesh& mesh) const
+{
+	const auto& snapshot = Topology.Snapshot;
+	if (!CrossingCountValue && Result.PolygonCount() == snapshot.PolygonCount()) {
+		return;
+	}
+
+	mesh.BeginEditBatch();
+
+	std::vector<uint8_t> used(Result.PointCount(), 0);
+	for (const unsigned point : Result.PolygonVertices) {
+		used[point] = 1;
+	}
+	std::vector<LXtPointID> ids(Result.PointCount(), nullptr);
+	for (unsigned point = 0; point < Result.PointCount(); ++point) {
+		if (PointOrigin[point] != Invalid) {
+			ids[point] = snapshot.PointIds[PointOrigin[point]];
+		}
+		else if (used[point]) {
+			ids[point] = mesh.CreatePoint(Result.Positions[point]);
+		}
+	}
+
+	auto polygon = mesh.InitPolygon();
+	std::vector<uint8_t> reused(snapshot.PolygonCount(), 0);
+	std::vector<LXtPointID> vertices;
+	for (unsigned index = 0; index < Result.PolygonCount(); ++index) {
+		vertices.clear();
+		for (unsigned slot = Result.PolygonStart[index]; slot < Result.PolygonStart[index + 1]; ++slot) {
+			vertices.push_back(ids[Result.PolygonVertices[slot]]);
+		}
+
+		const unsigned origin = PolygonOrigin[index];
+		if (origin == Invalid || reused[origin]) {
+			mesh.CreatePolygon(snapshot.PolygonIds[PolygonSource[index]], vertices);
+			continue;
+		}
+		reused[origin] = 1;
+		const auto begin = Result.PolygonVertices.begin() + Result.PolygonStart[index];
+		const auto end = Result.PolygonVertices.begin() + Result.PolygonStart[index + 1];
+		const bool same = std::equal(begin, end, snapshot.PolygonVertices.begin() + snapshot.PolygonStart[origin], snapshot.PolygonVertices.begin() + snapshot.PolygonStart[origin + 1]);
+		if (!same) {
+			polygon.Select(snapshot.PolygonIds[origin]);
+			polygon.SetVertexList(vertices.data(), static_cast<unsigned>(vertices.size()), 0);
+		}
+	}
+
+	for (unsigned index = 0; index < snapshot.PolygonCount(); ++index) {
+		if (!reused[index]) {
+			polygon.Select(snapshot.PolygonIds[index]);
+			polygon.Remove();
+		}
+	}
+	mesh.AddChange(LXf_MESHEDIT_POLYGONS);
+
+	// points of the dropped side
+	auto point = mesh.InitPoint();
+	for (unsigned index = 0; index < snapshot.PointCount(); ++index) {
+		if (!used[index] && Topology.Valence(index)) {
+			point.Select(snapshot.PointIds[index]);
+			point.Remove();
+			mesh.AddChange(LXf_MESHEDIT_POINTS);
+		}
+	}
+
+	mesh.EndEditBatch();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "snapshot.h"
+#include "vector.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class TMesh;
+class TTopology;
+
+// Cuts the mesh by planes, one after the other. Points are classified in
+// blocks, every edge crossing the plane gets one new point shared by both
+// of its polygons, and polygons are split in parallel; concave polygons
+// crossing several times are split by pairing the crossings along the cut
+// line. When one side is kept, the open cuts can be filled. Holes of a
+// section, loops wound against the innermost loop around them like the
+// inner rim of a cut torus, stay open, since bridging them into the outer
+// cap would need polygons that repeat points. Nothing is written to the
+// host before Apply(), which makes all edits in one batch.
+class TBisect
+{
+public:
+	static constexpr unsigned Invalid = std::numeric_limits<unsigned>::max();
+
+	enum class EKeep
+	{
+		Both,
+		// dot(normal, pos) + d > 0
+		Above,
+		Below,
+	};
+
+	// planes are (normal, d); fill only applies when one side is kept
+	TBisect(const TTopology& topology, const std::vector<glm::vec4>& planes, EKeep keep = EKeep::Both, bool fill = false, float epsilon = 1e-5f);
+	TBisect(const TBisect& rhs) = delete;
+	TBisect& operator=(const TBisect& rhs) = delete;
+
+	unsigned CrossingCount() const;
+
+	// reuses the first piece of every polygon, creates the others and the fills
+	// from their source polygon
+	void Apply(TMesh& mesh) const;
+
+public:
+	// mesh after all cuts, ids are unset
+	TMeshSnapshot Result;
+	// snapshot index, Invalid for crossing points and fills
+	std::vector<unsigned> PointOrigin;
+	std::vector<unsigned> PolygonOrigin;
+	// snapshot polygon lending type and tags, the origin or for fills a polygon along the cut
+	std::vector<unsigned> PolygonSource;
+
+private:
+	void Cut(const TTopology& current, const glm::vec4& plane, EKeep keep, float epsilon, TMeshSnapshot& next, std::vector<uint8_t>& onPlane);
+	void Fill(TMeshSnapshot& next, const std::vector<uint8_t>& onPlane, const TVectorF& normal);
+
+private:
+	const TTopology& Topology;
+	unsigned CrossingCountValue = 0;
+};
@@ -0,0 +1,59 @@
+#include "bitset.h"
+
+#include <atomic>
+
+TBitSet::TBitSet(unsigned size)
+	: SizeValue(size)
+	, Words((size + 63) / 64, 0)
+{
+}
+
+unsigned TBitSet::Size() const
+{
+	return SizeValue;
+}
+
+unsigned TBitSet::Count() const
+{
+	unsigned count = 0;
+	for (const uint64_t word : Words) {
+		count += std::popcount(word);
+	}
+	return count;
+}
+
+bool TBitSet::Test(unsigned index) const
+{
+	return (Words[index / 64] >> (index % 64)) & 1u;
+}
+
+void TBitSet::Set(unsigned index)
+{
+	Words[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+void TBitSet::Reset(unsigned index)
+{
+	Words[index / 64] &= ~(uint64_t(1) << (index % 64));
+}
+
+void TBitSet::SetAtomic(unsigned index)
+{
+	std::atomic_ref<uint64_t>(Words[index / 64]).fetch_or(uint64_t(1) << (index % 64), std::memory_order_relaxed);
+}
+
+TBitSet& TBitSet::operator|=(const TBitSet& rhs)
+{
+	for (size_t word = 0; word < Words.size() && word < rhs.Words.size(); ++word) {
+		Words[word] |= rhs.Words[word];
+	}
+	return *this;
+}
+
+TBitSet& TBitSet::operator&=(const TBitSet& rhs)
+{
+	for (size_t word = 0; word < Words.size(); ++word) {
+		Words[word] &= word < rhs.Words.size() ? rhs.Words[word] : 0;
+	}
+	return *this;
+}
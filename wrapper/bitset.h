@@ -0,0 +1,43 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+// Dense flag per element, indexed like the snapshot.
+class TBitSet
+{
+public:
+	TBitSet() = default;
+	explicit TBitSet(unsigned size);
+
+	unsigned Size() const;
+	unsigned Count() const;
+
+	bool Test(unsigned index) const;
+	void Set(unsigned index);
+	void Reset(unsigned index);
+	// safe to call from several threads at once
+	void SetAtomic(unsigned index);
+
+	TBitSet& operator|=(const TBitSet& rhs);
+	TBitSet& operator&=(const TBitSet& rhs);
+
+	// lambda(index) for every set bit, ascending
+	template<typename F>
+	void ForEach(F&& lambda) const;
+
+private:
+	unsigned SizeValue = 0;
+	std::vector<uint64_t> Words;
+};
+
+template<typename F>
+void TBitSet::ForEach(F&& lambda) const
+{
+	for (unsigned word = 0; word < Words.size(); ++word) {
+		for (uint64_t bits = Words[word]; bits; bits &= bits - 1) {
+			lambda(word * 64 + static_cast<unsigned>(std::countr_zero(bits)));
+		}
+	}
+}
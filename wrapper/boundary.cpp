@@ -0,0 +1,142 @@
+#include "boundary.h"
+
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace {
+	constexpr size_t CornerGrain = 16384;
+} // anonymous namespace
+
+TBoundaryLoops::TBoundaryLoops(const TTopology& topology)
+	: Topology(topology)
+	, EdgesValue(topology.EdgeCount())
+{
+	const unsigned cornerCount = Topology.CornerCount();
+	auto isBoundary = [this](unsigned corner) {
+		const unsigned edge = Topology.CornerEdge[corner];
+		return edge != TTopology::Invalid && Topology.IsBoundary(edge);
+	};
+
+	std::vector<std::vector<unsigned>> chunkCorners(NParallel::ChunkCount(cornerCount, CornerGrain));
+	NParallel::ForChunks(cornerCount, [&](unsigned chunk, size_t begin, size_t end) {
+		for (size_t corner = begin; corner < end; ++corner) {
+			if (isBoundary(static_cast<unsigned>(corner))) {
+				chunkCorners[chunk].push_back(static_cast<unsigned>(corner));
+				EdgesValue.SetAtomic(Topology.CornerEdge[corner]);
+			}
+		}
+	}, CornerGrain);
+
+	std::vector<unsigned> corners;
+	for (const auto& chunk : chunkCorners) {
+		corners.insert(corners.end(), chunk.begin(), chunk.end());
+	}
+
+	// links between boundary corners, by position in corners
+	auto position = [&corners](unsigned corner) {
+		return static_cast<unsigned>(std::lower_bound(corners.begin(), corners.end(), corner) - corners.begin());
+	};
+	std::vector<unsigned> next(corners.size(), TTopology::Invalid);
+	std::vector<uint8_t> hasPrev(corners.size(), 0);
+	NParallel::For(corners.size(), [&](size_t i) {
+		const unsigned corner = Next(corners[i]);
+		if (corner != TTopology::Invalid) {
+			next[i] = position(corner);
+			std::atomic_ref<uint8_t>(hasPrev[next[i]]).store(1, std::memory_order_relaxed);
+		}
+	}, 1024);
+
+	const auto& vertices = Topology.Snapshot.PolygonVertices;
+	std::vector<uint8_t> used(corners.size(), 0);
+	std::vector<std::pair<unsigned, TBoundaryLoop>> loops;
+	auto chain = [&](unsigned first) {
+		TBoundaryLoop loop;
+		unsigned i = first;
+		unsigned last = first;
+		while (i != TTopology::Invalid && !used[i]) {
+			used[i] = 1;
+			loop.Points.push_back(vertices[corners[i]]);
+			loop.Edges.push_back(Topology.CornerEdge[corners[i]]);
+			last = i;
+			i = next[i];
+		}
+		loop.Closed = i == first;
+		if (!loop.Closed) {
+			loop.Points.push_back(vertices[Topology.NextCorner(corners[last])]);
+		}
+		loops.emplace_back(first, std::move(loop));
+	};
+
+	// open chains from their start, what is left are cycles
+	for (unsigned i = 0; i < corners.size(); ++i) {
+		if (!hasPrev[i]) {
+			chain(i);
+		}
+	}
+	for (unsigned i = 0; i < corners.size(); ++i) {
+		if (!used[i]) {
+			chain(i);
+		}
+	}
+
+	std::sort(loops.begin(), loops.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+	});
+	LoopsValue.reserve(loops.size());
+	for (auto& loop : loops) {
+		LoopsValue.push_back(std::move(loop.second));
+	}
+}
+
+unsigned TBoundaryLoops::Next(unsigned corner) const
+{
+	const auto& vertices = Topology.Snapshot.PolygonVertices;
+	const unsigned point = vertices[Topology.NextCorner(corner)];
+	const unsigned fanSize = Topology.PointCornerStart[point + 1] - Topology.PointCornerStart[point];
+
+	// turn around the point through the polygons of the incoming fan
+	unsigned at = Topology.NextCorner(corner);
+	for (unsigned step = 0; step < fanSize; ++step) {
+		const unsigned edge = Topology.CornerEdge[at];
+		if (edge == TTopology::Invalid) {
+			break;
+		}
+		if (Topology.IsBoundary(edge)) {
+			return at;
+		}
+		if (Topology.EdgePolygonCount(edge) != 2) {
+			break;
+		}
+		const unsigned first = Topology.EdgeCorners[Topology.EdgeCornerStart[edge]];
+		const unsigned other = first == at ? Topology.EdgeCorners[Topology.EdgeCornerStart[edge] + 1] : first;
+		// opposite winding across the edge would turn the other way
+		if (vertices[other] == point) {
+			break;
+		}
+		at = Topology.NextCorner(other);
+	}
+
+	// non-manifold fan, fall back to the lowest boundary corner at the point
+	for (unsigned slot = Topology.PointCornerStart[point]; slot < Topology.PointCornerStart[point + 1]; ++slot) {
+		const unsigned candidate = Topology.PointCorners[slot];
+		const unsigned edge = Topology.CornerEdge[candidate];
+		if (edge != TTopology::Invalid && Topology.IsBoundary(edge)) {
+			return candidate;
+		}
+	}
+	return TTopology::Invalid;
+}
+
+const TBitSet& TBoundaryLoops::Edges() const
+{
+	return EdgesValue;
+}
+
+const std::vector<TBoundaryLoop>& TBoundaryLoops::Loops() const
+{
+	return LoopsValue;
+}
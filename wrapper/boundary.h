@@ -0,0 +1,40 @@
+#pragma once
+
+#include "bitset.h"
+#include "topology.h"
+
+#include <vector>
+
+// Chain of boundary edges. Points follow the winding of the polygons along
+// the border, so a polygon filling a hole takes them in reverse order.
+// Open loops only come from non-manifold or inconsistently wound borders.
+struct TBoundaryLoop
+{
+	std::vector<unsigned> Points;
+	// Edges[i] joins Points[i] and Points[i + 1], wrapping for closed loops
+	std::vector<unsigned> Edges;
+	bool Closed = false;
+};
+
+// Edges used by exactly one polygon, chained into loops in one pass.
+// Where several borders touch a point (bow-ties) a loop stays in the fan
+// of polygons it arrived through, so the result does not depend on the
+// enumeration order of the host.
+class TBoundaryLoops
+{
+public:
+	explicit TBoundaryLoops(const TTopology& topology);
+
+	const TBitSet& Edges() const;
+	// ordered by their first corner
+	const std::vector<TBoundaryLoop>& Loops() const;
+
+private:
+	// boundary corner leaving the end point of corner, Invalid if there is none
+	unsigned Next(unsigned corner) const;
+
+private:
+	const TTopology& Topology;
+	TBitSet EdgesValue;
+	std::vector<TBoundaryLoop> LoopsValue;
+};
@@ -0,0 +1,154 @@
+#include "bounds.h"
+
+#include <algorithm>
+
+TBox::TBox(const TVectorF& min, const TVectorF& max)
+	: Min(min)
+	, Max(max)
+{
+}
+
+bool TBox::Empty() const
+{
+	return Min.x > Max.x || Min.y > Max.y || Min.z > Max.z;
+}
+
+TVectorF TBox::Center() const
+{
+	return (Min + Max) * 0.5f;
+}
+
+TVectorF TBox::Size() const
+{
+	return Max - Min;
+}
+
+void TBox::Extend(const TVectorF& pos)
+{
+	Min = glm::min(Min, pos);
+	Max = glm::max(Max, pos);
+}
+
+void TBox::Extend(const TBox& box)
+{
+	Min = glm::min(Min, box.Min);
+	Max = glm::max(Max, box.Max);
+}
+
+bool TBox::Contains(const TVectorF& pos) const
+{
+	return pos.x >= Min.x && pos.y >= Min.y && pos.z >= Min.z
+		&& pos.x <= Max.x && pos.y <= Max.y && pos.z <= Max.z;
+}
+
+bool TBox::Contains(const TBox& box) const
+{
+	return Contains(box.Min) && Contains(box.Max);
+}
+
+bool TBox::Overlaps(const TBox& box) const
+{
+	return Min.x <= box.Max.x && Min.y <= box.Max.y && Min.z <= box.Max.z
+		&& box.Min.x <= Max.x && box.Min.y <= Max.y && box.Min.z <= Max.z;
+}
+
+float TBox::Distance2(const TVectorF& pos) const
+{
+	const TVectorF d = glm::max(glm::max(Min - pos, pos - Max), TVectorF(0.0f));
+	return dot(d, d);
+}
+
+float TBox::FarDistance2(const TVectorF& pos) const
+{
+	const TVectorF d = glm::max(glm::abs(Min - pos), glm::abs(Max - pos));
+	return dot(d, d);
+}
+
+TFrustum TFrustum::FromMatrix(const glm::mat4& viewProjection)
+{
+	return FromMatrix(viewProjection, glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, 1.0f));
+}
+
+TFrustum TFrustum::FromMatrix(const glm::mat4& m, const glm::vec2& min, const glm::vec2& max)
+{
+	// Gribb & Hartmann, rows of a column major matrix
+	auto row = [&m](int r) {
+		return glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+	};
+
+	TFrustum frustum;
+	frustum.Planes = {
+		row(0) - row(3) * min.x,
+		row(3) * max.x - row(0),
+		row(1) - row(3) * min.y,
+		row(3) * max.y - row(1),
+		row(3) + row(2),
+		row(3) - row(2),
+	};
+
+	for (auto& plane : frustum.Planes) {
+		const float len = glm::length(TVectorF(plane.x, plane.y, plane.z));
+		if (len > 0.0f) {
+			plane /= len;
+		}
+	}
+	return frustum;
+}
+
+TBox TOrientedBox::Bounds() const
+{
+	const TVectorF extent =
+		glm::abs(Axes[0]) * HalfSize.x +
+		glm::abs(Axes[1]) * HalfSize.y +
+		glm::abs(Axes[2]) * HalfSize.z;
+	return TBox(Center - extent, Center + extent);
+}
+
+bool TOrientedBox::Contains(const TVectorF& pos) const
+{
+	const TVectorF d = pos - Center;
+	return std::abs(dot(d, Axes[0])) <= HalfSize.x
+		&& std::abs(dot(d, Axes[1])) <= HalfSize.y
+		&& std::abs(dot(d, Axes[2])) <= HalfSize.z;
+}
+
+bool TFrustum::Contains(const TVectorF& pos) const
+{
+	for (const auto& plane : Planes) {
+		if (plane.x * pos.x + plane.y * pos.y + plane.z * pos.z + plane.w < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+EContainment TFrustum::Classify(const TBox& box) const
+{
+	const TVectorF center = box.Center();
+	const TVectorF half = box.Max - center;
+
+	EContainment result = EContainment::Inside;
+	for (const auto& plane : Planes) {
+		const float dist = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		const float extent = std::abs(plane.x) * half.x + std::abs(plane.y) * half.y + std::abs(plane.z) * half.z;
+		if (dist + extent < 0.0f) {
+			return EContainment::Outside;
+		}
+		if (dist - extent < 0.0f) {
+			result = EContainment::Intersect;
+		}
+	}
+	return result;
+}
+
+EContainment ClassifySphere(const TBox& box, const TVectorF& center, float radius)
+{
+	const float radius2 = radius * radius;
+	if (box.Distance2(center) > radius2) {
+		return EContainment::Outside;
+	}
+	if (box.FarDistance2(center) <= radius2) {
+		return EContainment::Inside;
+	}
+	return EContainment::Intersect;
+}
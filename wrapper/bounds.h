@@ -0,0 +1,63 @@
+#pragma once
+
+#include "vector.h"
+
+#include <array>
+#include <limits>
+
+struct TBox
+{
+	TVectorF Min = TVectorF(std::numeric_limits<float>::max());
+	TVectorF Max = TVectorF(-std::numeric_limits<float>::max());
+
+	TBox() = default;
+	TBox(const TVectorF& min, const TVectorF& max);
+
+	bool Empty() const;
+	TVectorF Center() const;
+	TVectorF Size() const;
+
+	void Extend(const TVectorF& pos);
+	void Extend(const TBox& box);
+
+	bool Contains(const TVectorF& pos) const;
+	bool Contains(const TBox& box) const;
+	bool Overlaps(const TBox& box) const;
+
+	float Distance2(const TVectorF& pos) const;
+	float FarDistance2(const TVectorF& pos) const;
+};
+
+struct TOrientedBox
+{
+	TVectorF Center;
+	// unit length, mutually orthogonal
+	std::array<TVectorF, 3> Axes;
+	TVectorF HalfSize;
+
+	TBox Bounds() const;
+	bool Contains(const TVectorF& pos) const;
+};
+
+enum class EContainment
+{
+	Outside,
+	Intersect,
+	Inside,
+};
+
+// planes point inwards: dot(normal, pos) + d >= 0 inside
+struct TFrustum
+{
+	std::array<glm::vec4, 6> Planes;
+
+	// view-projection matrix, clip space z in [-1, 1]
+	static TFrustum FromMatrix(const glm::mat4& viewProjection);
+	// sub-frustum through the normalized device rectangle [min, max]
+	static TFrustum FromMatrix(const glm::mat4& viewProjection, const glm::vec2& min, const glm::vec2& max);
+
+	bool Contains(const TVectorF& pos) const;
+	EContainment Classify(const TBox& box) const;
+};
+
+EContainment ClassifySphere(const TBox& box, const TVectorF& center, float radius);
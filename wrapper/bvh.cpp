@@ -0,0 +1,87 @@
+#include "bvh.h"
+
+#include "octree.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <bit>
+
+TBvh::TBvh(const std::vector<TBox>& bounds, unsigned leafSize)
+{
+	const size_t count = bounds.size();
+	if (!count) {
+		return;
+	}
+
+	TBox total;
+	for (const auto& box : bounds) {
+		total.Extend(box.Center());
+	}
+
+	std::vector<uint32_t> codes(count);
+	NParallel::For(count, [&](size_t i) {
+		codes[i] = NOctree::MortonCode(bounds[i].Center(), total);
+	});
+
+	Items.resize(count);
+	for (unsigned i = 0; i < count; ++i) {
+		Items[i] = i;
+	}
+	std::sort(Items.begin(), Items.end(), [&codes](unsigned a, unsigned b) {
+		return codes[a] != codes[b] ? codes[a] < codes[b] : a < b;
+	});
+
+	std::vector<uint32_t> sorted(count);
+	for (size_t i = 0; i < count; ++i) {
+		sorted[i] = codes[Items[i]];
+	}
+
+	Nodes.reserve(2 * count / std::max(leafSize, 1u) + 1);
+	Build(bounds, sorted, 0, static_cast<unsigned>(count), std::max(leafSize, 1u));
+}
+
+bool TBvh::Empty() const
+{
+	return Nodes.empty();
+}
+
+bool TBvh::TNode::Leaf() const
+{
+	return Count > 0;
+}
+
+unsigned TBvh::Build(const std::vector<TBox>& bounds, const std::vector<uint32_t>& codes, unsigned first, unsigned last, unsigned leafSize)
+{
+	const unsigned index = static_cast<unsigned>(Nodes.size());
+	Nodes.emplace_back();
+
+	if (last - first <= leafSize) {
+		TBox box;
+		for (unsigned i = first; i < last; ++i) {
+			box.Extend(bounds[Items[i]]);
+		}
+		Nodes[index].Bounds = box;
+		Nodes[index].First = first;
+		Nodes[index].Count = last - first;
+		return index;
+	}
+
+	unsigned split = first + (last - first) / 2;
+	const uint32_t diff = codes[first] ^ codes[last - 1];
+	if (diff) {
+		const uint32_t bit = 1u << (31 - std::countl_zero(diff));
+		const uint32_t prefix = codes[first] & ~(bit - 1) & ~bit;
+		split = static_cast<unsigned>(std::partition_point(codes.begin() + first, codes.begin() + last, [bit, prefix](uint32_t code) {
+			return (code & ~(bit - 1)) == prefix;
+		}) - codes.begin());
+	}
+
+	const unsigned left = Build(bounds, codes, first, split, leafSize);
+	const unsigned right = Build(bounds, codes, split, last, leafSize);
+
+	TBox box = Nodes[left].Bounds;
+	box.Extend(Nodes[right].Bounds);
+	Nodes[index].Bounds = box;
+	Nodes[index].Right = right;
+	return index;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "bounds.h"
+
+#include <cstdint>
+#include <vector>
+
+// Binary bounding volume hierarchy over boxes. Items are Morton-sorted and
+// split at the highest differing bit. Nodes are stored depth first, the left
+// child directly follows its parent.
+class TBvh
+{
+public:
+	struct TNode
+	{
+		TBox Bounds;
+		unsigned First = 0;
+		unsigned Count = 0;
+		unsigned Right = 0;
+
+		bool Leaf() const;
+	};
+
+	explicit TBvh(const std::vector<TBox>& bounds, unsigned leafSize = 4);
+
+	bool Empty() const;
+
+public:
+	std::vector<TNode> Nodes;
+	// item index per leaf slot
+	std::vector<unsigned> Items;
+
+private:
+	unsigned Build(const std::vector<TBox>& bounds, const std::vector<uint32_t>& codes, unsigned first, unsigned last, unsigned leafSize);
+};
@@ -0,0 +1,87 @@
+#include "closest_point.h"
+
+#include "geo_util.h"
+#include "parallel.h"
+#include "triangulation.h"
+
+#include <cmath>
+
+namespace {
+	constexpr size_t BatchGrain = 256;
+} // anonymous namespace
+
+bool TClosestHit::Valid() const
+{
+	return Triangle != Invalid;
+}
+
+TClosestPoint::TClosestPoint(const TTriangulation& triangulation)
+	: Triangulation(triangulation)
+	, Bvh(triangulation.Bounds())
+{
+}
+
+TClosestHit TClosestPoint::Query(const TVectorF& pos, float maxDistance) const
+{
+	TClosestHit hit;
+	if (Bvh.Empty()) {
+		return hit;
+	}
+
+	float best2 = maxDistance < std::sqrt(std::numeric_limits<float>::max()) ? maxDistance * maxDistance : std::numeric_limits<float>::max();
+
+	std::vector<unsigned> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+	while (!stack.empty()) {
+		const auto& node = Bvh.Nodes[stack.back()];
+		stack.pop_back();
+		if (node.Bounds.Distance2(pos) > best2) {
+			continue;
+		}
+
+		if (node.Leaf()) {
+			for (unsigned slot = node.First; slot < node.First + node.Count; ++slot) {
+				const unsigned triangle = Bvh.Items[slot];
+				const auto corners = Triangulation.Corners(triangle);
+				TVectorF close;
+				const TVectorF barycentric = NGeometry::ClosestToTriangle(close, pos, corners[0], corners[1], corners[2]);
+				const TVectorF d = close - pos;
+				const float dist2 = dot(d, d);
+				if (dist2 <= best2) {
+					best2 = dist2;
+					hit.Triangle = triangle;
+					hit.Pos = close;
+					hit.Barycentric = barycentric;
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first so the cap shrinks early
+		const unsigned left = static_cast<unsigned>(&node - Bvh.Nodes.data()) + 1;
+		const unsigned right = node.Right;
+		if (Bvh.Nodes[left].Bounds.Distance2(pos) < Bvh.Nodes[right].Bounds.Distance2(pos)) {
+			stack.push_back(right);
+			stack.push_back(left);
+		}
+		else {
+			stack.push_back(left);
+			stack.push_back(right);
+		}
+	}
+
+	if (hit.Valid()) {
+		hit.Distance = std::sqrt(best2);
+	}
+	return hit;
+}
+
+std::vector<TClosestHit> TClosestPoint::Query(const std::vector<TVectorF>& positions, float maxDistance) const
+{
+	std::vector<TClosestHit> hits(positions.size());
+	NParallel::For(positions.size(), [&](size_t i) {
+		hits[i] = Query(positions[i], maxDistance);
+	}, BatchGrain);
+	return hits;
+}
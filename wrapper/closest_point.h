@@ -0,0 +1,37 @@
+#pragma once
+
+#include "bvh.h"
+#include "vector.h"
+
+#include <limits>
+#include <vector>
+
+class TTriangulation;
+
+struct TClosestHit
+{
+	static constexpr unsigned Invalid = std::numeric_limits<unsigned>::max();
+
+	unsigned Triangle = Invalid;
+	TVectorF Pos = TVectorF(0.0f);
+	TVectorF Barycentric = TVectorF(0.0f);
+	float Distance = std::numeric_limits<float>::max();
+
+	bool Valid() const;
+};
+
+// Closest point on a triangulated reference mesh. Queries farther than
+// maxDistance from every triangle return an invalid hit; a small cap lets
+// most of the tree be culled without visiting any triangle.
+class TClosestPoint
+{
+public:
+	explicit TClosestPoint(const TTriangulation& triangulation);
+
+	TClosestHit Query(const TVectorF& pos, float maxDistance = std::numeric_limits<float>::max()) const;
+	std::vector<TClosestHit> Query(const std::vector<TVectorF>& positions, float maxDistance = std::numeric_limits<float>::max()) const;
+
+private:
+	const TTriangulation& Triangulation;
+	TBvh Bvh;
+};
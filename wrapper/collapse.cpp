@@ -0,0 +1,477 @@
+#include "collapse.h"
+
+#include "mesh.h"
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace {
+	std::vector<unsigned> SortedUnique(std::vector<unsigned> values)
+	{
+		std::sort(values.begin(), values.end());
+		values.erase(std::unique(values.begin(), values.end()), values.end());
+		return values;
+	}
+} // anonymous namespace
+
+bool TPolygonRebuild::Empty() const
+{
+	return Moved.empty() && Rewritten.empty() && Removed.empty() && Unused.empty();
+}
+
+void TPolygonRebuild::Apply(TMesh& mesh, const TMeshSnapshot& snapshot) const
+{
+	if (Empty()) {
+		return;
+	}
+
+	mesh.BeginEditBatch();
+
+	auto point = mesh.InitPoint();
+	for (unsigned moved = 0; moved < Moved.size(); ++moved) {
+		const TVectorD pos(MovedPositions[moved]);
+		point.Select(snapshot.PointIds[Moved[moved]]);
+		point.SetPos(&pos.x);
+	}
+	if (!Moved.empty()) {
+		mesh.AddChange(LXf_MESHEDIT_POSITION);
+	}
+
+	auto polygon = mesh.InitPolygon();
+	std::vector<LXtPointID> vertices;
+	for (unsigned rewritten = 0; rewritten < Rewritten.size(); ++rewritten) {
+		vertices.clear();
+		for (unsigned slot = RewrittenStart[rewritten]; slot < RewrittenStart[rewritten + 1]; ++slot) {
+			vertices.push_back(snapshot.PointIds[RewrittenVertices[slot]]);
+		}
+		polygon.Select(snapshot.PolygonIds[Rewritten[rewritten]]);
+		polygon.SetVertexList(vertices.data(), static_cast<unsigned>(vertices.size()), 0);
+	}
+	for (const unsigned removed : Removed) {
+		polygon.Select(snapshot.PolygonIds[removed]);
+		polygon.Remove();
+	}
+	if (!Rewritten.empty() || !Removed.empty()) {
+		mesh.AddChange(LXf_MESHEDIT_POLYGONS);
+	}
+
+	for (const unsigned unused : Unused) {
+		point.Select(snapshot.PointIds[unused]);
+		point.Remove();
+	}
+	if (!Unused.empty()) {
+		mesh.AddChange(LXf_MESHEDIT_POINTS);
+	}
+
+	mesh.EndEditBatch();
+}
+
+TEdgeCollapse::TEdgeCollapse(const TTopology& topology, const std::vector<unsigned>& edges)
+	: Topology(topology)
+	, Parent(topology.PointCount())
+	, Ring(topology.PointCount())
+{
+	std::iota(Parent.begin(), Parent.end(), 0u);
+	std::iota(Ring.begin(), Ring.end(), 0u);
+
+	// merges depend on each other, so they are planned in edge order
+	for (const unsigned edge : SortedUnique(edges)) {
+		const unsigned a = Root(Topology.Edges[edge][0]);
+		const unsigned b = Root(Topology.Edges[edge][1]);
+		if (a != b && !Allowed(a, b)) {
+			Rejected.push_back(edge);
+			continue;
+		}
+		if (a != b) {
+			Parent[std::max(a, b)] = std::min(a, b);
+			std::swap(Ring[a], Ring[b]);
+		}
+		Collapsed.push_back(edge);
+	}
+
+	for (unsigned point = 0; point < Parent.size(); ++point) {
+		Parent[point] = Root(point);
+	}
+	Rebuild();
+}
+
+const std::vector<unsigned>& TEdgeCollapse::Remap() const
+{
+	return Parent;
+}
+
+void TEdgeCollapse::Apply(TMesh& mesh) const
+{
+	Result.Apply(mesh, Topology.Snapshot);
+}
+
+unsigned TEdgeCollapse::Root(unsigned point)
+{
+	while (Parent[point] != point) {
+		Parent[point] = Parent[Parent[point]];
+		point = Parent[point];
+	}
+	return point;
+}
+
+bool TEdgeCollapse::Allowed(unsigned a, unsigned b)
+{
+	const auto& snapshot = Topology.Snapshot;
+
+	Polygons.clear();
+	for (const unsigned root : {a, b}) {
+		unsigned member = root;
+		do {
+			for (unsigned slot = Topology.PointCornerStart[member]; slot < Topology.PointCornerStart[member + 1]; ++slot) {
+				Polygons.push_back(Topology.CornerPolygon[Topology.PointCorners[slot]]);
+			}
+			member = Ring[member];
+		} while (member != root);
+	}
+	std::sort(Polygons.begin(), Polygons.end());
+	Polygons.erase(std::unique(Polygons.begin(), Polygons.end()), Polygons.end());
+
+	NeighboursA.clear();
+	NeighboursB.clear();
+	Shared.clear();
+	for (const unsigned polygon : Polygons) {
+		Roots.clear();
+		for (unsigned corner = snapshot.PolygonStart[polygon]; corner < snapshot.PolygonStart[polygon + 1]; ++corner) {
+			Roots.push_back(Root(snapshot.PolygonVertices[corner]));
+		}
+
+		const unsigned size = static_cast<unsigned>(Roots.size());
+		unsigned runs = 0;
+		bool hasA = false;
+		bool hasB = false;
+		for (unsigned i = 0; i < size; ++i) {
+			const unsigned root = Roots[i];
+			const unsigned prev = Roots[(i + size - 1) % size];
+			const unsigned next = Roots[(i + 1) % size];
+			const bool merged = root == a || root == b;
+			runs += merged && prev != a && prev != b ? 1 : 0;
+			hasA |= root == a;
+			hasB |= root == b;
+			for (const unsigned side : {prev, next}) {
+				if (side != a && side != b && merged) {
+					(root == a ? NeighboursA : NeighboursB).push_back(side);
+				}
+			}
+		}
+		// the merged point would be passed twice
+		if (runs > 1) {
+			return false;
+		}
+
+		// polygons holding both ends and at most one other point vanish, their third point may be shared
+		if (hasA && hasB) {
+			std::sort(Roots.begin(), Roots.end());
+			Roots.erase(std::unique(Roots.begin(), Roots.end()), Roots.end());
+			if (Roots.size() <= 3) {
+				for (const unsigned root : Roots) {
+					if (root != a && root != b) {
+						Shared.push_back(root);
+					}
+				}
+			}
+		}
+	}
+
+	for (auto* neighbours : {&NeighboursA, &NeighboursB, &Shared}) {
+		std::sort(neighbours->begin(), neighbours->end());
+		neighbours->erase(std::unique(neighbours->begin(), neighbours->end()), neighbours->end());
+	}
+
+	// link condition: every point next to both ends lies on a vanishing polygon
+	auto shared = Shared.begin();
+	auto other = NeighboursB.begin();
+	for (const unsigned neighbour : NeighboursA) {
+		other = std::lower_bound(other, NeighboursB.end(), neighbour);
+		if (other == NeighboursB.end()) {
+			break;
+		}
+		if (*other != neighbour) {
+			continue;
+		}
+		shared = std::lower_bound(shared, Shared.end(), neighbour);
+		if (shared == Shared.end() || *shared != neighbour) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void TEdgeCollapse::Rebuild()
+{
+	const auto& snapshot = Topology.Snapshot;
+	const unsigned pointCount = Topology.PointCount();
+	const unsigned polygonCount = snapshot.PolygonCount();
+	if (Collapsed.empty()) {
+		return;
+	}
+
+	for (unsigned point = 0; point < pointCount; ++point) {
+		if (Parent[point] != point) {
+			Result.Unused.push_back(point);
+			continue;
+		}
+		if (Ring[point] == point) {
+			continue;
+		}
+
+		TVectorF sum(0.0f);
+		unsigned count = 0;
+		unsigned member = point;
+		do {
+			sum += snapshot.Positions[member];
+			++count;
+			member = Ring[member];
+		} while (member != point);
+		Result.Moved.push_back(point);
+		Result.MovedPositions.push_back(sum / static_cast<float>(count));
+	}
+
+	// 0 - untouched, 1 - rewritten, 2 - collapsed
+	std::vector<uint8_t> state(polygonCount, 0);
+	std::vector<unsigned> newCount(polygonCount, 0);
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		const unsigned begin = snapshot.PolygonStart[polygon];
+		const unsigned end = snapshot.PolygonStart[polygon + 1];
+
+		bool changed = false;
+		for (unsigned slot = begin; slot < end && !changed; ++slot) {
+			const unsigned point = snapshot.PolygonVertices[slot];
+			changed = Parent[point] != point;
+		}
+		if (!changed) {
+			return;
+		}
+
+		unsigned distinct = 0;
+		for (unsigned slot = begin; slot < end; ++slot) {
+			const unsigned point = Parent[snapshot.PolygonVertices[slot]];
+			const unsigned prev = Parent[snapshot.PolygonVertices[slot == begin ? end - 1 : slot - 1]];
+			distinct += point != prev ? 1 : 0;
+		}
+
+		const unsigned minimum = std::min(end - begin, 3u);
+		state[polygon] = distinct < minimum ? 2 : 1;
+		newCount[polygon] = state[polygon] == 1 ? distinct : 0;
+	});
+
+	auto& rewritten = Result.Rewritten;
+	auto& start = Result.RewrittenStart;
+	for (unsigned polygon = 0; polygon < polygonCount; ++polygon) {
+		if (state[polygon] == 1) {
+			rewritten.push_back(polygon);
+			start.push_back(newCount[polygon]);
+		}
+		else if (state[polygon] == 2) {
+			Result.Removed.push_back(polygon);
+		}
+	}
+	start.push_back(0);
+	Result.RewrittenVertices.resize(NParallel::ExclusiveScan(start));
+
+	NParallel::For(rewritten.size(), [&](size_t index) {
+		const unsigned polygon = rewritten[index];
+		const unsigned begin = snapshot.PolygonStart[polygon];
+		const unsigned end = snapshot.PolygonStart[polygon + 1];
+
+		unsigned out = start[index];
+		for (unsigned slot = begin; slot < end; ++slot) {
+			const unsigned point = Parent[snapshot.PolygonVertices[slot]];
+			const unsigned prev = Parent[snapshot.PolygonVertices[slot == begin ? end - 1 : slot - 1]];
+			if (point != prev) {
+				Result.RewrittenVertices[out++] = point;
+			}
+		}
+	});
+}
+
+TEdgeDissolve::TEdgeDissolve(const TTopology& topology, const std::vector<unsigned>& edges)
+	: Topology(topology)
+{
+	const auto& snapshot = Topology.Snapshot;
+	const auto& vertices = snapshot.PolygonVertices;
+	const unsigned polygonCount = snapshot.PolygonCount();
+
+	std::vector<unsigned> parent(polygonCount);
+	std::iota(parent.begin(), parent.end(), 0u);
+	auto root = [&parent](unsigned polygon) {
+		while (parent[polygon] != polygon) {
+			parent[polygon] = parent[parent[polygon]];
+			polygon = parent[polygon];
+		}
+		return polygon;
+	};
+
+	// only manifold edges between two consistently wound polygons can go
+	std::vector<unsigned> candidates;
+	for (const unsigned edge : SortedUnique(edges)) {
+		const unsigned slot = Topology.EdgeCornerStart[edge];
+		if (Topology.EdgePolygonCount(edge) != 2) {
+			Rejected.push_back(edge);
+			continue;
+		}
+		const unsigned c0 = Topology.EdgeCorners[slot];
+		const unsigned c1 = Topology.EdgeCorners[slot + 1];
+		const unsigned p0 = Topology.CornerPolygon[c0];
+		const unsigned p1 = Topology.CornerPolygon[c1];
+		if (p0 == p1 || vertices[c0] != vertices[Topology.NextCorner(c1)]) {
+			Rejected.push_back(edge);
+			continue;
+		}
+		candidates.push_back(edge);
+		const unsigned r0 = root(p0);
+		const unsigned r1 = root(p1);
+		parent[std::max(r0, r1)] = std::min(r0, r1);
+	}
+	for (unsigned polygon = 0; polygon < polygonCount; ++polygon) {
+		parent[polygon] = root(polygon);
+	}
+
+	// groups of two or more polygons, members ascending, groups ordered by their lowest polygon
+	std::vector<unsigned> groupOf(polygonCount, 0);
+	for (unsigned polygon = 0; polygon < polygonCount; ++polygon) {
+		++groupOf[parent[polygon]];
+	}
+	std::vector<unsigned> groups;
+	std::vector<unsigned> groupStart(1, 0);
+	for (unsigned polygon = 0; polygon < polygonCount; ++polygon) {
+		const unsigned size = groupOf[polygon];
+		groupOf[polygon] = TTopology::Invalid;
+		if (size > 1) {
+			groupOf[polygon] = static_cast<unsigned>(groups.size());
+			groups.push_back(polygon);
+			groupStart.push_back(groupStart.back() + size);
+		}
+	}
+	std::vector<unsigned> members(groupStart.back());
+	std::vector<unsigned> cursor(groupStart.begin(), groupStart.end() - 1);
+	for (unsigned polygon = 0; polygon < polygonCount; ++polygon) {
+		const unsigned group = groupOf[parent[polygon]];
+		if (group != TTopology::Invalid) {
+			members[cursor[group]++] = polygon;
+		}
+	}
+
+	// outline of each group, chunk results joined in group order
+	struct TLocal
+	{
+		std::vector<unsigned> Rewritten;
+		std::vector<unsigned> RewrittenSize;
+		std::vector<unsigned> RewrittenVertices;
+		std::vector<unsigned> Removed;
+		std::vector<unsigned> Unused;
+	};
+	std::vector<uint8_t> merged(groups.size(), 0);
+	std::vector<TLocal> chunkResults(NParallel::ChunkCount(groups.size(), 256));
+	NParallel::ForChunks(groups.size(), [&](unsigned chunk, size_t begin, size_t end) {
+		auto& local = chunkResults[chunk];
+		std::vector<unsigned> outline;
+		std::vector<std::pair<unsigned, unsigned>> starts;
+		for (size_t group = begin; group < end; ++group) {
+			const unsigned root = groups[group];
+			starts.clear();
+			for (unsigned slot = groupStart[group]; slot < groupStart[group + 1]; ++slot) {
+				const unsigned polygon = members[slot];
+				for (unsigned corner = snapshot.PolygonStart[polygon]; corner < snapshot.PolygonStart[polygon + 1]; ++corner) {
+					const unsigned edge = Topology.CornerEdge[corner];
+					if (edge == TTopology::Invalid) {
+						continue;
+					}
+					// edges between two polygons of the group go with it, selected or not
+					const unsigned first = Topology.EdgeCornerStart[edge];
+					const unsigned other = Topology.EdgeCorners[first] == corner ? Topology.EdgeCorners[first + 1] : Topology.EdgeCorners[first];
+					if (Topology.EdgePolygonCount(edge) != 2 || parent[Topology.CornerPolygon[other]] != root) {
+						starts.emplace_back(vertices[corner], corner);
+					}
+				}
+			}
+			if (starts.size() < 3) {
+				continue;
+			}
+
+			const unsigned firstCorner = starts.front().second;
+			std::sort(starts.begin(), starts.end());
+			bool simple = true;
+			for (size_t i = 1; i < starts.size() && simple; ++i) {
+				simple = starts[i].first != starts[i - 1].first;
+			}
+
+			outline.clear();
+			unsigned corner = firstCorner;
+			while (simple && outline.size() < starts.size()) {
+				outline.push_back(vertices[corner]);
+				const unsigned point = vertices[Topology.NextCorner(corner)];
+				const auto next = std::lower_bound(starts.begin(), starts.end(), std::make_pair(point, 0u));
+				if (next == starts.end() || next->first != point) {
+					simple = false;
+					break;
+				}
+				corner = next->second;
+				if (corner == firstCorner) {
+					break;
+				}
+			}
+			// a second loop means a hole
+			if (!simple || corner != firstCorner || outline.size() != starts.size()) {
+				continue;
+			}
+
+			merged[group] = 1;
+			local.Rewritten.push_back(root);
+			local.RewrittenSize.push_back(static_cast<unsigned>(outline.size()));
+			local.RewrittenVertices.insert(local.RewrittenVertices.end(), outline.begin(), outline.end());
+
+			for (unsigned slot = groupStart[group]; slot < groupStart[group + 1]; ++slot) {
+				const unsigned polygon = members[slot];
+				if (polygon != root) {
+					local.Removed.push_back(polygon);
+				}
+				for (unsigned vertex = snapshot.PolygonStart[polygon]; vertex < snapshot.PolygonStart[polygon + 1]; ++vertex) {
+					const unsigned point = vertices[vertex];
+					const auto found = std::lower_bound(starts.begin(), starts.end(), std::make_pair(point, 0u));
+					if (found != starts.end() && found->first == point) {
+						continue;
+					}
+					bool inside = true;
+					for (unsigned around = Topology.PointCornerStart[point]; around < Topology.PointCornerStart[point + 1] && inside; ++around) {
+						inside = parent[Topology.CornerPolygon[Topology.PointCorners[around]]] == root;
+					}
+					if (inside) {
+						local.Unused.push_back(point);
+					}
+				}
+			}
+		}
+	}, 256);
+
+	Result.RewrittenStart.assign(1, 0);
+	for (const auto& local : chunkResults) {
+		Result.Rewritten.insert(Result.Rewritten.end(), local.Rewritten.begin(), local.Rewritten.end());
+		for (const unsigned size : local.RewrittenSize) {
+			Result.RewrittenStart.push_back(Result.RewrittenStart.back() + size);
+		}
+		Result.RewrittenVertices.insert(Result.RewrittenVertices.end(), local.RewrittenVertices.begin(), local.RewrittenVertices.end());
+		Result.Removed.insert(Result.Removed.end(), local.Removed.begin(), local.Removed.end());
+		Result.Unused.insert(Result.Unused.end(), local.Unused.begin(), local.Unused.end());
+	}
+	std::sort(Result.Removed.begin(), Result.Removed.end());
+	Result.Unused = SortedUnique(std::move(Result.Unused));
+
+	for (const unsigned edge : candidates) {
+		const unsigned polygon = Topology.CornerPolygon[Topology.EdgeCorners[Topology.EdgeCornerStart[edge]]];
+		(merged[groupOf[parent[polygon]]] ? Dissolved : Rejected).push_back(edge);
+	}
+	std::sort(Rejected.begin(), Rejected.end());
+}
+
+void TEdgeDissolve::Apply(TMesh& mesh) const
+{
+	Result.Apply(mesh, Topology.Snapshot);
+}
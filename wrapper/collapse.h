@@ -0,0 +1,90 @@
+#pragma once
+
+#include "topology.h"
+#include "vector.h"
+
+#include <vector>
+
+class TMesh;
+
+// Polygons rewritten, polygons and points removed and points moved by an
+// edge operation, written to the host in one edit batch.
+struct TPolygonRebuild
+{
+	std::vector<unsigned> Moved;
+	std::vector<TVectorF> MovedPositions;
+
+	std::vector<unsigned> Rewritten;
+	std::vector<unsigned> RewrittenStart;
+	std::vector<unsigned> RewrittenVertices;
+
+	std::vector<unsigned> Removed;
+	std::vector<unsigned> Unused;
+
+	bool Empty() const;
+	void Apply(TMesh& mesh, const TMeshSnapshot& snapshot) const;
+};
+
+// Collapses edges to the centre of the points they join. Edges are taken in
+// ascending order and chained collapses merge into one point. An edge is
+// rejected when merging its ends would make a polygon pass the merged point
+// twice or join two polygons over a new edge - the link condition - so the
+// result stays as manifold as the input.
+class TEdgeCollapse
+{
+public:
+	TEdgeCollapse(const TTopology& topology, const std::vector<unsigned>& edges);
+	TEdgeCollapse(const TEdgeCollapse& rhs) = delete;
+	TEdgeCollapse& operator=(const TEdgeCollapse& rhs) = delete;
+
+	// point each point merged into, points not merged map to themselves
+	const std::vector<unsigned>& Remap() const;
+
+	void Apply(TMesh& mesh) const;
+
+public:
+	std::vector<unsigned> Collapsed;
+	std::vector<unsigned> Rejected;
+	TPolygonRebuild Result;
+
+private:
+	unsigned Root(unsigned point);
+	bool Allowed(unsigned a, unsigned b);
+	void Rebuild();
+
+private:
+	const TTopology& Topology;
+	std::vector<unsigned> Parent;
+	// circular list of the points merged together
+	std::vector<unsigned> Ring;
+
+	// scratch for Allowed
+	std::vector<unsigned> Polygons;
+	std::vector<unsigned> Roots;
+	std::vector<unsigned> NeighboursA;
+	std::vector<unsigned> NeighboursB;
+	std::vector<unsigned> Shared;
+};
+
+// Removes edges and merges the polygons on both sides into one. Edges are
+// grouped with the polygons they join; a group whose outline is not a single
+// simple loop - it would enclose a hole or touch itself in a point - is left
+// alone and its edges are rejected. The merged polygon replaces the lowest
+// polygon of its group, points left inside a group are removed.
+class TEdgeDissolve
+{
+public:
+	TEdgeDissolve(const TTopology& topology, const std::vector<unsigned>& edges);
+	TEdgeDissolve(const TEdgeDissolve& rhs) = delete;
+	TEdgeDissolve& operator=(const TEdgeDissolve& rhs) = delete;
+
+	void Apply(TMesh& mesh) const;
+
+public:
+	std::vector<unsigned> Dissolved;
+	std::vector<unsigned> Rejected;
+	TPolygonRebuild Result;
+
+private:
+	const TTopology& Topology;
+};
@@ -0,0 +1,435 @@
+#include "decimation.h"
+
+#include "mesh.h"
+#include "parallel.h"
+#include "snapshot.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace {
+	using TQuadric = std::array<double, 10>;
+
+	// std heaps keep the largest element on top
+	struct TCheaperFirst
+	{
+		template<typename T>
+		bool operator()(const T& a, const T& b) const
+		{
+			return a.Cost > b.Cost;
+		}
+	};
+
+	TQuadric PlaneQuadric(const TVectorD& normal, double d, double weight)
+	{
+		const double a = normal.x;
+		const double b = normal.y;
+		const double c = normal.z;
+		return {
+			weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+			weight * b * b, weight * b * c, weight * b * d,
+			weight * c * c, weight * c * d,
+			weight * d * d,
+		};
+	}
+
+	void Add(TQuadric& q, const TQuadric& rhs)
+	{
+		for (size_t i = 0; i < q.size(); ++i) {
+			q[i] += rhs[i];
+		}
+	}
+
+	double QuadricError(const TQuadric& q, const TVectorD& v)
+	{
+		const double error =
+			q[0] * v.x * v.x + 2.0 * q[1] * v.x * v.y + 2.0 * q[2] * v.x * v.z + 2.0 * q[3] * v.x
+			+ q[4] * v.y * v.y + 2.0 * q[5] * v.y * v.z + 2.0 * q[6] * v.y
+			+ q[7] * v.z * v.z + 2.0 * q[8] * v.z
+			+ q[9];
+		return std::max(error, 0.0);
+	}
+
+	// minimum of the quadric, none when it is not well conditioned
+	std::optional<TVectorD> Optimal(const TQuadric& q)
+	{
+		// Cramer's rule on the symmetric 3x3 part
+		const TVectorD c0(q[0], q[1], q[2]);
+		const TVectorD c1(q[1], q[4], q[5]);
+		const TVectorD c2(q[2], q[5], q[7]);
+		const TVectorD b = -TVectorD(q[3], q[6], q[8]);
+		const double det = glm::dot(c0, glm::cross(c1, c2));
+		const double scale = q[0] * q[4] * q[7];
+		if (std::abs(det) <= 1e-12 * std::max(std::abs(scale), 1e-300)) {
+			return {};
+		}
+		return TVectorD(glm::dot(b, glm::cross(c1, c2)), glm::dot(c0, glm::cross(b, c2)), glm::dot(c0, glm::cross(c1, b))) / det;
+	}
+} // anonymous namespace
+
+TDecimation::TDecimation(const TTopology& topology, const TBitSet& keep)
+	: Topology(topology)
+{
+	const auto& snapshot = Topology.Snapshot;
+	const unsigned pointCount = Topology.PointCount();
+	const unsigned polygonCount = Topology.PolygonCount();
+
+	Positions = snapshot.Positions;
+	Vertices = snapshot.PolygonVertices;
+	Sizes.resize(polygonCount);
+	Dead.assign(polygonCount, 0);
+	Removed.assign(pointCount, 0);
+	Versions.assign(pointCount, 0);
+	Alive = polygonCount;
+
+	std::vector<TQuadric> polygonQuadrics(polygonCount);
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		const unsigned begin = snapshot.PolygonStart[polygon];
+		const unsigned end = snapshot.PolygonStart[polygon + 1];
+		Sizes[polygon] = end - begin;
+
+		TVectorD normal(0.0);
+		TVectorD centroid(0.0);
+		for (unsigned corner = begin; corner < end; ++corner) {
+			const TVectorD a(Positions[Vertices[corner]]);
+			normal += glm::cross(a, TVectorD(Positions[Vertices[Topology.NextCorner(corner)]]));
+			centroid += a;
+		}
+		const double length = glm::length(normal);
+		if (length > 0.0) {
+			centroid /= static_cast<double>(end - begin);
+			normal /= length;
+			// area weighted
+			polygonQuadrics[polygon] = PlaneQuadric(normal, -glm::dot(normal, centroid), 0.5 * length);
+		}
+		else {
+			polygonQuadrics[polygon] = {};
+		}
+	}, 1024);
+
+	const bool anyKept = keep.Size() != 0;
+	Quadrics.resize(pointCount);
+	Fixed.resize(pointCount);
+	PointPolygons.resize(pointCount);
+	NParallel::For(pointCount, [&](size_t point) {
+		TQuadric& q = Quadrics[point];
+		q = {};
+		auto& polygons = PointPolygons[point];
+		for (unsigned slot = Topology.PointCornerStart[point]; slot < Topology.PointCornerStart[point + 1]; ++slot) {
+			const unsigned polygon = Topology.CornerPolygon[Topology.PointCorners[slot]];
+			if (polygons.empty() || polygons.back() != polygon) {
+				Add(q, polygonQuadrics[polygon]);
+				polygons.push_back(polygon);
+			}
+		}
+
+		bool fixed = anyKept && keep.Test(static_cast<unsigned>(point));
+		for (unsigned slot = Topology.PointEdgeStart[point]; slot < Topology.PointEdgeStart[point + 1] && !fixed; ++slot) {
+			fixed = Topology.EdgePolygonCount(Topology.PointEdges[slot]) != 2;
+		}
+		Fixed[point] = fixed ? 1 : 0;
+	}, 1024);
+
+	std::vector<TCollapse> planned(Topology.EdgeCount());
+	std::vector<uint8_t> valid(planned.size());
+	NParallel::For(planned.size(), [&](size_t edge) {
+		valid[edge] = Plan(Topology.Edges[edge][0], Topology.Edges[edge][1], planned[edge]) ? 1 : 0;
+	}, 1024);
+	for (size_t edge = 0; edge < planned.size(); ++edge) {
+		if (valid[edge]) {
+			Heap.push_back(planned[edge]);
+		}
+	}
+	std::make_heap(Heap.begin(), Heap.end(), TCheaperFirst());
+}
+
+bool TDecimation::Plan(unsigned a, unsigned b, TCollapse& collapse) const
+{
+	if (Fixed[a] && Fixed[b]) {
+		return false;
+	}
+
+	TQuadric q = Quadrics[a];
+	Add(q, Quadrics[b]);
+
+	collapse.From = Fixed[a] ? b : a;
+	collapse.To = Fixed[a] ? a : b;
+	collapse.FromVersion = Versions[collapse.From];
+	collapse.ToVersion = Versions[collapse.To];
+
+	const TVectorD to(Positions[collapse.To]);
+	if (Fixed[collapse.To]) {
+		collapse.Position = Positions[collapse.To];
+		collapse.Cost = QuadricError(q, to);
+		return true;
+	}
+
+	const TVectorD from(Positions[collapse.From]);
+	std::optional<TVectorD> best = Optimal(q);
+	if (!best) {
+		best = to;
+		for (const TVectorD& candidate : {from, 0.5 * (from + to)}) {
+			if (QuadricError(q, candidate) < QuadricError(q, *best)) {
+				best = candidate;
+			}
+		}
+	}
+	collapse.Position = TVectorF(*best);
+	collapse.Cost = QuadricError(q, *best);
+	return true;
+}
+
+void TDecimation::Push(const TCollapse& collapse)
+{
+	Heap.push_back(collapse);
+	std::push_heap(Heap.begin(), Heap.end(), TCheaperFirst());
+}
+
+bool TDecimation::Contains(unsigned polygon, unsigned point) const
+{
+	const auto begin = Vertices.begin() + Topology.Snapshot.PolygonStart[polygon];
+	return std::find(begin, begin + Sizes[polygon], point) != begin + Sizes[polygon];
+}
+
+bool TDecimation::Adjacent(unsigned polygon, unsigned a, unsigned b) const
+{
+	const unsigned start = Topology.Snapshot.PolygonStart[polygon];
+	const unsigned size = Sizes[polygon];
+	for (unsigned i = 0; i < size; ++i) {
+		const unsigned p = Vertices[start + i];
+		const unsigned q = Vertices[start + (i + 1) % size];
+		if ((p == a && q == b) || (p == b && q == a)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void TDecimation::Neighbours(unsigned point, std::vector<unsigned>& result) const
+{
+	result.clear();
+	for (const unsigned polygon : PointPolygons[point]) {
+		if (Dead[polygon]) {
+			continue;
+		}
+		const unsigned start = Topology.Snapshot.PolygonStart[polygon];
+		const unsigned size = Sizes[polygon];
+		for (unsigned i = 0; i < size; ++i) {
+			if (Vertices[start + i] == point) {
+				result.push_back(Vertices[start + (i + 1) % size]);
+				result.push_back(Vertices[start + (i + size - 1) % size]);
+			}
+		}
+	}
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+TVectorD TDecimation::Normal(unsigned polygon, unsigned from, unsigned to, const TVectorF& position) const
+{
+	const unsigned start = Topology.Snapshot.PolygonStart[polygon];
+	const unsigned size = Sizes[polygon];
+	auto pos = [&](unsigned i) {
+		const unsigned point = Vertices[start + i % size];
+		return TVectorD(point == from || point == to ? position : Positions[point]);
+	};
+
+	// repeated points add nothing to the Newell sum
+	TVectorD normal(0.0);
+	for (unsigned i = 0; i < size; ++i) {
+		normal += glm::cross(pos(i), pos(i + 1));
+	}
+	return normal;
+}
+
+bool TDecimation::CanCollapse(const TCollapse& collapse)
+{
+	// points next to both ends must lie on a polygon shared by both, or the surface pinches
+	Neighbours(collapse.From, NeighboursFrom);
+	Neighbours(collapse.To, NeighboursTo);
+	std::vector<unsigned> common;
+	std::set_intersection(NeighboursFrom.begin(), NeighboursFrom.end(), NeighboursTo.begin(), NeighboursTo.end(), std::back_inserter(common));
+	for (const unsigned point : common) {
+		bool shared = false;
+		for (const unsigned polygon : PointPolygons[point]) {
+			if (!Dead[polygon] && Contains(polygon, collapse.From) && Contains(polygon, collapse.To)) {
+				shared = true;
+				break;
+			}
+		}
+		if (!shared) {
+			return false;
+		}
+	}
+
+	// no polygon may flip
+	const unsigned none = TTopology::Invalid;
+	for (const unsigned point : {collapse.From, collapse.To}) {
+		for (const unsigned polygon : PointPolygons[point]) {
+			if (Dead[polygon]) {
+				continue;
+			}
+			const bool both = Contains(polygon, collapse.From) && Contains(polygon, collapse.To);
+			// a diagonal would fold the polygon onto itself
+			if (both && !Adjacent(polygon, collapse.From, collapse.To)) {
+				return false;
+			}
+			if (both && Sizes[polygon] <= 3) {
+				continue;
+			}
+			const TVectorD before = Normal(polygon, none, none, TVectorF());
+			const TVectorD after = Normal(polygon, collapse.From, collapse.To, collapse.Position);
+			if (glm::dot(before, after) <= 0.0) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void TDecimation::Collapse(const TCollapse& collapse)
+{
+	const unsigned from = collapse.From;
+	const unsigned to = collapse.To;
+	const auto& start = Topology.Snapshot.PolygonStart;
+
+	Add(Quadrics[to], Quadrics[from]);
+	Positions[to] = collapse.Position;
+	Removed[from] = 1;
+	++Versions[from];
+	++Versions[to];
+	ErrorValue = collapse.Cost;
+
+	auto& target = PointPolygons[to];
+	for (const unsigned polygon : PointPolygons[from]) {
+		if (Dead[polygon]) {
+			continue;
+		}
+		const bool had = Contains(polygon, to);
+
+		// substitute and drop repeats, the polygon may shrink
+		const auto begin = Vertices.begin() + start[polygon];
+		std::replace(begin, begin + Sizes[polygon], from, to);
+		unsigned size = static_cast<unsigned>(std::unique(begin, begin + Sizes[polygon]) - begin);
+		while (size > 1 && *begin == *(begin + size - 1)) {
+			--size;
+		}
+		Sizes[polygon] = size;
+
+		if (size < 3) {
+			Dead[polygon] = 1;
+			--Alive;
+		}
+		else if (!had) {
+			target.push_back(polygon);
+		}
+	}
+	PointPolygons[from].clear();
+	std::erase_if(target, [this](unsigned polygon) {
+		return Dead[polygon] != 0;
+	});
+
+	Neighbours(to, NeighboursTo);
+	for (const unsigned point : NeighboursTo) {
+		TCollapse next;
+		if (!Removed[point] && Plan(std::min(to, point), std::max(to, point), next)) {
+			Push(next);
+		}
+	}
+}
+
+void TDecimation::Run(unsigned polygonCount, double maxError)
+{
+	while (Alive > polygonCount && !Heap.empty()) {
+		std::pop_heap(Heap.begin(), Heap.end(), TCheaperFirst());
+		const TCollapse collapse = Heap.back();
+		Heap.pop_back();
+
+		// stale entries are dropped here rather than updated in place
+		if (Removed[collapse.From] || Removed[collapse.To] || Versions[collapse.From] != collapse.FromVersion || Versions[collapse.To] != collapse.ToVersion) {
+			continue;
+		}
+		if (collapse.Cost > maxError) {
+			Push(collapse);
+			break;
+		}
+		if (CanCollapse(collapse)) {
+			Collapse(collapse);
+		}
+	}
+}
+
+unsigned TDecimation::PolygonCount() const
+{
+	return Alive;
+}
+
+unsigned TDecimation::RemovedPointCount() const
+{
+	return static_cast<unsigned>(std::count(Removed.begin(), Removed.end(), 1));
+}
+
+double TDecimation::Error() const
+{
+	return ErrorValue;
+}
+
+void TDecimation::Apply(TMesh& mesh) const
+{
+	const auto& snapshot = Topology.Snapshot;
+	// every collapse removes a point, even one that only shortens its polygons
+	if (std::find(Removed.begin(), Removed.end(), 1) == Removed.end()) {
+		return;
+	}
+
+	mesh.BeginEditBatch();
+
+	auto polygon = mesh.InitPolygon();
+	std::vector<LXtPointID> vertices;
+	for (unsigned index = 0; index < snapshot.PolygonCount(); ++index) {
+		const unsigned begin = snapshot.PolygonStart[index];
+		if (Dead[index] || std::equal(Vertices.begin() + begin, Vertices.begin() + begin + Sizes[index], snapshot.PolygonVertices.begin() + begin, snapshot.PolygonVertices.begin() + snapshot.PolygonStart[index + 1])) {
+			continue;
+		}
+		vertices.clear();
+		for (unsigned slot = begin; slot < begin + Sizes[index]; ++slot) {
+			vertices.push_back(snapshot.PointIds[Vertices[slot]]);
+		}
+		polygon.Select(snapshot.PolygonIds[index]);
+		polygon.SetVertexList(vertices.data(), static_cast<unsigned>(vertices.size()), 0);
+	}
+	for (unsigned index = 0; index < snapshot.PolygonCount(); ++index) {
+		if (Dead[index]) {
+			polygon.Select(snapshot.PolygonIds[index]);
+			polygon.Remove();
+		}
+	}
+	mesh.AddChange(LXf_MESHEDIT_POLYGONS);
+
+	auto point = mesh.InitPoint();
+	for (unsigned index = 0; index < snapshot.PointCount(); ++index) {
+		if (!Removed[index] && Positions[index] != snapshot.Positions[index]) {
+			const TVectorD pos(Positions[index]);
+			point.Select(snapshot.PointIds[index]);
+			point.SetPos(&pos.x);
+			mesh.AddChange(LXf_MESHEDIT_POSITION);
+		}
+	}
+
+	// collapsed points and points left without polygons
+	for (unsigned index = 0; index < snapshot.PointCount(); ++index) {
+		const auto& polygons = PointPolygons[index];
+		const bool orphan = !polygons.empty() && std::all_of(polygons.begin(), polygons.end(), [this](unsigned p) {
+			return Dead[p] != 0;
+		});
+		if (Removed[index] || orphan) {
+			point.Select(snapshot.PointIds[index]);
+			point.Remove();
+		}
+	}
+	mesh.AddChange(LXf_MESHEDIT_POINTS);
+
+	mesh.EndEditBatch();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "bitset.h"
+#include "vector.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class TMesh;
+class TTopology;
+
+// Quadric error edge collapse. Collapses are taken cheapest first from a
+// heap whose entries carry the versions of both points; entries whose
+// points changed since are skipped when popped instead of being searched
+// for and updated. Boundary and non-manifold points and the kept points
+// never move, so open borders and marked areas survive. Polygons are only
+// shortened, never recreated, and keep their host marks and tags.
+class TDecimation
+{
+public:
+	// keep is indexed by point, an empty set keeps only the boundaries
+	explicit TDecimation(const TTopology& topology, const TBitSet& keep = TBitSet());
+	TDecimation(const TDecimation& rhs) = delete;
+	TDecimation& operator=(const TDecimation& rhs) = delete;
+
+	// collapses until polygonCount polygons are left or the next collapse costs more than maxError
+	void Run(unsigned polygonCount, double maxError = std::numeric_limits<double>::max());
+
+	unsigned PolygonCount() const;
+	unsigned RemovedPointCount() const;
+	// cost of the last collapse
+	double Error() const;
+
+	// moves points, shortens polygons and removes collapsed polygons and points in one edit batch
+	void Apply(TMesh& mesh) const;
+
+private:
+	// symmetric 4x4: xx xy xz xw yy yz yw zz zw ww
+	using TQuadric = std::array<double, 10>;
+
+	struct TCollapse
+	{
+		double Cost = 0.0;
+		unsigned From = 0;
+		unsigned To = 0;
+		unsigned FromVersion = 0;
+		unsigned ToVersion = 0;
+		TVectorF Position;
+	};
+
+	bool Plan(unsigned a, unsigned b, TCollapse& collapse) const;
+	bool CanCollapse(const TCollapse& collapse);
+	void Collapse(const TCollapse& collapse);
+	void Push(const TCollapse& collapse);
+
+	bool Contains(unsigned polygon, unsigned point) const;
+	bool Adjacent(unsigned polygon, unsigned a, unsigned b) const;
+	// points sharing a polygon side with point, sorted
+	void Neighbours(unsigned point, std::vector<unsigned>& result) const;
+	TVectorD Normal(unsigned polygon, unsigned from, unsigned to, const TVectorF& position) const;
+
+private:
+	const TTopology& Topology;
+
+	std::vector<TQuadric> Quadrics;
+	std::vector<TVectorF> Positions;
+	std::vector<uint8_t> Fixed;
+	std::vector<uint8_t> Removed;
+	std::vector<unsigned> Versions;
+
+	// polygons keep their snapshot slots and shrink in place
+	std::vector<unsigned> Vertices;
+	std::vector<unsigned> Sizes;
+	std::vector<uint8_t> Dead;
+	std::vector<std::vector<unsigned>> PointPolygons;
+
+	std::vector<TCollapse> Heap;
+	unsigned Alive = 0;
+	double ErrorValue = 0.0;
+
+	std::vector<unsigned> NeighboursFrom;
+	std::vector<unsigned> NeighboursTo;
+};
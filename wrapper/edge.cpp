@@ -18,14 +18,18 @@ TEdgeId::operator unsigned() const
 	return Index;
 }
 
-TEdge::TEdge(CLxUser_Edge& edge)
+TEdge::TEdge(CLxUser_Edge& edge, TMesh* mesh)
 	: Edge(edge)
+	, Mesh(mesh)
 {
 }
 
 void TEdge::SetMark(TMarkMode mark)
 {
 	Edge.SetMarks(mark.Mode);
+	if (Mesh) {
+		Mesh->AddChange(LXf_MESHEDIT_UPDATE);
+	}
 }
 
 bool TEdge::TestMark(TMarkMode mark) const
@@ -118,13 +122,13 @@ TPolygon TEdge::Get(CLxUser_Polygon* p, unsigned index)
 	LXtPolygonID id;
 	Edge.PolygonByIndex(index, &id);
 	p->Select(id);
-	return TPolygon(*p);
+	return TPolygon(*p, Mesh);
 }
 
 TPoint TEdge::Get(CLxUser_Point* p, unsigned index) {
 	auto id = EndpointsID()[index];
 	p->Select(id);
-	return TPoint(*p);
+	return TPoint(*p, Mesh);
 }
 
 bool TEdge::CheckNGon() 
@@ -185,11 +189,11 @@ bool TEdge::operator!=(const TEdge& rhs) const {
 }
 
 TEdgeHolder::TEdgeHolder(TMesh& mesh, LXtEdgeID id)
-    : TEdge(UserEdge_) {
+    : TEdge(UserEdge_, &mesh) {
     UserEdge_ = mesh.GetEdge(id);
 }
 
 TEdgeHolder::TEdgeHolder(TMesh& mesh, LXtPointID id1, LXtPointID id2)
-    : TEdge(UserEdge_) {
+    : TEdge(UserEdge_, &mesh) {
     UserEdge_ = mesh.GetEdge(id1, id2);
 }
@@ -27,7 +27,8 @@ class TEdge
 public:
 	using TUserData = CLxUser_Edge;
 
-	explicit TEdge(CLxUser_Edge& edge);
+	// edits are recorded in mesh when given
+	explicit TEdge(CLxUser_Edge& edge, TMesh* mesh = nullptr);
 	TEdge(const TEdge& rhs) = delete;
 	TEdge& operator=(const TEdge& rhs) = delete;
 	TEdge(TEdge&& rhs) = delete;
@@ -70,6 +71,7 @@ public:
 	bool Test() const;
 private:
 	CLxUser_Edge& Edge;
+	TMesh* Mesh = nullptr;
 };
 
 class TMesh;
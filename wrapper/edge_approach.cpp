@@ -0,0 +1,215 @@
+#include "edge_approach.h"
+
+#include "bvh.h"
+#include "edge.h"
+#include "mesh.h"
+#include "parallel.h"
+#include "point.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace {
+	constexpr unsigned Block = 64;
+	constexpr size_t EdgeGrain = 512;
+
+	// structure of arrays for one block of candidate pairs
+	struct TPairBlock
+	{
+		unsigned Count = 0;
+		unsigned EdgeA[Block];
+		unsigned EdgeB[Block];
+		float P1[3][Block];
+		float Q1[3][Block];
+		float P2[3][Block];
+		float Q2[3][Block];
+		float S[Block];
+		float T[Block];
+		float Dist2[Block];
+	};
+
+	float Clamp01(float v)
+	{
+		return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+	}
+
+	// Ericson, Real-Time Collision Detection, 5.1.9, with branches turned into selects;
+	// tolerances are relative to the squared edge lengths so short edges are not mistaken
+	// for parallel or degenerate ones
+	void SolveBlock(TPairBlock& block)
+	{
+		constexpr float epsilon = 1e-6f;
+		constexpr float tiny = std::numeric_limits<float>::min();
+		for (unsigned i = 0; i < block.Count; ++i) {
+			const float d1x = block.Q1[0][i] - block.P1[0][i];
+			const float d1y = block.Q1[1][i] - block.P1[1][i];
+			const float d1z = block.Q1[2][i] - block.P1[2][i];
+			const float d2x = block.Q2[0][i] - block.P2[0][i];
+			const float d2y = block.Q2[1][i] - block.P2[1][i];
+			const float d2z = block.Q2[2][i] - block.P2[2][i];
+			const float rx = block.P1[0][i] - block.P2[0][i];
+			const float ry = block.P1[1][i] - block.P2[1][i];
+			const float rz = block.P1[2][i] - block.P2[2][i];
+
+			const float a = d1x * d1x + d1y * d1y + d1z * d1z;
+			const float e = d2x * d2x + d2y * d2y + d2z * d2z;
+			const float f = d2x * rx + d2y * ry + d2z * rz;
+			const float c = d1x * rx + d1y * ry + d1z * rz;
+			const float b = d1x * d2x + d1y * d2y + d1z * d2z;
+			const float denom = a * e - b * b;
+
+			const float scale = std::max(a + e, tiny);
+			const bool pointA = a <= epsilon * scale;
+			const bool pointB = e <= epsilon * scale;
+			const float invA = pointA ? 0.0f : 1.0f / a;
+			const float invE = pointB ? 0.0f : 1.0f / e;
+
+			// parallel segments get an arbitrary s, t is fixed up below
+			float s = denom > epsilon * a * e ? Clamp01((b * f - c * e) / denom) : 0.0f;
+			float t = (b * s + f) * invE;
+
+			const float sLow = Clamp01(-c * invA);
+			const float sHigh = Clamp01((b - c) * invA);
+			s = t < 0.0f ? sLow : (t > 1.0f ? sHigh : s);
+			t = Clamp01(t);
+
+			// degenerate segments: a point against a segment, or two points
+			s = pointB ? sLow : s;
+			t = pointB ? 0.0f : t;
+			s = pointA ? 0.0f : s;
+			t = pointA ? (pointB ? 0.0f : Clamp01(f * invE)) : t;
+
+			const float dx = rx + d1x * s - d2x * t;
+			const float dy = ry + d1y * s - d2y * t;
+			const float dz = rz + d1z * s - d2z * t;
+
+			block.S[i] = s;
+			block.T[i] = t;
+			block.Dist2[i] = dx * dx + dy * dy + dz * dz;
+		}
+	}
+
+	void Load(TPairBlock& block, const std::vector<TVectorF>& positions, const TEdgeSegment& a, const TEdgeSegment& b)
+	{
+		const unsigned i = block.Count;
+		for (int axis = 0; axis < 3; ++axis) {
+			block.P1[axis][i] = positions[a[0]][axis];
+			block.Q1[axis][i] = positions[a[1]][axis];
+			block.P2[axis][i] = positions[b[0]][axis];
+			block.Q2[axis][i] = positions[b[1]][axis];
+		}
+	}
+} // anonymous namespace
+
+TEdgeApproachSolver::TEdgeApproachSolver(const std::vector<TVectorF>& positions, const std::vector<TEdgeSegment>& edgesA, const std::vector<TEdgeSegment>& edgesB, float maxDistance)
+{
+	const bool sameSet = &edgesA == &edgesB;
+	const float maxDist2 = maxDistance * maxDistance;
+	const TVectorF margin(maxDistance);
+
+	std::vector<TBox> bounds(edgesB.size());
+	NParallel::For(edgesB.size(), [&](size_t edge) {
+		bounds[edge].Extend(positions[edgesB[edge][0]]);
+		bounds[edge].Extend(positions[edgesB[edge][1]]);
+	});
+	const TBvh bvh(bounds);
+	if (bvh.Empty()) {
+		return;
+	}
+
+	std::vector<std::vector<TEdgeApproach>> chunkResults(NParallel::ChunkCount(edgesA.size(), EdgeGrain));
+	NParallel::ForChunks(edgesA.size(), [&](unsigned chunk, size_t begin, size_t end) {
+		auto& local = chunkResults[chunk];
+		auto block = std::make_unique<TPairBlock>();
+		std::vector<unsigned> stack;
+
+		auto flush = [&]() {
+			SolveBlock(*block);
+			for (unsigned i = 0; i < block->Count; ++i) {
+				if (block->Dist2[i] > maxDist2) {
+					continue;
+				}
+				const float s = block->S[i];
+				const float t = block->T[i];
+				TEdgeApproach hit;
+				hit.EdgeA = block->EdgeA[i];
+				hit.EdgeB = block->EdgeB[i];
+				hit.ParamA = s;
+				hit.ParamB = t;
+				hit.PointA = TVectorF(block->P1[0][i], block->P1[1][i], block->P1[2][i]) * (1.0f - s) + TVectorF(block->Q1[0][i], block->Q1[1][i], block->Q1[2][i]) * s;
+				hit.PointB = TVectorF(block->P2[0][i], block->P2[1][i], block->P2[2][i]) * (1.0f - t) + TVectorF(block->Q2[0][i], block->Q2[1][i], block->Q2[2][i]) * t;
+				hit.Distance = std::sqrt(block->Dist2[i]);
+				local.push_back(hit);
+			}
+			block->Count = 0;
+		};
+
+		for (size_t a = begin; a < end; ++a) {
+			const TEdgeSegment& edgeA = edgesA[a];
+			TBox query;
+			query.Extend(positions[edgeA[0]]);
+			query.Extend(positions[edgeA[1]]);
+			query = TBox(query.Min - margin, query.Max + margin);
+
+			stack.assign(1, 0);
+			while (!stack.empty()) {
+				const unsigned index = stack.back();
+				stack.pop_back();
+				const auto& node = bvh.Nodes[index];
+				if (!node.Bounds.Overlaps(query)) {
+					continue;
+				}
+				if (!node.Leaf()) {
+					stack.push_back(node.Right);
+					stack.push_back(index + 1);
+					continue;
+				}
+
+				for (unsigned slot = node.First; slot < node.First + node.Count; ++slot) {
+					const unsigned b = bvh.Items[slot];
+					const TEdgeSegment& edgeB = edgesB[b];
+					if ((sameSet && b <= a) || !bounds[b].Overlaps(query)
+						|| edgeA[0] == edgeB[0] || edgeA[0] == edgeB[1] || edgeA[1] == edgeB[0] || edgeA[1] == edgeB[1]) {
+						continue;
+					}
+
+					Load(*block, positions, edgeA, edgeB);
+					block->EdgeA[block->Count] = static_cast<unsigned>(a);
+					block->EdgeB[block->Count] = b;
+					if (++block->Count == Block) {
+						flush();
+					}
+				}
+			}
+		}
+		flush();
+	}, EdgeGrain);
+
+	for (const auto& chunk : chunkResults) {
+		ResultsValue.insert(ResultsValue.end(), chunk.begin(), chunk.end());
+	}
+	std::sort(ResultsValue.begin(), ResultsValue.end(), [](const TEdgeApproach& a, const TEdgeApproach& b) {
+		return a.EdgeA != b.EdgeA ? a.EdgeA < b.EdgeA : a.EdgeB < b.EdgeB;
+	});
+}
+
+const std::vector<TEdgeApproach>& TEdgeApproachSolver::Results() const
+{
+	return ResultsValue;
+}
+
+std::vector<TEdgeSegment> TEdgeApproachSolver::Edges(TMesh& mesh, TMarkMode mode)
+{
+	std::vector<TEdgeSegment> edges;
+	mesh.EachEdge([&edges](TEdge& edge) {
+		TEdgeSegment segment;
+		unsigned n = 0;
+		for (auto point : edge.Points()) {
+			segment[n++] = point.Index();
+		}
+		edges.push_back(segment);
+	}, mode);
+	return edges;
+}
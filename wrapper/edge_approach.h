@@ -0,0 +1,43 @@
+#pragma once
+
+#include "mark.h"
+#include "vector.h"
+
+#include <array>
+#include <vector>
+
+class TMesh;
+
+using TEdgeSegment = std::array<unsigned, 2>;
+
+struct TEdgeApproach
+{
+	unsigned EdgeA;
+	unsigned EdgeB;
+	TVectorF PointA;
+	TVectorF PointB;
+	// 0 at the first endpoint, 1 at the second
+	float ParamA;
+	float ParamB;
+	float Distance;
+};
+
+// Closest approach between two sets of edges given as point index pairs.
+// A BVH over the second set prunes pairs farther apart than maxDistance,
+// survivors are solved in blocks by a branch-free segment/segment kernel.
+// Pairs sharing an endpoint are skipped. When both sets are the same
+// vector each unordered pair is reported once.
+class TEdgeApproachSolver
+{
+public:
+	TEdgeApproachSolver(const std::vector<TVectorF>& positions, const std::vector<TEdgeSegment>& edgesA, const std::vector<TEdgeSegment>& edgesB, float maxDistance);
+
+	// sorted by EdgeA, then EdgeB
+	const std::vector<TEdgeApproach>& Results() const;
+
+	// point indices of the edges matching mode, indexed like the host points
+	static std::vector<TEdgeSegment> Edges(TMesh& mesh, TMarkMode mode = TMarkMode{});
+
+private:
+	std::vector<TEdgeApproach> ResultsValue;
+};
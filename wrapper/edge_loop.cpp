@@ -0,0 +1,259 @@
+#include "edge_loop.h"
+
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+
+namespace {
+	// walking state: the edge reached and where the walk leaves it
+	struct TStep
+	{
+		unsigned Edge;
+		unsigned Exit;
+	};
+
+	// advance(step) moves to the next edge and returns false at a stop
+	template<typename F>
+	TEdgeChain Walk(unsigned edge, TStep forward, TStep backward, unsigned limit, F&& advance)
+	{
+		TEdgeChain chain;
+		chain.Edges.push_back(edge);
+
+		for (TStep step = forward; chain.Edges.size() <= limit && advance(step);) {
+			if (step.Edge == edge) {
+				chain.Closed = true;
+				return chain;
+			}
+			chain.Edges.push_back(step.Edge);
+		}
+
+		std::vector<unsigned> back;
+		for (TStep step = backward; back.size() + chain.Edges.size() <= limit && advance(step);) {
+			if (step.Edge == edge) {
+				break;
+			}
+			back.push_back(step.Edge);
+		}
+		chain.Edges.insert(chain.Edges.begin(), back.rbegin(), back.rend());
+		return chain;
+	}
+
+	// exit is a point for loops and a corner for rings, links are stored per edge end or per corner
+	template<typename FStart, typename FAdvance>
+	std::vector<TEdgeChain> Partition(unsigned edgeCount, FStart&& start, FAdvance&& advance)
+	{
+		std::vector<TEdgeChain> chains;
+		std::vector<uint8_t> visited(edgeCount, 0);
+		for (unsigned edge = 0; edge < edgeCount; ++edge) {
+			if (visited[edge]) {
+				continue;
+			}
+			const auto [forward, backward] = start(edge);
+			TEdgeChain chain = Walk(edge, forward, backward, edgeCount, advance);
+			for (const unsigned member : chain.Edges) {
+				visited[member] = 1;
+			}
+			chains.push_back(std::move(chain));
+		}
+		return chains;
+	}
+} // anonymous namespace
+
+TEdgeTraversal::TEdgeTraversal(const TTopology& topology)
+	: Topology(topology)
+{
+}
+
+bool TEdgeTraversal::IsQuad(unsigned polygon) const
+{
+	return Topology.Snapshot.VertexCount(polygon) == 4;
+}
+
+unsigned TEdgeTraversal::LoopNext(unsigned edge, unsigned point) const
+{
+	const unsigned valence = Topology.Valence(point);
+	const unsigned cornerBegin = Topology.PointCornerStart[point];
+	const unsigned cornerEnd = Topology.PointCornerStart[point + 1];
+	for (unsigned slot = cornerBegin; slot < cornerEnd; ++slot) {
+		if (!IsQuad(Topology.CornerPolygon[Topology.PointCorners[slot]])) {
+			return TTopology::Invalid;
+		}
+	}
+
+	const unsigned* edges = Topology.PointEdges.data() + Topology.PointEdgeStart[point];
+	auto sharesPolygon = [this](unsigned a, unsigned b) {
+		for (unsigned i = Topology.EdgeCornerStart[a]; i < Topology.EdgeCornerStart[a + 1]; ++i) {
+			for (unsigned j = Topology.EdgeCornerStart[b]; j < Topology.EdgeCornerStart[b + 1]; ++j) {
+				if (Topology.CornerPolygon[Topology.EdgeCorners[i]] == Topology.CornerPolygon[Topology.EdgeCorners[j]]) {
+					return true;
+				}
+			}
+		}
+		return false;
+	};
+
+	if (Topology.IsBoundary(edge)) {
+		if (valence != 3 || cornerEnd - cornerBegin != 2) {
+			return TTopology::Invalid;
+		}
+		unsigned next = TTopology::Invalid;
+		for (unsigned i = 0; i < valence; ++i) {
+			if (edges[i] != edge && Topology.IsBoundary(edges[i])) {
+				next = edges[i];
+			}
+		}
+		return next;
+	}
+
+	if (valence != 4 || cornerEnd - cornerBegin != 4) {
+		return TTopology::Invalid;
+	}
+	unsigned next = TTopology::Invalid;
+	for (unsigned i = 0; i < valence; ++i) {
+		if (Topology.EdgePolygonCount(edges[i]) != 2) {
+			return TTopology::Invalid;
+		}
+		if (edges[i] != edge && !sharesPolygon(edge, edges[i])) {
+			if (next != TTopology::Invalid) {
+				return TTopology::Invalid;
+			}
+			next = edges[i];
+		}
+	}
+	return next;
+}
+
+unsigned TEdgeTraversal::RingNext(unsigned corner) const
+{
+	if (!IsQuad(Topology.CornerPolygon[corner])) {
+		return TTopology::Invalid;
+	}
+
+	const unsigned opposite = Topology.NextCorner(Topology.NextCorner(corner));
+	const unsigned edge = Topology.CornerEdge[opposite];
+	if (edge == TTopology::Invalid || Topology.EdgePolygonCount(edge) > 2) {
+		return TTopology::Invalid;
+	}
+	if (Topology.IsBoundary(edge)) {
+		// reached, but nothing to cross
+		return opposite;
+	}
+
+	const unsigned first = Topology.EdgeCorners[Topology.EdgeCornerStart[edge]];
+	const unsigned second = Topology.EdgeCorners[Topology.EdgeCornerStart[edge] + 1];
+	return first == opposite ? second : first;
+}
+
+TEdgeChain TEdgeTraversal::Loop(unsigned edge) const
+{
+	const auto& ends = Topology.Edges[edge];
+	return Walk(edge, {edge, ends[1]}, {edge, ends[0]}, Topology.EdgeCount(), [this](TStep& step) {
+		const unsigned next = LoopNext(step.Edge, step.Exit);
+		if (next == TTopology::Invalid) {
+			return false;
+		}
+		step = {next, Topology.OtherPoint(next, step.Exit)};
+		return true;
+	});
+}
+
+TEdgeChain TEdgeTraversal::Ring(unsigned edge) const
+{
+	const unsigned begin = Topology.EdgeCornerStart[edge];
+	const unsigned count = Topology.EdgePolygonCount(edge);
+	if (count > 2) {
+		return TEdgeChain{{edge}, false};
+	}
+
+	const unsigned first = Topology.EdgeCorners[begin];
+	const unsigned second = count == 2 ? Topology.EdgeCorners[begin + 1] : TTopology::Invalid;
+	return Walk(edge, {edge, first}, {edge, second}, Topology.EdgeCount(), [this](TStep& step) {
+		if (step.Exit == TTopology::Invalid) {
+			return false;
+		}
+		const unsigned next = RingNext(step.Exit);
+		if (next == TTopology::Invalid) {
+			return false;
+		}
+		const unsigned nextEdge = Topology.CornerEdge[next];
+		// a boundary edge ends the ring after being added
+		step = {nextEdge, Topology.IsBoundary(nextEdge) ? TTopology::Invalid : next};
+		return true;
+	});
+}
+
+std::vector<TEdgeChain> TEdgeTraversal::AllLoops() const
+{
+	// links resolved in parallel, chaining is a linear pass over them
+	const unsigned edgeCount = Topology.EdgeCount();
+	std::vector<unsigned> links(size_t(edgeCount) * 2);
+	NParallel::For(edgeCount, [&](size_t edge) {
+		for (unsigned end = 0; end < 2; ++end) {
+			links[edge * 2 + end] = LoopNext(static_cast<unsigned>(edge), Topology.Edges[edge][end]);
+		}
+	});
+
+	return Partition(edgeCount, [this](unsigned edge) {
+		const auto& ends = Topology.Edges[edge];
+		return std::pair<TStep, TStep>{{edge, ends[1]}, {edge, ends[0]}};
+	}, [&](TStep& step) {
+		const unsigned next = links[step.Edge * 2 + (Topology.Edges[step.Edge][1] == step.Exit ? 1 : 0)];
+		if (next == TTopology::Invalid) {
+			return false;
+		}
+		step = {next, Topology.OtherPoint(next, step.Exit)};
+		return true;
+	});
+}
+
+std::vector<TEdgeChain> TEdgeTraversal::AllRings() const
+{
+	const unsigned cornerCount = Topology.CornerCount();
+	std::vector<unsigned> links(cornerCount);
+	NParallel::For(cornerCount, [&](size_t corner) {
+		links[corner] = Topology.CornerEdge[corner] == TTopology::Invalid ? TTopology::Invalid : RingNext(static_cast<unsigned>(corner));
+	});
+
+	return Partition(Topology.EdgeCount(), [this](unsigned edge) {
+		const unsigned begin = Topology.EdgeCornerStart[edge];
+		const unsigned count = Topology.EdgePolygonCount(edge);
+		const unsigned first = count <= 2 ? Topology.EdgeCorners[begin] : TTopology::Invalid;
+		const unsigned second = count == 2 ? Topology.EdgeCorners[begin + 1] : TTopology::Invalid;
+		return std::pair<TStep, TStep>{{edge, first}, {edge, second}};
+	}, [&](TStep& step) {
+		const unsigned next = step.Exit == TTopology::Invalid ? TTopology::Invalid : links[step.Exit];
+		if (next == TTopology::Invalid) {
+			return false;
+		}
+		const unsigned nextEdge = Topology.CornerEdge[next];
+		step = {nextEdge, Topology.IsBoundary(nextEdge) ? TTopology::Invalid : next};
+		return true;
+	});
+}
+
+std::vector<unsigned> TEdgeTraversal::LoopPoints(const TEdgeChain& loop) const
+{
+	std::vector<unsigned> points;
+	if (loop.Edges.empty()) {
+		return points;
+	}
+
+	const auto& first = Topology.Edges[loop.Edges.front()];
+	unsigned point = first[0];
+	if (loop.Edges.size() > 1) {
+		const auto& second = Topology.Edges[loop.Edges[1]];
+		// start at the end not shared with the next edge
+		point = first[0] == second[0] || first[0] == second[1] ? first[1] : first[0];
+	}
+
+	points.push_back(point);
+	for (const unsigned edge : loop.Edges) {
+		point = Topology.OtherPoint(edge, point);
+		points.push_back(point);
+	}
+	if (loop.Closed) {
+		points.pop_back();
+	}
+	return points;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "topology.h"
+
+#include <vector>
+
+// Edges in walking order. Closed chains do not repeat their first edge.
+struct TEdgeChain
+{
+	std::vector<unsigned> Edges;
+	bool Closed = false;
+};
+
+// Edge loops and rings over precomputed topology.
+// A loop passes a point only when the point joins four quads over four
+// manifold edges, taking the edge that shares no polygon with the incoming
+// one; a boundary loop continues along the border through points joining
+// two quads. A ring crosses quads to the opposite edge and ends on boundary
+// edges. Anything else - poles, n-gons, triangles, non-manifold edges - ends
+// the chain.
+class TEdgeTraversal
+{
+public:
+	explicit TEdgeTraversal(const TTopology& topology);
+
+	TEdgeChain Loop(unsigned edge) const;
+	TEdgeChain Ring(unsigned edge) const;
+
+	// every edge in exactly one chain, ordered by the lowest edge of each chain
+	std::vector<TEdgeChain> AllLoops() const;
+	std::vector<TEdgeChain> AllRings() const;
+
+	// points passed by a loop, one more than edges for open loops
+	std::vector<unsigned> LoopPoints(const TEdgeChain& loop) const;
+
+private:
+	// edge continuing a loop that leaves edge through point, Invalid at a stop
+	unsigned LoopNext(unsigned edge, unsigned point) const;
+	// corner continuing a ring that leaves its edge through the polygon of corner
+	unsigned RingNext(unsigned corner) const;
+	bool IsQuad(unsigned polygon) const;
+
+private:
+	const TTopology& Topology;
+};
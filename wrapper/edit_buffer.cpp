@@ -0,0 +1,215 @@
+#include "edit_buffer.h"
+
+#include "mesh.h"
+#include "point.h"
+#include "polygon.h"
+
+#include <unordered_set>
+
+TEditBuffer::TPointRef::TPointRef(LXtPointID id)
+	: Id(id)
+{
+}
+
+TEditBuffer::TPointRef::TPointRef(const TPoint& point)
+	: Id(point.ID())
+{
+}
+
+TEditBuffer::TPointRef::TPointRef(unsigned pending)
+	: Pending(pending)
+{
+}
+
+TEditBuffer::TEditBuffer(TMesh& mesh)
+	: Mesh(mesh)
+{
+}
+
+TEditBuffer::TPointRef TEditBuffer::CreatePoint(const TVectorF& pos)
+{
+	NewPoints.push_back(pos);
+	return TPointRef(static_cast<unsigned>(NewPoints.size() - 1));
+}
+
+void TEditBuffer::CreatePolygon(const std::vector<TPointRef>& points, bool flip)
+{
+	NewPolygons.push_back({static_cast<unsigned>(NewPolygonPoints.size()), static_cast<unsigned>(points.size()), flip});
+	NewPolygonPoints.insert(NewPolygonPoints.end(), points.begin(), points.end());
+}
+
+void TEditBuffer::Move(const TPointRef& point, const TVectorF& pos)
+{
+	if (!point.Id) {
+		NewPoints[point.Pending] = pos;
+		return;
+	}
+
+	const auto [it, inserted] = MovedIndex.emplace(point.Id, static_cast<unsigned>(Moved.size()));
+	if (inserted) {
+		Moved.push_back(point.Id);
+		MovedPositions.push_back(pos);
+	}
+	else {
+		MovedPositions[it->second] = pos;
+	}
+}
+
+void TEditBuffer::Delete(const TPoint& point)
+{
+	DeletePoint(point.ID());
+}
+
+void TEditBuffer::Delete(const TPolygon& polygon)
+{
+	DeletePolygon(polygon.ID());
+}
+
+void TEditBuffer::DeletePoint(LXtPointID id)
+{
+	DeletedPoints.push_back(id);
+}
+
+void TEditBuffer::DeletePolygon(LXtPolygonID id)
+{
+	DeletedPolygons.push_back(id);
+}
+
+void TEditBuffer::Mark(const TPoint& point, TMarkMode mode)
+{
+	MarkPoint(point.ID(), mode);
+}
+
+void TEditBuffer::Mark(const TPolygon& polygon, TMarkMode mode)
+{
+	MarkPolygon(polygon.ID(), mode);
+}
+
+void TEditBuffer::MarkPoint(LXtPointID id, TMarkMode mode)
+{
+	PointMarks.push_back({id, mode});
+}
+
+void TEditBuffer::MarkPolygon(LXtPolygonID id, TMarkMode mode)
+{
+	PolygonMarks.push_back({id, mode});
+}
+
+void TEditBuffer::MarkEdge(LXtPointID a, LXtPointID b, TMarkMode mode)
+{
+	EdgeMarks.push_back({a, b, mode});
+}
+
+bool TEditBuffer::Empty() const
+{
+	return Moved.empty() && NewPoints.empty() && NewPolygons.empty() && PointMarks.empty()
+		&& PolygonMarks.empty() && EdgeMarks.empty() && DeletedPoints.empty() && DeletedPolygons.empty();
+}
+
+void TEditBuffer::Discard()
+{
+	Moved.clear();
+	MovedPositions.clear();
+	MovedIndex.clear();
+	NewPoints.clear();
+	NewPolygons.clear();
+	NewPolygonPoints.clear();
+	PointMarks.clear();
+	PolygonMarks.clear();
+	EdgeMarks.clear();
+	DeletedPoints.clear();
+	DeletedPolygons.clear();
+}
+
+void TEditBuffer::Commit()
+{
+	if (Empty()) {
+		return;
+	}
+
+	// edits to elements deleted in the same batch are dropped
+	const std::unordered_set<LXtPointID> deletedPoints(DeletedPoints.begin(), DeletedPoints.end());
+	const std::unordered_set<LXtPolygonID> deletedPolygons(DeletedPolygons.begin(), DeletedPolygons.end());
+
+	Mesh.BeginEditBatch();
+
+	auto point = Mesh.InitPoint();
+	for (unsigned moved = 0; moved < Moved.size(); ++moved) {
+		if (deletedPoints.count(Moved[moved])) {
+			continue;
+		}
+		const TVectorD pos(MovedPositions[moved]);
+		point.Select(Moved[moved]);
+		point.SetPos(&pos.x);
+	}
+
+	std::vector<LXtPointID> created;
+	created.reserve(NewPoints.size());
+	for (const auto& pos : NewPoints) {
+		created.push_back(Mesh.CreatePoint(pos));
+	}
+
+	std::vector<LXtPointID> points;
+	for (const auto& polygon : NewPolygons) {
+		points.clear();
+		for (unsigned slot = polygon.First; slot < polygon.First + polygon.Count; ++slot) {
+			const TPointRef& ref = NewPolygonPoints[slot];
+			points.push_back(ref.Id ? ref.Id : created[ref.Pending]);
+		}
+		Mesh.CreatePolygon(points, polygon.Flip);
+	}
+
+	for (const auto& mark : PointMarks) {
+		if (!deletedPoints.count(mark.Id)) {
+			point.Select(mark.Id);
+			point.SetMarks(mark.Mode.Mode);
+		}
+	}
+
+	auto polygon = Mesh.InitPolygon();
+	for (const auto& mark : PolygonMarks) {
+		if (!deletedPolygons.count(mark.Id)) {
+			polygon.Select(mark.Id);
+			polygon.SetMarks(mark.Mode.Mode);
+		}
+	}
+
+	auto edge = Mesh.InitEdge();
+	for (const auto& mark : EdgeMarks) {
+		if (!deletedPoints.count(mark.A) && !deletedPoints.count(mark.B) && edge.SelectEndpoints(mark.A, mark.B) == LXe_OK) {
+			edge.SetMarks(mark.Mode.Mode);
+		}
+	}
+
+	// polygons before the points they use, in recorded order
+	std::unordered_set<LXtPolygonID> removedPolygons;
+	for (const LXtPolygonID id : DeletedPolygons) {
+		if (removedPolygons.insert(id).second) {
+			polygon.Select(id);
+			polygon.Remove();
+		}
+	}
+	std::unordered_set<LXtPointID> removedPoints;
+	for (const LXtPointID id : DeletedPoints) {
+		if (removedPoints.insert(id).second) {
+			point.Select(id);
+			point.Remove();
+		}
+	}
+
+	Mesh.EndEditBatch();
+
+	// new points and polygons are recorded by the mesh itself
+	unsigned change = 0;
+	change |= Moved.empty() ? 0 : LXf_MESHEDIT_POSITION;
+	change |= DeletedPolygons.empty() ? 0 : LXf_MESHEDIT_POLYGONS;
+	// removed points also leave the polygons using them
+	change |= DeletedPoints.empty() ? 0 : LXf_MESHEDIT_GEOMETRY;
+	change |= PointMarks.empty() && PolygonMarks.empty() && EdgeMarks.empty() ? 0 : LXf_MESHEDIT_UPDATE;
+	Mesh.AddChange(change);
+
+	Mesh.SetChange();
+	Mesh.Update();
+
+	Discard();
+}
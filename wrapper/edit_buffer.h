@@ -0,0 +1,103 @@
+#pragma once
+
+#include <lx_mesh.hpp>
+
+#include "mark.h"
+#include "vector.h"
+
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+class TMesh;
+class TPoint;
+class TPolygon;
+
+// Edits recorded against the host mesh and applied together.
+// Nothing reaches the host before Commit(), which runs inside one edit
+// batch: moves first, then new points and polygons, then marks, and
+// deletions last, so no host call sees topology changed by an earlier one.
+// Commit() ends with a single SetChange() and Update(), sending only the
+// LXf_MESHEDIT_* flags of the kinds of edit recorded.
+class TEditBuffer
+{
+public:
+	// existing host point or a point created by this buffer
+	class TPointRef
+	{
+	public:
+		TPointRef(LXtPointID id);
+		TPointRef(const TPoint& point);
+
+	private:
+		friend class TEditBuffer;
+		TPointRef(unsigned pending);
+
+		LXtPointID Id = nullptr;
+		unsigned Pending = std::numeric_limits<unsigned>::max();
+	};
+
+	explicit TEditBuffer(TMesh& mesh);
+	TEditBuffer(const TEditBuffer& rhs) = delete;
+	TEditBuffer& operator=(const TEditBuffer& rhs) = delete;
+
+	TPointRef CreatePoint(const TVectorF& pos);
+	void CreatePolygon(const std::vector<TPointRef>& points, bool flip = false);
+	// the last move of a point wins
+	void Move(const TPointRef& point, const TVectorF& pos);
+
+	void Delete(const TPoint& point);
+	void Delete(const TPolygon& polygon);
+	void DeletePoint(LXtPointID id);
+	void DeletePolygon(LXtPolygonID id);
+
+	void Mark(const TPoint& point, TMarkMode mode);
+	void Mark(const TPolygon& polygon, TMarkMode mode);
+	void MarkPoint(LXtPointID id, TMarkMode mode);
+	void MarkPolygon(LXtPolygonID id, TMarkMode mode);
+	void MarkEdge(LXtPointID a, LXtPointID b, TMarkMode mode);
+
+	bool Empty() const;
+	void Discard();
+	void Commit();
+
+private:
+	struct TNewPolygon
+	{
+		unsigned First;
+		unsigned Count;
+		bool Flip;
+	};
+
+	template<typename TId>
+	struct TMarkRecord
+	{
+		TId Id;
+		TMarkMode Mode;
+	};
+
+	struct TEdgeMarkRecord
+	{
+		LXtPointID A;
+		LXtPointID B;
+		TMarkMode Mode;
+	};
+
+private:
+	TMesh& Mesh;
+
+	std::vector<LXtPointID> Moved;
+	std::vector<TVectorF> MovedPositions;
+	std::unordered_map<LXtPointID, unsigned> MovedIndex;
+
+	std::vector<TVectorF> NewPoints;
+	std::vector<TNewPolygon> NewPolygons;
+	std::vector<TPointRef> NewPolygonPoints;
+
+	std::vector<TMarkRecord<LXtPointID>> PointMarks;
+	std::vector<TMarkRecord<LXtPolygonID>> PolygonMarks;
+	std::vector<TEdgeMarkRecord> EdgeMarks;
+
+	std::vector<LXtPointID> DeletedPoints;
+	std::vector<LXtPolygonID> DeletedPolygons;
+};
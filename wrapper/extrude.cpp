@@ -0,0 +1,280 @@
+#include "extrude.h"
+
+#include "mesh.h"
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+
+namespace {
+	// walls of flat mitres would shoot off to infinity
+	constexpr float MinMiterCosine = 0.1f;
+} // anonymous namespace
+
+TExtrude::TExtrude(const TTopology& topology, const TBitSet& polygons, float distance, float inset, EMode mode)
+	: Topology(topology)
+	, Selected(polygons)
+	, Normals(topology.PolygonCount(), TVectorF(0.0f))
+	, CornerPoint(topology.CornerCount(), TTopology::Invalid)
+{
+	const auto& snapshot = Topology.Snapshot;
+	NParallel::For(snapshot.PolygonCount(), [&](size_t polygon) {
+		if (!Selected.Test(static_cast<unsigned>(polygon))) {
+			return;
+		}
+		TVectorF normal(0.0f);
+		for (unsigned corner = snapshot.PolygonStart[polygon]; corner < snapshot.PolygonStart[polygon + 1]; ++corner) {
+			normal += glm::cross(snapshot.Positions[snapshot.PolygonVertices[corner]], snapshot.Positions[snapshot.PolygonVertices[Topology.NextCorner(corner)]]);
+		}
+		const float length = glm::length(normal);
+		Normals[polygon] = length > 0.0f ? normal / length : normal;
+	}, 1024);
+
+	if (mode == EMode::Region) {
+		Region(distance, inset);
+	}
+	else {
+		Faces(distance, inset);
+	}
+	Rewrite();
+	Walls(mode);
+}
+
+unsigned TExtrude::NewPointCount() const
+{
+	return static_cast<unsigned>(NewPositions.size());
+}
+
+bool TExtrude::IsBorder(unsigned edge) const
+{
+	const unsigned begin = Topology.EdgeCornerStart[edge];
+	const unsigned end = Topology.EdgeCornerStart[edge + 1];
+	unsigned selected = 0;
+	for (unsigned slot = begin; slot < end; ++slot) {
+		selected += Selected.Test(Topology.CornerPolygon[Topology.EdgeCorners[slot]]) ? 1 : 0;
+	}
+	return selected && (selected < end - begin || end - begin == 1);
+}
+
+TVectorF TExtrude::Inward(unsigned corner) const
+{
+	const auto& snapshot = Topology.Snapshot;
+	const TVectorF side = snapshot.Positions[snapshot.PolygonVertices[Topology.NextCorner(corner)]] - snapshot.Positions[snapshot.PolygonVertices[corner]];
+	const TVectorF inward = glm::cross(Normals[Topology.CornerPolygon[corner]], side);
+	const float length = glm::length(inward);
+	return length > 0.0f ? inward / length : inward;
+}
+
+TVectorF TExtrude::Miter(const std::vector<TVectorF>& directions, float length)
+{
+	TVectorF sum(0.0f);
+	for (const auto& direction : directions) {
+		sum += direction;
+	}
+	const float sumLength = glm::length(sum);
+	if (sumLength <= 0.0f || length == 0.0f) {
+		return TVectorF(0.0f);
+	}
+
+	const TVectorF miter = sum / sumLength;
+	float cosine = 1.0f;
+	for (const auto& direction : directions) {
+		cosine = std::min(cosine, glm::dot(miter, direction));
+	}
+	return miter * (length / std::max(cosine, MinMiterCosine));
+}
+
+void TExtrude::Region(float distance, float inset)
+{
+	const auto& snapshot = Topology.Snapshot;
+	const auto& vertices = snapshot.PolygonVertices;
+	const unsigned pointCount = Topology.PointCount();
+
+	// 0 outside the selection, 1 moved in place, 2 copied
+	std::vector<uint8_t> kind(pointCount, 0);
+	std::vector<TVectorF> positions(pointCount);
+	NParallel::ForChunks(pointCount, [&](unsigned, size_t begin, size_t end) {
+		std::vector<TVectorF> normals;
+		std::vector<TVectorF> inwards;
+		for (size_t point = begin; point < end; ++point) {
+			normals.clear();
+			inwards.clear();
+			bool outside = false;
+			for (unsigned slot = Topology.PointCornerStart[point]; slot < Topology.PointCornerStart[point + 1]; ++slot) {
+				const unsigned corner = Topology.PointCorners[slot];
+				const unsigned polygon = Topology.CornerPolygon[corner];
+				if (!Selected.Test(polygon)) {
+					outside = true;
+					continue;
+				}
+				normals.push_back(Normals[polygon]);
+				for (const unsigned side : {corner, Topology.PrevCorner(corner)}) {
+					const unsigned edge = Topology.CornerEdge[side];
+					if (edge != TTopology::Invalid && IsBorder(edge)) {
+						inwards.push_back(Inward(side));
+					}
+				}
+			}
+			if (normals.empty()) {
+				continue;
+			}
+			kind[point] = outside || !inwards.empty() ? 2 : 1;
+			positions[point] = snapshot.Positions[point] + Miter(normals, distance) + Miter(inwards, inset);
+		}
+	});
+
+	std::vector<unsigned> newIndex(pointCount + 1, 0);
+	for (unsigned point = 0; point < pointCount; ++point) {
+		newIndex[point] = kind[point] == 2 ? 1 : 0;
+	}
+	NewPositions.resize(NParallel::ExclusiveScan(newIndex));
+	for (unsigned point = 0; point < pointCount; ++point) {
+		if (kind[point] == 2) {
+			NewPositions[newIndex[point]] = positions[point];
+		}
+		else if (kind[point] == 1 && positions[point] != snapshot.Positions[point]) {
+			Moved.push_back(point);
+			MovedPositions.push_back(positions[point]);
+		}
+	}
+
+	NParallel::For(Topology.CornerCount(), [&](size_t corner) {
+		const unsigned point = vertices[corner];
+		if (Selected.Test(Topology.CornerPolygon[corner])) {
+			CornerPoint[corner] = kind[point] == 2 ? pointCount + newIndex[point] : point;
+		}
+	});
+}
+
+void TExtrude::Faces(float distance, float inset)
+{
+	const auto& snapshot = Topology.Snapshot;
+	const unsigned polygonCount = snapshot.PolygonCount();
+	const unsigned pointCount = Topology.PointCount();
+
+	std::vector<unsigned> first(polygonCount + 1, 0);
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		first[polygon] = Selected.Test(static_cast<unsigned>(polygon)) ? snapshot.VertexCount(static_cast<unsigned>(polygon)) : 0;
+	});
+	NewPositions.resize(NParallel::ExclusiveScan(first));
+
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		if (!Selected.Test(static_cast<unsigned>(polygon))) {
+			return;
+		}
+		const unsigned begin = snapshot.PolygonStart[polygon];
+		for (unsigned corner = begin; corner < snapshot.PolygonStart[polygon + 1]; ++corner) {
+			const unsigned index = first[polygon] + corner - begin;
+			const std::vector<TVectorF> inwards = {Inward(corner), Inward(Topology.PrevCorner(corner))};
+			NewPositions[index] = snapshot.Positions[snapshot.PolygonVertices[corner]] + distance * Normals[polygon] + Miter(inwards, inset);
+			CornerPoint[corner] = pointCount + index;
+		}
+	}, 1024);
+}
+
+void TExtrude::Rewrite()
+{
+	const auto& snapshot = Topology.Snapshot;
+	RewrittenStart.assign(1, 0);
+	Selected.ForEach([&](unsigned polygon) {
+		const unsigned begin = snapshot.PolygonStart[polygon];
+		const unsigned end = snapshot.PolygonStart[polygon + 1];
+		bool changed = false;
+		for (unsigned corner = begin; corner < end; ++corner) {
+			changed |= CornerPoint[corner] != snapshot.PolygonVertices[corner];
+		}
+		if (!changed) {
+			return;
+		}
+		Rewritten.push_back(polygon);
+		RewrittenVertices.insert(RewrittenVertices.end(), CornerPoint.begin() + begin, CornerPoint.begin() + end);
+		RewrittenStart.push_back(static_cast<unsigned>(RewrittenVertices.size()));
+	});
+}
+
+void TExtrude::Walls(EMode mode)
+{
+	const auto& snapshot = Topology.Snapshot;
+	const auto& vertices = snapshot.PolygonVertices;
+	const unsigned polygonCount = snapshot.PolygonCount();
+
+	// quad from the original side up to its copy, chunk results joined in polygon order
+	const unsigned chunks = NParallel::ChunkCount(polygonCount, 1024);
+	std::vector<std::vector<unsigned>> chunkVertices(chunks);
+	std::vector<std::vector<unsigned>> chunkSources(chunks);
+	NParallel::ForChunks(polygonCount, [&](unsigned chunk, size_t begin, size_t end) {
+		for (size_t polygon = begin; polygon < end; ++polygon) {
+			if (!Selected.Test(static_cast<unsigned>(polygon))) {
+				continue;
+			}
+			for (unsigned corner = snapshot.PolygonStart[polygon]; corner < snapshot.PolygonStart[polygon + 1]; ++corner) {
+				const unsigned edge = Topology.CornerEdge[corner];
+				const unsigned next = Topology.NextCorner(corner);
+				if (edge == TTopology::Invalid || CornerPoint[corner] == vertices[corner] || CornerPoint[next] == vertices[next] || (mode == EMode::Region && !IsBorder(edge))) {
+					continue;
+				}
+				chunkVertices[chunk].insert(chunkVertices[chunk].end(), {vertices[corner], vertices[next], CornerPoint[next], CornerPoint[corner]});
+				chunkSources[chunk].push_back(static_cast<unsigned>(polygon));
+			}
+		}
+	}, 1024);
+
+	CreatedStart.assign(1, 0);
+	for (unsigned chunk = 0; chunk < chunks; ++chunk) {
+		for (size_t i = 0; i < chunkVertices[chunk].size(); i += 4) {
+			CreatedStart.push_back(CreatedStart.back() + 4);
+		}
+		CreatedVertices.insert(CreatedVertices.end(), chunkVertices[chunk].begin(), chunkVertices[chunk].end());
+		CreatedSource.insert(CreatedSource.end(), chunkSources[chunk].begin(), chunkSources[chunk].end());
+	}
+}
+
+void TExtrude::Apply(TMesh& mesh) const
+{
+	if (Rewritten.empty() && Moved.empty()) {
+		return;
+	}
+
+	const TMeshSnapshot& snapshot = Topology.Snapshot;
+	mesh.BeginEditBatch();
+
+	std::vector<LXtPointID> ids(snapshot.PointIds);
+	for (const auto& pos : NewPositions) {
+		ids.push_back(mesh.CreatePoint(pos));
+	}
+
+	auto point = mesh.InitPoint();
+	for (unsigned moved = 0; moved < Moved.size(); ++moved) {
+		const TVectorD pos(MovedPositions[moved]);
+		point.Select(snapshot.PointIds[Moved[moved]]);
+		point.SetPos(&pos.x);
+	}
+	if (!Moved.empty()) {
+		mesh.AddChange(LXf_MESHEDIT_POSITION);
+	}
+
+	auto polygon = mesh.InitPolygon();
+	std::vector<LXtPointID> points;
+	auto gather = [&](const std::vector<unsigned>& start, const std::vector<unsigned>& vertices, unsigned index) {
+		points.clear();
+		for (unsigned slot = start[index]; slot < start[index + 1]; ++slot) {
+			points.push_back(ids[vertices[slot]]);
+		}
+	};
+
+	for (unsigned rewritten = 0; rewritten < Rewritten.size(); ++rewritten) {
+		gather(RewrittenStart, RewrittenVertices, rewritten);
+		polygon.Select(snapshot.PolygonIds[Rewritten[rewritten]]);
+		polygon.SetVertexList(points.data(), static_cast<unsigned>(points.size()), 0);
+	}
+	if (!Rewritten.empty()) {
+		mesh.AddChange(LXf_MESHEDIT_POLYGONS);
+	}
+
+	for (unsigned created = 0; created + 1 < CreatedStart.size(); ++created) {
+		gather(CreatedStart, CreatedVertices, created);
+		mesh.CreatePolygon(snapshot.PolygonIds[CreatedSource[created]], points);
+	}
+
+	mesh.EndEditBatch();
+}
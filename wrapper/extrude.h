@@ -0,0 +1,71 @@
+#pragma once
+
+#include "bitset.h"
+#include "topology.h"
+#include "vector.h"
+
+#include <vector>
+
+class TMesh;
+
+// Polygon extrude and inset computed over the topology tables, then written
+// in one edit batch. In region mode connected selected polygons move as one
+// shell: points inside a region only move, points on its border are copied
+// and the border edges get side walls. In face mode every polygon gets its
+// own copies of its points and walls on all its edges. Inset moves border
+// points inward along the mitred border, distance along the point normal,
+// both in one pass.
+//
+// Points are numbered like the snapshot, new points follow the old ones.
+class TExtrude
+{
+public:
+	enum class EMode
+	{
+		Region,
+		Faces,
+	};
+
+	// polygons is indexed like the snapshot
+	TExtrude(const TTopology& topology, const TBitSet& polygons, float distance, float inset = 0.0f, EMode mode = EMode::Region);
+
+	unsigned NewPointCount() const;
+
+	// creates the new points, moves region interiors, rewrites the selection and creates the walls
+	void Apply(TMesh& mesh) const;
+
+public:
+	std::vector<TVectorF> NewPositions;
+
+	// region interior points, moved in place
+	std::vector<unsigned> Moved;
+	std::vector<TVectorF> MovedPositions;
+
+	std::vector<unsigned> Rewritten;
+	std::vector<unsigned> RewrittenStart;
+	std::vector<unsigned> RewrittenVertices;
+
+	std::vector<unsigned> CreatedStart;
+	std::vector<unsigned> CreatedVertices;
+	// selected polygon each wall rises from, lending it type and tags
+	std::vector<unsigned> CreatedSource;
+
+private:
+	bool IsBorder(unsigned edge) const;
+	// inward unit vector of the side starting at corner, in its polygon plane
+	TVectorF Inward(unsigned corner) const;
+	// sum of unit vectors scaled so the projection on each of them is length
+	static TVectorF Miter(const std::vector<TVectorF>& directions, float length);
+
+	void Region(float distance, float inset);
+	void Faces(float distance, float inset);
+	void Rewrite();
+	void Walls(EMode mode);
+
+private:
+	const TTopology& Topology;
+	const TBitSet Selected;
+	std::vector<TVectorF> Normals;
+	// point taking the place of each selected corner
+	std::vector<unsigned> CornerPoint;
+};
@@ -0,0 +1,220 @@
+#include "falloff.h"
+
+#include "parallel.h"
+#include "spatial_hash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+	void Combine(TFalloff::ECombine combine, const float* weights, float* result, unsigned count)
+	{
+		switch (combine) {
+		case TFalloff::ECombine::Replace:
+			std::copy(weights, weights + count, result);
+			break;
+		case TFalloff::ECombine::Multiply:
+			for (unsigned i = 0; i < count; ++i) {
+				result[i] *= weights[i];
+			}
+			break;
+		case TFalloff::ECombine::Max:
+			for (unsigned i = 0; i < count; ++i) {
+				result[i] = std::max(result[i], weights[i]);
+			}
+			break;
+		}
+	}
+
+	// calls lambda(first, count, x, y, z) for blocks of positions, in parallel
+	template<typename F>
+	void ForBlocks(const std::vector<TVectorF>& positions, unsigned blockSize, F&& lambda)
+	{
+		NParallel::ForChunks(positions.size(), [&](unsigned, size_t begin, size_t end) {
+			std::vector<float> x(blockSize);
+			std::vector<float> y(blockSize);
+			std::vector<float> z(blockSize);
+			for (size_t first = begin; first < end; first += blockSize) {
+				const unsigned count = static_cast<unsigned>(std::min<size_t>(blockSize, end - first));
+				for (unsigned i = 0; i < count; ++i) {
+					x[i] = positions[first + i].x;
+					y[i] = positions[first + i].y;
+					z[i] = positions[first + i].z;
+				}
+				lambda(first, count, x.data(), y.data(), z.data());
+			}
+		});
+	}
+} // anonymous namespace
+
+TFalloff::TFalloff(EKind kind, EShape shape)
+	: Kind(kind)
+	, Shape(shape)
+{
+}
+
+TFalloff TFalloff::Linear(const TVectorF& start, const TVectorF& end, EShape shape)
+{
+	TFalloff falloff(EKind::Linear, shape);
+	const TVectorF direction = end - start;
+	const float length2 = glm::dot(direction, direction);
+	falloff.Origin = start;
+	falloff.Axis = length2 > 0.0f ? direction / length2 : TVectorF(0.0f);
+	return falloff;
+}
+
+TFalloff TFalloff::Radial(const TVectorF& center, const TVectorF& size, EShape shape)
+{
+	TFalloff falloff(EKind::Radial, shape);
+	falloff.Origin = center;
+	// a flat axis only keeps its plane
+	const float huge = std::numeric_limits<float>::max();
+	falloff.Axis = TVectorF(size.x > 0.0f ? 1.0f / size.x : huge, size.y > 0.0f ? 1.0f / size.y : huge, size.z > 0.0f ? 1.0f / size.z : huge);
+	return falloff;
+}
+
+TFalloff TFalloff::Cylinder(const TVectorF& base, const TVectorF& axis, float radius, EShape shape)
+{
+	TFalloff falloff(EKind::Cylinder, shape);
+	const float length = glm::length(axis);
+	falloff.Origin = base;
+	falloff.Axis = length > 0.0f ? axis / length : TVectorF(0.0f, 1.0f, 0.0f);
+	falloff.InverseRange = radius > 0.0f ? 1.0f / radius : std::numeric_limits<float>::max();
+	return falloff;
+}
+
+TFalloff TFalloff::Distance(std::vector<float> distances, float range, EShape shape)
+{
+	TFalloff falloff(EKind::Distance, shape);
+	falloff.Distances = std::move(distances);
+	falloff.InverseRange = range > 0.0f ? 1.0f / range : std::numeric_limits<float>::max();
+	return falloff;
+}
+
+TFalloff TFalloff::Selection(const std::vector<TVectorF>& positions, const TBitSet& selected, float range, EShape shape)
+{
+	std::vector<TVectorF> seeds;
+	selected.ForEach([&](unsigned point) {
+		seeds.push_back(positions[point]);
+	});
+
+	std::vector<float> distances(positions.size(), std::numeric_limits<float>::infinity());
+	if (!seeds.empty()) {
+		// the search stops at range, points further away keep infinity
+		const TSpatialHash hash(seeds, TSpatialHash::SuggestCellSize(seeds));
+		NParallel::ForChunks(positions.size(), [&](unsigned, size_t begin, size_t end) {
+			std::vector<unsigned> nearest;
+			for (size_t point = begin; point < end; ++point) {
+				nearest.clear();
+				hash.Nearest(positions[point], 1, nearest, std::max(range, 0.0f));
+				if (!nearest.empty()) {
+					distances[point] = glm::length(positions[point] - seeds[nearest[0]]);
+				}
+			}
+		});
+	}
+	return Distance(std::move(distances), range, shape);
+}
+
+void TFalloff::Block(size_t first, unsigned count, const float* x, const float* y, const float* z, float* weights) const
+{
+	// normalized distance, 0 at the origin and 1 at the end of the range
+	float* t = weights;
+	switch (Kind) {
+	case EKind::Linear:
+		for (unsigned i = 0; i < count; ++i) {
+			t[i] = (x[i] - Origin.x) * Axis.x + (y[i] - Origin.y) * Axis.y + (z[i] - Origin.z) * Axis.z;
+		}
+		break;
+	case EKind::Radial:
+		for (unsigned i = 0; i < count; ++i) {
+			const float dx = (x[i] - Origin.x) * Axis.x;
+			const float dy = (y[i] - Origin.y) * Axis.y;
+			const float dz = (z[i] - Origin.z) * Axis.z;
+			t[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+		}
+		break;
+	case EKind::Cylinder:
+		for (unsigned i = 0; i < count; ++i) {
+			const float dx = x[i] - Origin.x;
+			const float dy = y[i] - Origin.y;
+			const float dz = z[i] - Origin.z;
+			const float along = dx * Axis.x + dy * Axis.y + dz * Axis.z;
+			t[i] = std::sqrt(std::max(dx * dx + dy * dy + dz * dz - along * along, 0.0f)) * InverseRange;
+		}
+		break;
+	case EKind::Distance:
+		for (unsigned i = 0; i < count; ++i) {
+			t[i] = Distances[first + i] * InverseRange;
+		}
+		break;
+	}
+
+	switch (Shape) {
+	case EShape::Linear:
+		for (unsigned i = 0; i < count; ++i) {
+			weights[i] = 1.0f - std::clamp(t[i], 0.0f, 1.0f);
+		}
+		break;
+	case EShape::Smooth:
+		for (unsigned i = 0; i < count; ++i) {
+			const float s = 1.0f - std::clamp(t[i], 0.0f, 1.0f);
+			weights[i] = s * s * (3.0f - 2.0f * s);
+		}
+		break;
+	case EShape::EaseIn:
+		for (unsigned i = 0; i < count; ++i) {
+			const float s = 1.0f - std::clamp(t[i], 0.0f, 1.0f);
+			weights[i] = s * s;
+		}
+		break;
+	case EShape::EaseOut:
+		for (unsigned i = 0; i < count; ++i) {
+			const float c = std::clamp(t[i], 0.0f, 1.0f);
+			weights[i] = 1.0f - c * c;
+		}
+		break;
+	}
+}
+
+void TFalloff::Evaluate(const std::vector<TVectorF>& positions, std::vector<float>& weights, ECombine combine) const
+{
+	weights.resize(positions.size(), 1.0f);
+	ForBlocks(positions, BlockSize, [&](size_t first, unsigned count, const float* x, const float* y, const float* z) {
+		float local[BlockSize];
+		Block(first, count, x, y, z, local);
+		Combine(combine, local, weights.data() + first, count);
+	});
+}
+
+void TFalloffStack::Add(TFalloff falloff, TFalloff::ECombine combine)
+{
+	Layers.emplace_back(std::move(falloff), combine);
+}
+
+bool TFalloffStack::Empty() const
+{
+	return Layers.empty();
+}
+
+std::vector<float> TFalloffStack::Evaluate(const std::vector<TVectorF>& positions) const
+{
+	std::vector<float> weights(positions.size(), 1.0f);
+	ForBlocks(positions, TFalloff::BlockSize, [&](size_t first, unsigned count, const float* x, const float* y, const float* z) {
+		float local[TFalloff::BlockSize];
+		for (size_t layer = 0; layer < Layers.size(); ++layer) {
+			Layers[layer].first.Block(first, count, x, y, z, local);
+			Combine(layer ? Layers[layer].second : TFalloff::ECombine::Replace, local, weights.data() + first, count);
+		}
+	});
+	return weights;
+}
+
+void TFalloffStack::Blend(const std::vector<TVectorF>& from, const std::vector<TVectorF>& to, const std::vector<float>& weights, std::vector<TVectorF>& result)
+{
+	result.resize(from.size());
+	NParallel::For(from.size(), [&](size_t point) {
+		result[point] = from[point] + weights[point] * (to[point] - from[point]);
+	});
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "bitset.h"
+#include "vector.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Per point weight in [0, 1], 1 at the falloff origin. Points are evaluated
+// in blocks copied to separate x, y and z arrays so the kernels are straight
+// loops the compiler can vectorize.
+class TFalloff
+{
+public:
+	enum class EShape
+	{
+		Linear,
+		Smooth,
+		EaseIn,
+		EaseOut,
+	};
+
+	enum class ECombine
+	{
+		Replace,
+		Multiply,
+		Max,
+	};
+
+	// 1 at start, 0 at end and beyond
+	static TFalloff Linear(const TVectorF& start, const TVectorF& end, EShape shape = EShape::Linear);
+	// 0 outside the ellipsoid of half axes size
+	static TFalloff Radial(const TVectorF& center, const TVectorF& size, EShape shape = EShape::Linear);
+	// 0 further than radius from the infinite axis line
+	static TFalloff Cylinder(const TVectorF& base, const TVectorF& axis, float radius, EShape shape = EShape::Linear);
+	// distances per point, e.g. geodesic distances from a seed set
+	static TFalloff Distance(std::vector<float> distances, float range, EShape shape = EShape::Linear);
+	// straight line distance to the nearest selected point
+	static TFalloff Selection(const std::vector<TVectorF>& positions, const TBitSet& selected, float range, EShape shape = EShape::Linear);
+
+	// weights has one entry per position
+	void Evaluate(const std::vector<TVectorF>& positions, std::vector<float>& weights, ECombine combine = ECombine::Replace) const;
+
+private:
+	friend class TFalloffStack;
+
+	static constexpr unsigned BlockSize = 64;
+
+	enum class EKind
+	{
+		Linear,
+		Radial,
+		Cylinder,
+		Distance,
+	};
+
+	TFalloff(EKind kind, EShape shape);
+
+	// weights of count points from first, whose coordinates are in x, y and z
+	void Block(size_t first, unsigned count, const float* x, const float* y, const float* z, float* weights) const;
+
+private:
+	EKind Kind;
+	EShape Shape;
+	TVectorF Origin{0.0f};
+	// direction scaled to the falloff length, or inverse size
+	TVectorF Axis{0.0f};
+	float InverseRange = 0.0f;
+	std::vector<float> Distances;
+};
+
+// Falloffs combined in order, the first one replaces. All layers are
+// evaluated block by block in one pass over the positions.
+class TFalloffStack
+{
+public:
+	void Add(TFalloff falloff, TFalloff::ECombine combine = TFalloff::ECombine::Multiply);
+	bool Empty() const;
+
+	std::vector<float> Evaluate(const std::vector<TVectorF>& positions) const;
+
+	// result = from + weight * (to - from), ready for TMeshSnapshot::SetPositions
+	static void Blend(const std::vector<TVectorF>& from, const std::vector<TVectorF>& to, const std::vector<float>& weights, std::vector<TVectorF>& result);
+
+private:
+	std::vector<std::pair<TFalloff, TFalloff::ECombine>> Layers;
+};
@@ -3,6 +3,8 @@
 #include "edge.h"
 #include "point.h"
 
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <cassert>
 #include <vector>
@@ -31,6 +33,87 @@ namespace {
 			return acosf(fac);
 		}
 	}
+
+	using TTriangleD = std::array<TVectorD, 3>;
+
+	// points of t lying on the plane (no, d), at most two unless t is coplanar
+	int SplitByPlane(const TTriangleD& t, const std::array<double, 3>& dist, std::array<TVectorD, 3>& points)
+	{
+		int count = 0;
+		for (int i = 0; i < 3; ++i) {
+			const int j = (i + 1) % 3;
+			if (dist[i] == 0.0) {
+				points[count++] = t[i];
+			}
+			if ((dist[i] < 0.0 && dist[j] > 0.0) || (dist[i] > 0.0 && dist[j] < 0.0)) {
+				points[count++] = t[i] + (t[j] - t[i]) * (dist[i] / (dist[i] - dist[j]));
+			}
+		}
+		return count;
+	}
+
+	std::array<double, 3> PlaneDistances(const TTriangleD& t, const TVectorD& normal, const TVectorD& origin, double epsilon)
+	{
+		std::array<double, 3> dist;
+		for (int i = 0; i < 3; ++i) {
+			dist[i] = dot(normal, t[i] - origin);
+			if (std::abs(dist[i]) < epsilon) {
+				dist[i] = 0.0;
+			}
+		}
+		return dist;
+	}
+
+	bool SameSide(const std::array<double, 3>& dist)
+	{
+		return (dist[0] > 0.0 && dist[1] > 0.0 && dist[2] > 0.0) || (dist[0] < 0.0 && dist[1] < 0.0 && dist[2] < 0.0);
+	}
+
+	double Orient2D(const TVectorD& a, const TVectorD& b, const TVectorD& c, int u, int v)
+	{
+		return (b[u] - a[u]) * (c[v] - a[v]) - (b[v] - a[v]) * (c[u] - a[u]);
+	}
+
+	bool InTriangle2D(const TVectorD& p, const TTriangleD& t, int u, int v)
+	{
+		const double d0 = Orient2D(t[0], t[1], p, u, v);
+		const double d1 = Orient2D(t[1], t[2], p, u, v);
+		const double d2 = Orient2D(t[2], t[0], p, u, v);
+		return (d0 >= 0.0 && d1 >= 0.0 && d2 >= 0.0) || (d0 <= 0.0 && d1 <= 0.0 && d2 <= 0.0);
+	}
+
+	std::optional<TVectorD> CoplanarOverlap(const TTriangleD& a, const TTriangleD& b, const TVectorD& normal)
+	{
+		// drop the dominant axis of the normal
+		const TVectorD n = glm::abs(normal);
+		const int drop = n.x > n.y ? (n.x > n.z ? 0 : 2) : (n.y > n.z ? 1 : 2);
+		const int u = (drop + 1) % 3;
+		const int v = (drop + 2) % 3;
+
+		for (int i = 0; i < 3; ++i) {
+			const TVectorD& p0 = a[i];
+			const TVectorD& p1 = a[(i + 1) % 3];
+			for (int j = 0; j < 3; ++j) {
+				const TVectorD& q0 = b[j];
+				const TVectorD& q1 = b[(j + 1) % 3];
+				const double o0 = Orient2D(p0, p1, q0, u, v);
+				const double o1 = Orient2D(p0, p1, q1, u, v);
+				const double o2 = Orient2D(q0, q1, p0, u, v);
+				const double o3 = Orient2D(q0, q1, p1, u, v);
+				if (o0 * o1 < 0.0 && o2 * o3 < 0.0) {
+					return p0 + (p1 - p0) * (o2 / (o2 - o3));
+				}
+			}
+		}
+
+		if (InTriangle2D(a[0], b, u, v)) {
+			return a[0];
+		}
+		if (InTriangle2D(b[0], a, u, v)) {
+			return b[0];
+		}
+		return {};
+	}
 } // anonymous namespace
 
 std::optional<TVectorF> NGeometry::IntersectLinePlane(const TVectorF & lineA, const TVectorF & lineB, const TVectorF & planeCo, const TVectorF & planeNo)
@@ -123,6 +206,79 @@ std::optional<std::array<TVectorF, 2>> NGeometry::IntersectLineLine(const TVecto
 	return { std::move(i) };
 }
 
+std::optional<std::array<TVectorF, 2>> NGeometry::IntersectTriangleTriangle(const std::array<TVectorF, 3>& a, const std::array<TVectorF, 3>& b)
+{
+	const TTriangleD ta = { TVectorD(a[0]), TVectorD(a[1]), TVectorD(a[2]) };
+	const TTriangleD tb = { TVectorD(b[0]), TVectorD(b[1]), TVectorD(b[2]) };
+
+	const TVectorD na = cross(ta[1] - ta[0], ta[2] - ta[0]);
+	const TVectorD nb = cross(tb[1] - tb[0], tb[2] - tb[0]);
+	const double lenA = glm::length(na);
+	const double lenB = glm::length(nb);
+	if (lenA == 0.0 || lenB == 0.0) {
+		return {};
+	}
+
+	// tolerance relative to the triangle scale, distances below are snapped to the plane
+	const double scale = std::max(std::sqrt(lenA), std::sqrt(lenB));
+	const double epsilon = scale * 1e-9;
+
+	const auto distB = PlaneDistances(tb, na / lenA, ta[0], epsilon);
+	if (SameSide(distB)) {
+		return {};
+	}
+	const auto distA = PlaneDistances(ta, nb / lenB, tb[0], epsilon);
+	if (SameSide(distA)) {
+		return {};
+	}
+
+	if (distA[0] == 0.0 && distA[1] == 0.0 && distA[2] == 0.0) {
+		const auto point = CoplanarOverlap(ta, tb, na);
+		if (!point) {
+			return {};
+		}
+		const TVectorF p(*point);
+		return std::array<TVectorF, 2>{ p, p };
+	}
+
+	std::array<TVectorD, 3> pointsA;
+	std::array<TVectorD, 3> pointsB;
+	const int countA = SplitByPlane(ta, distA, pointsA);
+	const int countB = SplitByPlane(tb, distB, pointsB);
+	if (!countA || !countB) {
+		return {};
+	}
+
+	// both segments lie on the line shared by the planes, overlap their intervals
+	const TVectorD dir = cross(na, nb);
+	auto interval = [&dir](const std::array<TVectorD, 3>& points, int count) {
+		std::array<std::pair<double, TVectorD>, 2> range = {
+			std::make_pair(dot(dir, points[0]), points[0]),
+			std::make_pair(dot(dir, points[0]), points[0]),
+		};
+		for (int i = 1; i < count; ++i) {
+			const double t = dot(dir, points[i]);
+			if (t < range[0].first) {
+				range[0] = { t, points[i] };
+			}
+			if (t > range[1].first) {
+				range[1] = { t, points[i] };
+			}
+		}
+		return range;
+	};
+
+	const auto rangeA = interval(pointsA, countA);
+	const auto rangeB = interval(pointsB, countB);
+	const auto& start = rangeA[0].first > rangeB[0].first ? rangeA[0] : rangeB[0];
+	const auto& end = rangeA[1].first < rangeB[1].first ? rangeA[1] : rangeB[1];
+	if (start.first > end.first) {
+		return {};
+	}
+
+	return std::array<TVectorF, 2>{ TVectorF(start.second), TVectorF(end.second) };
+}
+
 TVectorF NGeometry::IntersectPointLine(const TVectorF& pt, const TVectorF& lineP1, const TVectorF& lineP2)
 {
 	const TVectorF u = lineP2 - lineP1;
@@ -167,6 +323,85 @@ float NGeometry::ClosestToRay(TVectorF& rClose, const TVectorF& p, const TVector
 	return lambda;
 }
 
+// Ericson, Real-Time Collision Detection, 5.1.5
+TVectorF NGeometry::ClosestToTriangle(TVectorF& rClose, const TVectorF& p, const TVectorF& a, const TVectorF& b, const TVectorF& c)
+{
+	const TVectorF ab = b - a;
+	const TVectorF ac = c - a;
+	const TVectorF ap = p - a;
+
+	const float d1 = dot(ab, ap);
+	const float d2 = dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f) {
+		rClose = a;
+		return { 1.0f, 0.0f, 0.0f };
+	}
+
+	const TVectorF bp = p - b;
+	const float d3 = dot(ab, bp);
+	const float d4 = dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3) {
+		rClose = b;
+		return { 0.0f, 1.0f, 0.0f };
+	}
+
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+		const float v = d1 / (d1 - d3);
+		rClose = a + ab * v;
+		return { 1.0f - v, v, 0.0f };
+	}
+
+	const TVectorF cp = p - c;
+	const float d5 = dot(ab, cp);
+	const float d6 = dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6) {
+		rClose = c;
+		return { 0.0f, 0.0f, 1.0f };
+	}
+
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+		const float w = d2 / (d2 - d6);
+		rClose = a + ac * w;
+		return { 1.0f - w, 0.0f, w };
+	}
+
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+		const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		rClose = b + (c - b) * w;
+		return { 0.0f, 1.0f - w, w };
+	}
+
+	const float sum = va + vb + vc;
+	if (sum == 0.0f) {
+		// zero area, take the nearest of the three edges
+		const std::array<TVectorF, 3> corners = { a, b, c };
+		float best = std::numeric_limits<float>::max();
+		TVectorF barycentric;
+		for (int i = 0; i < 3; ++i) {
+			TVectorF close;
+			const float lambda = std::clamp(ClosestToLine(close, p, corners[i], corners[(i + 1) % 3]), 0.0f, 1.0f);
+			close = corners[i] + (corners[(i + 1) % 3] - corners[i]) * lambda;
+			const float dist = glm::length(p - close);
+			if (dist < best) {
+				best = dist;
+				rClose = close;
+				barycentric = TVectorF(0.0f);
+				barycentric[i] = 1.0f - lambda;
+				barycentric[(i + 1) % 3] = lambda;
+			}
+		}
+		return barycentric;
+	}
+
+	const float v = vb / sum;
+	const float w = vc / sum;
+	rClose = a + ab * v + ac * w;
+	return { 1.0f - v - w, v, w };
+}
+
 LXtPointID NGeometry::OtherPointFromEdge(TPoint& point, TEdge& edge) {
 	return OtherPointIdFromEdge(point.ID(), edge);
 }
@@ -2,7 +2,9 @@
 
 #include "vector.h"
 
+#include <array>
 #include <optional>
+#include <vector>
 
 #include <lxmesh.h>
 
@@ -28,11 +30,16 @@ namespace NGeometry {
 	int IntersectLineLine(const TVectorF& v1, const TVectorF& v2, const TVectorF& v3, const TVectorF& v4, TVectorF& res1, TVectorF& res2);
 	std::optional<std::array<TVectorF, 2>> IntersectLineLine(const TVectorF& v1, const TVectorF& v2, const TVectorF& v3, const TVectorF& v4);
 
+	// segment shared by two triangles, zero length for touching or coplanar overlapping triangles
+	std::optional<std::array<TVectorF, 2>> IntersectTriangleTriangle(const std::array<TVectorF, 3>& a, const std::array<TVectorF, 3>& b);
+
 	TVectorF IntersectPointLine(const TVectorF& pt, const TVectorF& lineP1, const TVectorF& lineP2);
 
 	float AngleNormalized(const TVectorF& v1, const TVectorF& v2);
 	float ClosestToLine(TVectorF& rClose, const TVectorF& p, const TVectorF& l1, const TVectorF& l2);
 	float ClosestToRay(TVectorF& rClose, const TVectorF& p, const TVectorF& rayOrig, const TVectorF& rayDir);
+	// return barycentric coordinates of rClose
+	TVectorF ClosestToTriangle(TVectorF& rClose, const TVectorF& p, const TVectorF& a, const TVectorF& b, const TVectorF& c);
 
 	LXtPointID OtherPointIdFromEdge(LXtPointID pointId, TEdge& edge);
 	LXtPointID OtherPointFromEdge(TPoint& point, TEdge& edge);
@@ -0,0 +1,383 @@
+#include "geodesic.h"
+
+#include "parallel.h"
+#include "snapshot.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace {
+	constexpr float Unreached = std::numeric_limits<float>::infinity();
+
+	// monotone priority queue: buckets by the highest bit in which a key
+	// differs from the last key popped
+	class TRadixHeap
+	{
+	public:
+		bool Empty() const
+		{
+			return !Size;
+		}
+
+		void Push(float key, unsigned value)
+		{
+			const uint32_t bits = std::bit_cast<uint32_t>(key);
+			Buckets[Bucket(bits)].emplace_back(bits, value);
+			++Size;
+		}
+
+		std::pair<float, unsigned> Pop()
+		{
+			if (Buckets[0].empty()) {
+				unsigned bucket = 1;
+				while (Buckets[bucket].empty()) {
+					++bucket;
+				}
+				Last = std::min_element(Buckets[bucket].begin(), Buckets[bucket].end())->first;
+				for (const auto& item : Buckets[bucket]) {
+					Buckets[Bucket(item.first)].push_back(item);
+				}
+				Buckets[bucket].clear();
+			}
+			const auto item = Buckets[0].back();
+			Buckets[0].pop_back();
+			--Size;
+			return {std::bit_cast<float>(item.first), item.second};
+		}
+
+	private:
+		unsigned Bucket(uint32_t bits) const
+		{
+			return bits == Last ? 0 : 32 - std::countl_zero(bits ^ Last);
+		}
+
+	private:
+		// non negative floats sort like their bits
+		std::array<std::vector<std::pair<uint32_t, unsigned>>, 33> Buckets;
+		uint32_t Last = 0;
+		size_t Size = 0;
+	};
+
+	double HalfCotangent(const TVectorD& apex, const TVectorD& a, const TVectorD& b)
+	{
+		const TVectorD u = a - apex;
+		const TVectorD v = b - apex;
+		const double sine = glm::length(glm::cross(u, v));
+		return sine > 0.0 ? 0.5 * glm::dot(u, v) / sine : 0.0;
+	}
+} // anonymous namespace
+
+TEdgeDistance::TEdgeDistance(const TTopology& topology)
+	: Topology(topology)
+	, Lengths(topology.EdgeCount())
+{
+	const auto& positions = Topology.Snapshot.Positions;
+	NParallel::For(Lengths.size(), [&](size_t edge) {
+		Lengths[edge] = glm::length(positions[Topology.Edges[edge][1]] - positions[Topology.Edges[edge][0]]);
+	});
+}
+
+std::vector<float> TEdgeDistance::Distances(const TBitSet& seeds) const
+{
+	std::vector<float> distances(Topology.PointCount(), Unreached);
+	TRadixHeap heap;
+	seeds.ForEach([&](unsigned point) {
+		distances[point] = 0.0f;
+		heap.Push(0.0f, point);
+	});
+
+	while (!heap.Empty()) {
+		const auto [distance, point] = heap.Pop();
+		// settled through a shorter path since
+		if (distance != distances[point]) {
+			continue;
+		}
+		for (unsigned slot = Topology.PointEdgeStart[point]; slot < Topology.PointEdgeStart[point + 1]; ++slot) {
+			const unsigned edge = Topology.PointEdges[slot];
+			const unsigned other = Topology.OtherPoint(edge, point);
+			const float next = distance + Lengths[edge];
+			if (next < distances[other]) {
+				distances[other] = next;
+				heap.Push(next, other);
+			}
+		}
+	}
+	return distances;
+}
+
+double& THeatDistance::TFactor::At(unsigned row, unsigned column)
+{
+	return Values[Offset[row] + column - First[row]];
+}
+
+double THeatDistance::TFactor::At(unsigned row, unsigned column) const
+{
+	return Values[Offset[row] + column - First[row]];
+}
+
+void THeatDistance::TFactor::Solve(std::vector<double>& values) const
+{
+	const unsigned count = static_cast<unsigned>(First.size());
+	for (unsigned row = 0; row < count; ++row) {
+		double sum = values[row];
+		for (unsigned column = First[row]; column < row; ++column) {
+			sum -= At(row, column) * values[column];
+		}
+		values[row] = sum / At(row, row);
+	}
+	for (unsigned row = count; row-- > 0;) {
+		values[row] /= At(row, row);
+		for (unsigned column = First[row]; column < row; ++column) {
+			values[column] -= At(row, column) * values[row];
+		}
+	}
+}
+
+THeatDistance::THeatDistance(const TTopology& topology, double time)
+	: Topology(topology)
+{
+	const auto& snapshot = Topology.Snapshot;
+	const unsigned pointCount = Topology.PointCount();
+
+	for (unsigned polygon = 0; polygon < snapshot.PolygonCount(); ++polygon) {
+		const unsigned begin = snapshot.PolygonStart[polygon];
+		for (unsigned corner = begin + 1; corner + 1 < snapshot.PolygonStart[polygon + 1]; ++corner) {
+			Triangles.push_back({snapshot.PolygonVertices[begin], snapshot.PolygonVertices[corner], snapshot.PolygonVertices[corner + 1]});
+		}
+	}
+
+	Cotangents.resize(Triangles.size());
+	std::vector<double> areas(Triangles.size());
+	NParallel::For(Triangles.size(), [&](size_t triangle) {
+		const auto& t = Triangles[triangle];
+		const TVectorD a(snapshot.Positions[t[0]]);
+		const TVectorD b(snapshot.Positions[t[1]]);
+		const TVectorD c(snapshot.Positions[t[2]]);
+		Cotangents[triangle] = {HalfCotangent(a, b, c), HalfCotangent(b, c, a), HalfCotangent(c, a, b)};
+		areas[triangle] = 0.5 * glm::length(glm::cross(b - a, c - a));
+	});
+
+	// lumped mass and off diagonal weights, the edge facing corner k gets its cotangent
+	Mass.assign(pointCount, 0.0);
+	std::vector<std::pair<uint64_t, double>> entries;
+	entries.reserve(6 * Triangles.size());
+	for (size_t triangle = 0; triangle < Triangles.size(); ++triangle) {
+		const auto& t = Triangles[triangle];
+		for (unsigned k = 0; k < 3; ++k) {
+			Mass[t[k]] += areas[triangle] / 3.0;
+			const uint64_t i = t[(k + 1) % 3];
+			const uint64_t j = t[(k + 2) % 3];
+			entries.emplace_back((i << 32) | j, Cotangents[triangle][k]);
+			entries.emplace_back((j << 32) | i, Cotangents[triangle][k]);
+		}
+	}
+	std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+	});
+
+	RowStart.assign(pointCount + 1, 0);
+	for (size_t i = 0; i < entries.size(); ++i) {
+		if (i && entries[i].first == entries[i - 1].first) {
+			Weights.back() += entries[i].second;
+			continue;
+		}
+		++RowStart[entries[i].first >> 32];
+		Columns.push_back(static_cast<unsigned>(entries[i].first));
+		Weights.push_back(entries[i].second);
+	}
+	NParallel::ExclusiveScan(RowStart);
+
+	double length = 0.0;
+	for (const auto& edge : Topology.Edges) {
+		length += glm::length(snapshot.Positions[edge[1]] - snapshot.Positions[edge[0]]);
+	}
+	length /= std::max<double>(Topology.EdgeCount(), 1.0);
+	const double step = time * length * length;
+
+	Order();
+	Heat = Factor(1.0, step);
+	// the Laplacian alone is singular, a trace of mass only fixes the constant
+	Poisson = Factor(1e-8 / std::max(step, std::numeric_limits<double>::min()), 1.0);
+}
+
+void THeatDistance::Order()
+{
+	const unsigned pointCount = Topology.PointCount();
+	auto degree = [this](unsigned point) {
+		return RowStart[point + 1] - RowStart[point];
+	};
+
+	std::vector<unsigned> seeds(pointCount);
+	for (unsigned point = 0; point < pointCount; ++point) {
+		seeds[point] = point;
+	}
+	std::stable_sort(seeds.begin(), seeds.end(), [&degree](unsigned a, unsigned b) {
+		return degree(a) < degree(b);
+	});
+
+	// Cuthill-McKee from the lowest degree point of each component, then reversed
+	std::vector<uint8_t> visited(pointCount, 0);
+	Ordered.clear();
+	Ordered.reserve(pointCount);
+	Components.assign(pointCount, 0);
+	ComponentCount = 0;
+	for (const unsigned seed : seeds) {
+		if (visited[seed]) {
+			continue;
+		}
+		size_t head = Ordered.size();
+		visited[seed] = 1;
+		Ordered.push_back(seed);
+		while (head < Ordered.size()) {
+			const unsigned point = Ordered[head++];
+			Components[point] = ComponentCount;
+			const size_t first = Ordered.size();
+			for (unsigned slot = RowStart[point]; slot < RowStart[point + 1]; ++slot) {
+				if (!visited[Columns[slot]]) {
+					visited[Columns[slot]] = 1;
+					Ordered.push_back(Columns[slot]);
+				}
+			}
+			std::stable_sort(Ordered.begin() + first, Ordered.end(), [&degree](unsigned a, unsigned b) {
+				return degree(a) < degree(b);
+			});
+		}
+		++ComponentCount;
+	}
+	std::reverse(Ordered.begin(), Ordered.end());
+
+	Rank.resize(pointCount);
+	for (unsigned rank = 0; rank < pointCount; ++rank) {
+		Rank[Ordered[rank]] = rank;
+	}
+}
+
+THeatDistance::TFactor THeatDistance::Factor(double massScale, double laplacianScale) const
+{
+	const unsigned count = static_cast<unsigned>(Ordered.size());
+
+	TFactor factor;
+	factor.First.resize(count);
+	factor.Offset.resize(count + 1);
+	NParallel::For(count, [&](size_t row) {
+		const unsigned point = Ordered[row];
+		unsigned first = static_cast<unsigned>(row);
+		for (unsigned slot = RowStart[point]; slot < RowStart[point + 1]; ++slot) {
+			first = std::min(first, Rank[Columns[slot]]);
+		}
+		factor.First[row] = first;
+	});
+	factor.Offset[0] = 0;
+	for (unsigned row = 0; row < count; ++row) {
+		factor.Offset[row + 1] = factor.Offset[row] + (row - factor.First[row] + 1);
+	}
+	factor.Values.assign(factor.Offset[count], 0.0);
+
+	NParallel::For(count, [&](size_t row) {
+		const unsigned point = Ordered[row];
+		double diagonal = massScale * Mass[point];
+		for (unsigned slot = RowStart[point]; slot < RowStart[point + 1]; ++slot) {
+			diagonal += laplacianScale * Weights[slot];
+			const unsigned column = Rank[Columns[slot]];
+			if (column < row) {
+				factor.At(static_cast<unsigned>(row), column) = -laplacianScale * Weights[slot];
+			}
+		}
+		// isolated points stay decoupled
+		factor.At(static_cast<unsigned>(row), static_cast<unsigned>(row)) = diagonal > 0.0 ? diagonal : 1.0;
+	});
+
+	// fill stays inside each row's envelope
+	for (unsigned row = 0; row < count; ++row) {
+		const unsigned first = factor.First[row];
+		const double* rowValues = &factor.Values[factor.Offset[row]] - first;
+		for (unsigned column = first; column < row; ++column) {
+			const unsigned start = std::max(first, factor.First[column]);
+			const double* columnValues = &factor.Values[factor.Offset[column]] - factor.First[column];
+			double sum = rowValues[column];
+			for (unsigned k = start; k < column; ++k) {
+				sum -= rowValues[k] * columnValues[k];
+			}
+			factor.At(row, column) = sum / factor.At(column, column);
+		}
+		double diagonal = factor.At(row, row);
+		for (unsigned k = first; k < row; ++k) {
+			diagonal -= rowValues[k] * rowValues[k];
+		}
+		factor.At(row, row) = std::sqrt(std::max(diagonal, std::numeric_limits<double>::min()));
+	}
+	return factor;
+}
+
+std::vector<float> THeatDistance::Distances(const TBitSet& seeds) const
+{
+	const auto& positions = Topology.Snapshot.Positions;
+	const unsigned pointCount = Topology.PointCount();
+	std::vector<float> distances(pointCount, Unreached);
+	if (!seeds.Count()) {
+		return distances;
+	}
+
+	std::vector<double> values(pointCount, 0.0);
+	seeds.ForEach([&](unsigned point) {
+		values[Rank[point]] = 1.0;
+	});
+	Heat.Solve(values);
+
+	// unit vector field along the heat gradient, pointing away from the seeds
+	std::vector<TVectorD> field(Triangles.size());
+	NParallel::For(Triangles.size(), [&](size_t triangle) {
+		const auto& t = Triangles[triangle];
+		const TVectorD a(positions[t[0]]);
+		const TVectorD b(positions[t[1]]);
+		const TVectorD c(positions[t[2]]);
+		const TVectorD normal = glm::cross(b - a, c - a);
+		const double area2 = glm::length(normal);
+		if (area2 <= 0.0) {
+			field[triangle] = TVectorD(0.0);
+			return;
+		}
+		const TVectorD n = normal / area2;
+		const TVectorD gradient = (values[Rank[t[0]]] * glm::cross(n, c - b) + values[Rank[t[1]]] * glm::cross(n, a - c) + values[Rank[t[2]]] * glm::cross(n, b - a)) / area2;
+		const double length = glm::length(gradient);
+		field[triangle] = length > 0.0 ? -gradient / length : TVectorD(0.0);
+	});
+
+	std::vector<double> divergence(pointCount, 0.0);
+	for (size_t triangle = 0; triangle < Triangles.size(); ++triangle) {
+		const auto& t = Triangles[triangle];
+		const auto& cot = Cotangents[triangle];
+		for (unsigned k = 0; k < 3; ++k) {
+			const unsigned i = t[k];
+			const unsigned j = t[(k + 1) % 3];
+			const unsigned l = t[(k + 2) % 3];
+			const TVectorD p(positions[i]);
+			divergence[i] += cot[(k + 2) % 3] * glm::dot(TVectorD(positions[j]) - p, field[triangle]) + cot[(k + 1) % 3] * glm::dot(TVectorD(positions[l]) - p, field[triangle]);
+		}
+	}
+
+	std::vector<double> potential(pointCount);
+	for (unsigned point = 0; point < pointCount; ++point) {
+		potential[Rank[point]] = -divergence[point];
+	}
+	Poisson.Solve(potential);
+
+	// each component solves up to its own constant, components without a seed stay unreached
+	std::vector<double> offsets(ComponentCount, std::numeric_limits<double>::infinity());
+	seeds.ForEach([&](unsigned point) {
+		double& offset = offsets[Components[point]];
+		offset = std::min(offset, potential[Rank[point]]);
+	});
+	NParallel::For(pointCount, [&](size_t point) {
+		const double offset = offsets[Components[point]];
+		if (offset != std::numeric_limits<double>::infinity()) {
+			distances[point] = static_cast<float>(potential[Rank[point]] - offset);
+		}
+	});
+	return distances;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+class TTopology;
+
+// Shortest paths along edges from every seed point. Keys only grow while
+// the search runs, so a radix heap replaces the binary heap. Points that
+// cannot be reached get infinity.
+class TEdgeDistance
+{
+public:
+	explicit TEdgeDistance(const TTopology& topology);
+
+	std::vector<float> Distances(const TBitSet& seeds) const;
+
+private:
+	const TTopology& Topology;
+	std::vector<float> Lengths;
+};
+
+// Heat method (Crane et al.) on the fan triangulation of the polygons:
+// heat flows from the seeds for a short time, its normalized gradient is
+// integrated back with a Poisson solve. Both systems are factored once in
+// the constructor, so each query costs two triangular solve pairs.
+// time scales the default step of mean edge length squared. Points in a
+// component without a seed get infinity. Heat underflows some hundreds of
+// edges from the seeds, beyond that distances flatten out unless time is
+// raised.
+// The factors are dense within each row's envelope: memory grows with
+// points times bandwidth, roughly n^1.5 on a surface, which is fine for
+// models of some hundred thousand points but not for multi-million point
+// scans; use TEdgeDistance there.
+class THeatDistance
+{
+public:
+	explicit THeatDistance(const TTopology& topology, double time = 1.0);
+	THeatDistance(const THeatDistance& rhs) = delete;
+	THeatDistance& operator=(const THeatDistance& rhs) = delete;
+
+	std::vector<float> Distances(const TBitSet& seeds) const;
+
+private:
+	// Cholesky factor stored by rows from the first non zero column to the diagonal
+	struct TFactor
+	{
+		std::vector<unsigned> First;
+		std::vector<size_t> Offset;
+		std::vector<double> Values;
+
+		double& At(unsigned row, unsigned column);
+		double At(unsigned row, unsigned column) const;
+		void Solve(std::vector<double>& values) const;
+	};
+
+	void Order();
+	// factor of Mass * massScale + Laplacian * laplacianScale, in Order
+	TFactor Factor(double massScale, double laplacianScale) const;
+
+private:
+	const TTopology& Topology;
+
+	std::vector<std::array<unsigned, 3>> Triangles;
+	// half cotangent at each triangle corner
+	std::vector<std::array<double, 3>> Cotangents;
+	std::vector<double> Mass;
+
+	// off diagonal cotangent weights per point, sorted by column
+	std::vector<unsigned> RowStart;
+	std::vector<unsigned> Columns;
+	std::vector<double> Weights;
+
+	// reverse Cuthill-McKee: Ordered[rank] is a point, Rank[point] its position
+	std::vector<unsigned> Ordered;
+	std::vector<unsigned> Rank;
+	// connected component of each point through the weights
+	std::vector<unsigned> Components;
+	unsigned ComponentCount = 0;
+
+	TFactor Heat;
+	TFactor Poisson;
+};
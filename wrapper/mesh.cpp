@@ -3,6 +3,7 @@
 #include "edge.h"
 #include "polygon.h"
 
+#include <algorithm>
 #include <memory>
 #include <cassert>
 #include <vector>
@@ -11,20 +12,22 @@ namespace {
 	template<typename T, typename TInternal>
 	class TVisitor : public CLxVisitor {
 	public:
-		TVisitor(const std::function<void(T&)>& l, TInternal& item)
+		TVisitor(const std::function<void(T&)>& l, TInternal& item, TMesh& mesh)
 			: Lambda(l)
 			, Item(item)
+			, Mesh(mesh)
 		{
 		}
 
 		void evaluate() final {
-			T item(Item);
+			T item(Item, &Mesh);
 			Lambda(item);
 		}
 
 	private:
 		const std::function<void(T&)> Lambda;
 		TInternal& Item;
+		TMesh& Mesh;
 	};
 
 	using TPointVisitor = TVisitor<TPoint, CLxUser_Point>;
@@ -43,7 +46,7 @@ TMesh::TMesh(CLxUser_Mesh& mesh, CLxUser_LayerScan& layerScan, unsigned index)
 void TMesh::EachPolygon(const std::function<void(TPolygon&)>& lambda, TMarkMode mode)
 {
 	auto polygon = InitPolygon();
-	TPolygonVisitor vis(lambda, polygon);
+	TPolygonVisitor vis(lambda, polygon, *this);
 
 	polygon.Enumerate(mode.Mode, vis, 0);
 }
@@ -51,7 +54,7 @@ void TMesh::EachPolygon(const std::function<void(TPolygon&)>& lambda, TMarkMode
 void TMesh::EachPoint(const std::function<void(TPoint&)>& lambda, TMarkMode mode)
 {
 	auto point = InitPoint();
-	TPointVisitor vis(lambda, point);
+	TPointVisitor vis(lambda, point, *this);
 
 	point.Enumerate(mode.Mode, vis, 0);
 }
@@ -59,7 +62,7 @@ void TMesh::EachPoint(const std::function<void(TPoint&)>& lambda, TMarkMode mode
 void TMesh::EachEdge(const std::function<void(TEdge&)>& lambda, TMarkMode mode)
 {
 	auto edge = InitEdge();
-	TEdgeVisitor vis(lambda, edge);
+	TEdgeVisitor vis(lambda, edge, *this);
 
 	edge.Enumerate(mode.Mode, vis, 0);
 }
@@ -69,14 +72,40 @@ TMarkMode TMesh::MarkMode(TMarkMode::ESelect set, TMarkMode::ESelect clear)
 	return TMarkMode(Service, set, clear);
 }
 
+void TMesh::AddChange(unsigned flags)
+{
+	Change |= flags;
+}
+
+unsigned TMesh::PendingChange() const
+{
+	return Change;
+}
+
 void TMesh::SetChange()
 {
-	LayerScan.SetMeshChange(Index, LXf_MESHEDIT_GEOMETRY);
+	LayerScan.SetMeshChange(Index, Change ? Change : LXf_MESHEDIT_GEOMETRY);
 }
 
 void TMesh::Update()
 {
 	LayerScan.Update();
+	Change = 0;
+}
+
+void TMesh::BeginEditBatch()
+{
+	Mesh.BeginEditBatch();
+}
+
+void TMesh::EndEditBatch()
+{
+	Mesh.EndEditBatch();
+}
+
+bool TMesh::TrackChanges(CLxUser_MeshTracker& tracker)
+{
+	return LXx_OK(Mesh.TrackChanges(tracker));
 }
 
 ILxUnknownID TMesh::ID() const
@@ -89,6 +118,21 @@ unsigned TMesh::GetIndex() const
 	return Index;
 }
 
+unsigned TMesh::PointCount() const
+{
+	return std::max(Mesh.NPoints(), 0);
+}
+
+unsigned TMesh::PolygonCount() const
+{
+	return std::max(Mesh.NPolygons(), 0);
+}
+
+unsigned TMesh::EdgeCount() const
+{
+	return std::max(Mesh.NEdges(), 0);
+}
+
 CLxUser_Polygon TMesh::InitPolygon()
 {
 	CLxUser_Polygon p;
@@ -110,6 +154,13 @@ CLxUser_Point TMesh::InitPoint()
 	return p;
 }
 
+CLxUser_MeshMap TMesh::InitMeshMap()
+{
+	CLxUser_MeshMap m;
+	m.fromMesh(Mesh);
+	return m;
+}
+
 CLxUser_Edge TMesh::GetEdge(LXtEdgeID edge)
 {
 	CLxUser_Edge e;
@@ -152,6 +203,7 @@ LXtPointID TMesh::CreatePoint(const TVectorF& co)
 	LXtPointID v;
 	TVectorD cod(co);
 	point.New(&cod.x, &v);
+	Change |= LXf_MESHEDIT_POINTS;
 	return v;
 }
 
@@ -169,6 +221,21 @@ LXtPolygonID TMesh::CreatePolygon(std::vector<LXtPointID> points, bool flip)
 	}
 
 	auto createResult = polygon.New(type, &points[0], points.size(), 0, &id);
+	Change |= LXf_MESHEDIT_POLYGONS;
+	return id;
+}
+
+LXtPolygonID TMesh::CreatePolygon(LXtPolygonID proto, const std::vector<LXtPointID>& points)
+{
+	CLxUser_Polygon polygon;
+	polygon.fromMesh(Mesh);
+	polygon.Select(proto);
+	LXtPolygonID id;
+	LXtID4 type;
+	polygon.Type(&type);
+
+	polygon.NewProto(type, points.data(), static_cast<unsigned>(points.size()), 0, &id);
+	Change |= LXf_MESHEDIT_POLYGONS;
 	return id;
 }
 
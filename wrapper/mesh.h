@@ -28,12 +28,22 @@ public:
 
 	TMarkMode MarkMode(TMarkMode::ESelect set, TMarkMode::ESelect clear);
 
+	// flags are LXf_MESHEDIT_*, collected until the next Update()
+	void AddChange(unsigned flags);
+	unsigned PendingChange() const;
+	// sends the collected flags, LXf_MESHEDIT_GEOMETRY when nothing was recorded
 	void SetChange();
 	void Update();
 
+	void BeginEditBatch();
+	void EndEditBatch();
+
+	bool TrackChanges(CLxUser_MeshTracker& tracker);
+
 	CLxUser_Polygon InitPolygon();
 	CLxUser_Edge InitEdge();
 	CLxUser_Point InitPoint();
+	CLxUser_MeshMap InitMeshMap();
 
 	CLxUser_Edge GetEdge(LXtEdgeID e);
 	CLxUser_Edge GetEdge(LXtPointID v0, LXtPointID v1);
@@ -42,11 +52,17 @@ public:
 
 	LXtPointID CreatePoint(const TVectorF& co);
 	LXtPolygonID CreatePolygon(std::vector<LXtPointID> points, bool flip = false);
+	// with the type and tags of proto
+	LXtPolygonID CreatePolygon(LXtPolygonID proto, const std::vector<LXtPointID>& points);
 
 	CLxMatrix4 GetTransform();
 	ILxUnknownID ID() const;
 	unsigned GetIndex() const;
 
+	unsigned PointCount() const;
+	unsigned PolygonCount() const;
+	unsigned EdgeCount() const;
+
 	static TMarkModeList GetSetMarkMode();
 	static TMarkModeList GetClearMarkMode();
 
@@ -88,4 +104,5 @@ private:
 	CLxUser_Mesh Mesh;
 	CLxUser_LayerScan& LayerScan;
 	unsigned Index;
+	unsigned Change = 0;
 };
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "mesh_cache.h"
+
+#include "bitset.h"
+#include "mesh.h"
+#include "parallel.h"
+#include "point.h"
+#include "polygon.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+	class TTrackerVisitor : public CLxVisitor
+	{
+	public:
+		// the enumeration stops once lambda returns false
+		explicit TTrackerVisitor(const std::function<bool()>& lambda)
+			: Lambda(lambda)
+		{
+		}
+
+		LxResult eval_RC() final
+		{
+			return Lambda() ? LXe_OK : LXe_ABORT;
+		}
+
+	private:
+		const std::function<bool()> Lambda;
+	};
+
+	struct TChangedPolygon
+	{
+		unsigned Index;
+		LXtPolygonID Id;
+		std::vector<unsigned> Vertices;
+	};
+} // anonymous namespace
+
+TMeshCache::TMeshCache(TMesh& mesh, float rebuildRatio)
+	: Mesh(mesh)
+	, RebuildRatio(rebuildRatio)
+{
+	Tracking = Mesh.TrackChanges(Tracker) && LXx_OK(Tracker.Start());
+	Rebuild();
+}
+
+TMeshCache::~TMeshCache()
+{
+	if (Tracking) {
+		Tracker.Stop();
+	}
+}
+
+void TMeshCache::SetRebuildRatio(float rebuildRatio)
+{
+	RebuildRatio = rebuildRatio;
+}
+
+const TMeshSnapshot& TMeshCache::Snapshot() const
+{
+	return *SnapshotValue;
+}
+
+const std::vector<TBox>& TMeshCache::PolygonBounds() const
+{
+	return Bounds;
+}
+
+const std::vector<TVectorF>& TMeshCache::PolygonNormals() const
+{
+	return Normals;
+}
+
+const TTopology& TMeshCache::Topology()
+{
+	if (!TopologyValue) {
+		TopologyValue = std::make_unique<TTopology>(*SnapshotValue);
+	}
+	return *TopologyValue;
+}
+
+void TMeshCache::Rebuild()
+{
+	TopologyValue.reset();
+	SnapshotValue = std::make_unique<TMeshSnapshot>(Mesh);
+	Bounds.resize(SnapshotValue->PolygonCount());
+	Normals.resize(SnapshotValue->PolygonCount());
+	NParallel::For(SnapshotValue->PolygonCount(), [this](size_t polygon) {
+		Derive(static_cast<unsigned>(polygon));
+	});
+	if (Tracking) {
+		Tracker.Reset();
+	}
+}
+
+TMeshCache::ERefresh TMeshCache::Refresh()
+{
+	if (!Tracking) {
+		Rebuild();
+		return ERefresh::Rebuild;
+	}
+
+	unsigned edit = 0;
+	Tracker.Changes(&edit);
+	if (!edit) {
+		return ERefresh::None;
+	}
+
+	if (Patch()) {
+		Tracker.Reset();
+		return ERefresh::Patch;
+	}
+
+	Rebuild();
+	return ERefresh::Rebuild;
+}
+
+bool TMeshCache::Patch()
+{
+	TMeshSnapshot& snapshot = *SnapshotValue;
+
+	// deleted elements renumber the ones after them
+	unsigned deleted = 0;
+	auto point = Mesh.InitPoint();
+	auto polygon = Mesh.InitPolygon();
+	TTrackerVisitor countDeleted([&deleted]() {
+		++deleted;
+		return false;
+	});
+	Tracker.EnumeratePoints(LXf_ELTEDIT_DELETE, countDeleted, point);
+	Tracker.EnumeratePolygons(LXf_ELTEDIT_DELETE, countDeleted, polygon);
+	if (deleted) {
+		return false;
+	}
+
+	const size_t limit = static_cast<size_t>(RebuildRatio * (snapshot.PointCount() + snapshot.PolygonCount()));
+	bool overflow = false;
+	const unsigned oldPointCount = snapshot.PointCount();
+
+	std::vector<unsigned> movedPoints;
+	TTrackerVisitor visitPoint([&]() {
+		TPoint item(point);
+		const unsigned index = item.Index();
+		if (index >= snapshot.PointCount()) {
+			snapshot.PointIds.resize(index + 1);
+			snapshot.Positions.resize(index + 1);
+		}
+		snapshot.PointIds[index] = item.ID();
+		snapshot.Positions[index] = item.Pos();
+		movedPoints.push_back(index);
+		overflow = movedPoints.size() > limit;
+		return !overflow;
+	});
+	Tracker.EnumeratePoints(LXf_ELTEDIT_ADD | LXf_ELTEDIT_POINT_POS, visitPoint, point);
+	if (overflow) {
+		return false;
+	}
+
+	std::vector<TChangedPolygon> changed;
+	TTrackerVisitor visitPolygon([&]() {
+		TPolygon item(polygon);
+		TChangedPolygon entry{static_cast<unsigned>(static_cast<int>(item.Index())), item.ID(), {}};
+		for (auto vertex : item.Vertexes()) {
+			entry.Vertices.push_back(vertex.Index());
+		}
+		changed.push_back(std::move(entry));
+		overflow = movedPoints.size() + changed.size() > limit;
+		return !overflow;
+	});
+	Tracker.EnumeratePolygons(LXf_ELTEDIT_ADD | LXf_ELTEDIT_POLY_VLIST, visitPolygon, polygon);
+	if (overflow) {
+		return false;
+	}
+
+	// polygon lists are rebuilt locally when any of them changed size
+	std::sort(changed.begin(), changed.end(), [](const TChangedPolygon& a, const TChangedPolygon& b) {
+		return a.Index < b.Index;
+	});
+	const unsigned oldCount = snapshot.PolygonCount();
+	const unsigned newCount = changed.empty() ? oldCount : std::max(oldCount, changed.back().Index + 1);
+	bool resized = newCount != oldCount;
+	for (const auto& entry : changed) {
+		resized |= entry.Index >= oldCount || snapshot.VertexCount(entry.Index) != entry.Vertices.size();
+	}
+
+	if (resized) {
+		std::vector<unsigned> start(newCount + 1, 0);
+		for (unsigned index = 0; index < oldCount; ++index) {
+			start[index] = snapshot.VertexCount(index);
+		}
+		for (const auto& entry : changed) {
+			start[entry.Index] = static_cast<unsigned>(entry.Vertices.size());
+		}
+		std::vector<unsigned> vertices(NParallel::ExclusiveScan(start));
+		NParallel::For(oldCount, [&](size_t index) {
+			const unsigned count = std::min(snapshot.VertexCount(static_cast<unsigned>(index)), start[index + 1] - start[index]);
+			std::copy_n(snapshot.PolygonVertices.begin() + snapshot.PolygonStart[index], count, vertices.begin() + start[index]);
+		});
+		snapshot.PolygonStart.swap(start);
+		snapshot.PolygonVertices.swap(vertices);
+		snapshot.PolygonIds.resize(newCount);
+		Bounds.resize(newCount);
+		Normals.resize(newCount);
+	}
+	for (const auto& entry : changed) {
+		snapshot.PolygonIds[entry.Index] = entry.Id;
+		std::copy(entry.Vertices.begin(), entry.Vertices.end(), snapshot.PolygonVertices.begin() + snapshot.PolygonStart[entry.Index]);
+	}
+
+	if (!changed.empty() || snapshot.PointCount() != oldPointCount) {
+		TopologyValue.reset();
+	}
+
+	// bounds and normals of every polygon touching a moved point or changed itself
+	TBitSet moved(snapshot.PointCount());
+	for (const unsigned index : movedPoints) {
+		moved.Set(index);
+	}
+	TBitSet dirty(newCount);
+	for (const auto& entry : changed) {
+		dirty.Set(entry.Index);
+	}
+	NParallel::For(newCount, [&](size_t index) {
+		bool touched = dirty.Test(static_cast<unsigned>(index));
+		for (unsigned slot = snapshot.PolygonStart[index]; slot < snapshot.PolygonStart[index + 1] && !touched; ++slot) {
+			touched = moved.Test(snapshot.PolygonVertices[slot]);
+		}
+		if (touched) {
+			Derive(static_cast<unsigned>(index));
+		}
+	});
+
+	return true;
+}
+
+void TMeshCache::Derive(unsigned polygon)
+{
+	const TMeshSnapshot& snapshot = *SnapshotValue;
+	const unsigned begin = snapshot.PolygonStart[polygon];
+	const unsigned end = snapshot.PolygonStart[polygon + 1];
+	TBox box;
+	TVectorF normal(0.0f);
+	for (unsigned slot = begin; slot < end; ++slot) {
+		const TVectorF& pos = snapshot.Positions[snapshot.PolygonVertices[slot]];
+		box.Extend(pos);
+		normal += glm::cross(pos, snapshot.Positions[snapshot.PolygonVertices[slot + 1 < end ? slot + 1 : begin]]);
+	}
+	const float length = glm::length(normal);
+	Bounds[polygon] = box;
+	Normals[polygon] = length > 0.0f ? normal / length : normal;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <lx_mesh.hpp>
+
+#include "bounds.h"
+#include "snapshot.h"
+#include "topology.h"
+#include "vector.h"
+
+#include <memory>
+#include <vector>
+
+class TMesh;
+
+// Snapshot, polygon bounds and normals kept in step with the host through a
+// mesh tracker. Moved points and edited or added polygons are read back one
+// by one and patched in; deletions, or more changed elements than
+// rebuildRatio of the mesh, rebuild everything from scratch. The topology
+// is built on demand and survives patches that only move points.
+class TMeshCache
+{
+public:
+	enum class ERefresh
+	{
+		None,
+		Patch,
+		Rebuild,
+	};
+
+	explicit TMeshCache(TMesh& mesh, float rebuildRatio = 0.2f);
+	TMeshCache(const TMeshCache& rhs) = delete;
+	TMeshCache& operator=(const TMeshCache& rhs) = delete;
+	~TMeshCache();
+
+	void SetRebuildRatio(float rebuildRatio);
+
+	// brings the cache up to date with the changes tracked since the last call
+	ERefresh Refresh();
+	void Rebuild();
+
+	const TMeshSnapshot& Snapshot() const;
+	const std::vector<TBox>& PolygonBounds() const;
+	// unit Newell normals, zero for degenerate polygons
+	const std::vector<TVectorF>& PolygonNormals() const;
+	const TTopology& Topology();
+
+private:
+	bool Patch();
+	void Derive(unsigned polygon);
+
+private:
+	TMesh& Mesh;
+	float RebuildRatio;
+	CLxUser_MeshTracker Tracker;
+	bool Tracking = false;
+
+	std::unique_ptr<TMeshSnapshot> SnapshotValue;
+	std::vector<TBox> Bounds;
+	std::vector<TVectorF> Normals;
+	// refers to the snapshot, dropped whenever connectivity changes
+	std::unique_ptr<TTopology> TopologyValue;
+};
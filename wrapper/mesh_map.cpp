@@ -0,0 +1,169 @@
+#include "mesh_map.h"
+
+#include "mesh.h"
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+	// changed entries in ascending order, found in parallel
+	std::vector<unsigned> Changed(unsigned count, unsigned dimension, const std::vector<float>& values, const std::vector<uint8_t>& set, const std::vector<float>& original, const std::vector<uint8_t>& originalSet)
+	{
+		std::vector<std::vector<unsigned>> chunkChanged(NParallel::ChunkCount(count));
+		NParallel::ForChunks(count, [&](unsigned chunk, size_t begin, size_t end) {
+			for (size_t index = begin; index < end; ++index) {
+				const auto first = values.begin() + index * dimension;
+				const bool changed = set[index] != originalSet[index]
+					|| (set[index] && !std::equal(first, first + dimension, original.begin() + index * dimension));
+				if (changed) {
+					chunkChanged[chunk].push_back(static_cast<unsigned>(index));
+				}
+			}
+		});
+
+		std::vector<unsigned> changed;
+		for (const auto& local : chunkChanged) {
+			changed.insert(changed.end(), local.begin(), local.end());
+		}
+		return changed;
+	}
+} // anonymous namespace
+
+TMeshMapView::TMeshMapView(TMesh& mesh, const TMeshSnapshot& snapshot, LXtID4 type, const char* name)
+	: Snapshot(snapshot)
+	, Type(type)
+{
+	auto map = mesh.InitMeshMap();
+	if (LXx_FAIL(map.SelectByName(type, name))) {
+		return;
+	}
+	Map = map.ID();
+	map.Dimension(&DimensionValue);
+	ContinuousValue = map.IsContinuous() == LXe_TRUE;
+	Read(mesh);
+}
+
+void TMeshMapView::Read(TMesh& mesh)
+{
+	const unsigned pointCount = Snapshot.PointCount();
+	const unsigned cornerCount = static_cast<unsigned>(Snapshot.PolygonVertices.size());
+
+	PointValues.assign(size_t(pointCount) * DimensionValue, 0.0f);
+	PointSet.assign(pointCount, 0);
+	auto point = mesh.InitPoint();
+	for (unsigned index = 0; index < pointCount; ++index) {
+		point.Select(Snapshot.PointIds[index]);
+		PointSet[index] = point.MapValue(Map, PointValues.data() + size_t(index) * DimensionValue) == LXe_OK ? 1 : 0;
+	}
+
+	CornerValues.assign(ContinuousValue ? 0 : size_t(cornerCount) * DimensionValue, 0.0f);
+	CornerSet.assign(ContinuousValue ? 0 : cornerCount, 0);
+	if (!ContinuousValue) {
+		auto polygon = mesh.InitPolygon();
+		for (unsigned index = 0; index < Snapshot.PolygonCount(); ++index) {
+			polygon.Select(Snapshot.PolygonIds[index]);
+			for (unsigned corner = Snapshot.PolygonStart[index]; corner < Snapshot.PolygonStart[index + 1]; ++corner) {
+				const LXtPointID id = Snapshot.PointIds[Snapshot.PolygonVertices[corner]];
+				CornerSet[corner] = polygon.MapValue(Map, id, CornerValues.data() + size_t(corner) * DimensionValue) == LXe_OK ? 1 : 0;
+			}
+		}
+	}
+
+	PointOriginal = PointValues;
+	PointSetOriginal = PointSet;
+	CornerOriginal = CornerValues;
+	CornerSetOriginal = CornerSet;
+}
+
+bool TMeshMapView::Valid() const
+{
+	return Map != nullptr;
+}
+
+unsigned TMeshMapView::Dimension() const
+{
+	return DimensionValue;
+}
+
+bool TMeshMapView::Continuous() const
+{
+	return ContinuousValue;
+}
+
+const float* TMeshMapView::Evaluate(unsigned corner) const
+{
+	if (!Valid()) {
+		return nullptr;
+	}
+	if (!CornerSet.empty() && CornerSet[corner]) {
+		return CornerValues.data() + size_t(corner) * DimensionValue;
+	}
+	const unsigned point = Snapshot.PolygonVertices[corner];
+	return PointSet[point] ? PointValues.data() + size_t(point) * DimensionValue : nullptr;
+}
+
+unsigned TMeshMapView::ChangeFlag() const
+{
+	switch (Type) {
+	case LXi_VMAP_TEXTUREUV:
+		return LXf_MESHEDIT_MAP_UV;
+	case LXi_VMAP_MORPH:
+	case LXi_VMAP_SPOT:
+		return LXf_MESHEDIT_MAP_MORPH;
+	default:
+		return LXf_MESHEDIT_MAP_OTHER;
+	}
+}
+
+unsigned TMeshMapView::Commit(TMesh& mesh)
+{
+	if (!Valid()) {
+		return 0;
+	}
+
+	const std::vector<unsigned> points = Changed(Snapshot.PointCount(), DimensionValue, PointValues, PointSet, PointOriginal, PointSetOriginal);
+	const std::vector<unsigned> corners = ContinuousValue ? std::vector<unsigned>() : Changed(static_cast<unsigned>(CornerSet.size()), DimensionValue, CornerValues, CornerSet, CornerOriginal, CornerSetOriginal);
+
+	auto point = mesh.InitPoint();
+	for (const unsigned index : points) {
+		point.Select(Snapshot.PointIds[index]);
+		if (PointSet[index]) {
+			point.SetMapValue(Map, PointValues.data() + size_t(index) * DimensionValue);
+		}
+		else {
+			point.ClearMapValue(Map);
+		}
+	}
+
+	// corners come in polygon order, select each polygon once
+	auto polygon = mesh.InitPolygon();
+	unsigned selected = std::numeric_limits<unsigned>::max();
+	bool continuity = false;
+	for (const unsigned corner : corners) {
+		const unsigned index = static_cast<unsigned>(std::upper_bound(Snapshot.PolygonStart.begin(), Snapshot.PolygonStart.end(), corner) - Snapshot.PolygonStart.begin()) - 1;
+		if (index != selected) {
+			polygon.Select(Snapshot.PolygonIds[index]);
+			selected = index;
+		}
+		const LXtPointID id = Snapshot.PointIds[Snapshot.PolygonVertices[corner]];
+		if (CornerSet[corner]) {
+			polygon.SetMapValue(id, Map, CornerValues.data() + size_t(corner) * DimensionValue);
+		}
+		else {
+			polygon.ClearMapValue(id, Map);
+		}
+		continuity |= CornerSet[corner] != CornerSetOriginal[corner];
+	}
+
+	if (!points.empty() || !corners.empty()) {
+		mesh.AddChange(ChangeFlag() | (continuity ? LXf_MESHEDIT_MAP_CONTINUITY : 0));
+	}
+
+	PointOriginal = PointValues;
+	PointSetOriginal = PointSet;
+	CornerOriginal = CornerValues;
+	CornerSetOriginal = CornerSet;
+	return static_cast<unsigned>(points.size() + corners.size());
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <lx_mesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class TMesh;
+class TMeshSnapshot;
+
+// Whole vertex map in flat arrays, indexed like the snapshot: Dimension()
+// floats per point for continuous values and per corner (slot of
+// PolygonVertices) for discontinuous ones. The arrays can be edited in
+// place, from several threads; Commit() compares them with the values read
+// and only sends the entries that changed.
+class TMeshMapView
+{
+public:
+	// type is LXi_VMAP_*, the view is empty when the map does not exist
+	TMeshMapView(TMesh& mesh, const TMeshSnapshot& snapshot, LXtID4 type, const char* name);
+	TMeshMapView(const TMeshMapView& rhs) = delete;
+	TMeshMapView& operator=(const TMeshMapView& rhs) = delete;
+
+	bool Valid() const;
+	unsigned Dimension() const;
+	// weights and morphs have no per corner values
+	bool Continuous() const;
+
+	// discontinuous value of the corner if there is one, else the point value, else null;
+	// always null on an invalid view
+	const float* Evaluate(unsigned corner) const;
+
+	// writes the changed values and clears removed ones, returns the number of host writes
+	unsigned Commit(TMesh& mesh);
+
+public:
+	std::vector<float> PointValues;
+	std::vector<uint8_t> PointSet;
+
+	std::vector<float> CornerValues;
+	std::vector<uint8_t> CornerSet;
+
+private:
+	void Read(TMesh& mesh);
+	unsigned ChangeFlag() const;
+
+private:
+	const TMeshSnapshot& Snapshot;
+	LXtID4 Type;
+	LXtMeshMapID Map = nullptr;
+	unsigned DimensionValue = 0;
+	bool ContinuousValue = true;
+
+	// as read from the host, or as of the last commit
+	std::vector<float> PointOriginal;
+	std::vector<uint8_t> PointSetOriginal;
+	std::vector<float> CornerOriginal;
+	std::vector<uint8_t> CornerSetOriginal;
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include "bounds.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Octree over points or boxes, built in one pass by sorting items along a
+// Morton curve instead of inserting them one at a time. Every subtree owns
+// a contiguous run of items, so fully covered nodes are emitted without
+// descending. Queries append item indices to the caller's buffer as TId,
+// in Morton order; box items are tested by their bounds only.
+template<typename TId>
+class TOctree
+{
+public:
+	explicit TOctree(const std::vector<TVectorF>& positions, unsigned leafSize = 16);
+	explicit TOctree(const std::vector<TBox>& bounds, unsigned leafSize = 16);
+
+	unsigned Count() const;
+	const TBox& Bounds() const;
+
+	void QueryBox(const TBox& box, std::vector<TId>& result) const;
+	void QuerySphere(const TVectorF& center, float radius, std::vector<TId>& result) const;
+	void QueryFrustum(const TFrustum& frustum, std::vector<TId>& result) const;
+
+private:
+	struct TNode
+	{
+		TBox Bounds;
+		unsigned First = 0;
+		unsigned Count = 0;
+		unsigned Child = 0;
+		uint8_t ChildCount = 0;
+	};
+
+	static constexpr int MaxDepth = 10;
+
+	void Build(unsigned leafSize);
+	void Emit(const TNode& node, std::vector<TId>& result) const;
+
+	// classify(box) -> EContainment, used for nodes and for items
+	template<typename F>
+	void Query(F&& classify, std::vector<TId>& result) const;
+
+private:
+	std::vector<TBox> Items;
+	std::vector<unsigned> Order;
+	std::vector<uint32_t> Codes;
+	std::vector<TNode> Nodes;
+};
+
+namespace NOctree {
+
+	inline uint32_t SpreadBits(uint32_t v)
+	{
+		v = (v | (v << 16)) & 0x030000FF;
+		v = (v | (v << 8)) & 0x0300F00F;
+		v = (v | (v << 4)) & 0x030C30C3;
+		v = (v | (v << 2)) & 0x09249249;
+		return v;
+	}
+
+	inline uint32_t MortonCode(const TVectorF& pos, const TBox& bounds)
+	{
+		const TVectorF size = glm::max(bounds.Size(), TVectorF(std::numeric_limits<float>::min()));
+		const TVectorF rel = glm::clamp((pos - bounds.Min) / size, TVectorF(0.0f), TVectorF(1.0f)) * 1023.0f;
+		return (SpreadBits(static_cast<uint32_t>(rel.x)) << 2)
+			| (SpreadBits(static_cast<uint32_t>(rel.y)) << 1)
+			| SpreadBits(static_cast<uint32_t>(rel.z));
+	}
+
+} // namespace NOctree
+
+template<typename TId>
+TOctree<TId>::TOctree(const std::vector<TVectorF>& positions, unsigned leafSize)
+	: Items(positions.size())
+{
+	NParallel::For(positions.size(), [&](size_t i) {
+		Items[i] = TBox(positions[i], positions[i]);
+	});
+	Build(leafSize);
+}
+
+template<typename TId>
+TOctree<TId>::TOctree(const std::vector<TBox>& bounds, unsigned leafSize)
+	: Items(bounds)
+{
+	Build(leafSize);
+}
+
+template<typename TId>
+unsigned TOctree<TId>::Count() const
+{
+	return static_cast<unsigned>(Items.size());
+}
+
+template<typename TId>
+const TBox& TOctree<TId>::Bounds() const
+{
+	return Nodes.front().Bounds;
+}
+
+template<typename TId>
+void TOctree<TId>::Build(unsigned leafSize)
+{
+	const size_t count = Items.size();
+
+	std::vector<TBox> chunkBounds(NParallel::ChunkCount(count));
+	NParallel::ForChunks(count, [&](unsigned chunk, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			chunkBounds[chunk].Extend(Items[i]);
+		}
+	});
+	TBox bounds;
+	for (const auto& box : chunkBounds) {
+		bounds.Extend(box);
+	}
+
+	std::vector<uint32_t> codes(count);
+	NParallel::For(count, [&](size_t i) {
+		codes[i] = NOctree::MortonCode(Items[i].Center(), bounds);
+	});
+
+	Order.resize(count);
+	for (unsigned i = 0; i < count; ++i) {
+		Order[i] = i;
+	}
+	std::sort(Order.begin(), Order.end(), [&codes](unsigned a, unsigned b) {
+		return codes[a] != codes[b] ? codes[a] < codes[b] : a < b;
+	});
+
+	std::vector<TBox> sorted(count);
+	Codes.resize(count);
+	NParallel::For(count, [&](size_t i) {
+		sorted[i] = Items[Order[i]];
+		Codes[i] = codes[Order[i]];
+	});
+	Items.swap(sorted);
+
+	// breadth first, so the children of a node are contiguous and always follow it
+	Nodes.assign(1, TNode{});
+	Nodes[0].Count = static_cast<unsigned>(count);
+	std::vector<int> depths(1, 0);
+	for (unsigned index = 0; index < Nodes.size(); ++index) {
+		const unsigned first = Nodes[index].First;
+		const unsigned end = first + Nodes[index].Count;
+		if (end - first <= std::max(leafSize, 1u)) {
+			continue;
+		}
+
+		// skip digits shared by every item of the run
+		std::array<unsigned, 9> split;
+		int depth = depths[index];
+		unsigned nonEmpty = 0;
+		for (; depth < MaxDepth && nonEmpty < 2; ++depth) {
+			const int shift = 3 * (MaxDepth - 1 - depth);
+			split[0] = first;
+			split[8] = end;
+			for (uint32_t octant = 1; octant < 8; ++octant) {
+				split[octant] = static_cast<unsigned>(std::partition_point(Codes.begin() + split[octant - 1], Codes.begin() + end, [shift, octant](uint32_t code) {
+					return ((code >> shift) & 7u) < octant;
+				}) - Codes.begin());
+			}
+
+			nonEmpty = 0;
+			for (int octant = 0; octant < 8; ++octant) {
+				nonEmpty += split[octant + 1] > split[octant] ? 1 : 0;
+			}
+		}
+		if (nonEmpty < 2) {
+			continue;
+		}
+
+		Nodes[index].Child = static_cast<unsigned>(Nodes.size());
+		Nodes[index].ChildCount = static_cast<uint8_t>(nonEmpty);
+		for (int octant = 0; octant < 8; ++octant) {
+			if (split[octant + 1] > split[octant]) {
+				TNode child;
+				child.First = split[octant];
+				child.Count = split[octant + 1] - split[octant];
+				Nodes.push_back(child);
+				depths.push_back(depth);
+			}
+		}
+	}
+	Codes.clear();
+	Codes.shrink_to_fit();
+
+	NParallel::For(Nodes.size(), [this](size_t index) {
+		TNode& node = Nodes[index];
+		if (!node.ChildCount) {
+			for (unsigned i = node.First; i < node.First + node.Count; ++i) {
+				node.Bounds.Extend(Items[i]);
+			}
+		}
+	}, 256);
+	for (size_t index = Nodes.size(); index-- > 0;) {
+		TNode& node = Nodes[index];
+		for (unsigned i = 0; i < node.ChildCount; ++i) {
+			node.Bounds.Extend(Nodes[node.Child + i].Bounds);
+		}
+	}
+}
+
+template<typename TId>
+void TOctree<TId>::Emit(const TNode& node, std::vector<TId>& result) const
+{
+	for (unsigned i = node.First; i < node.First + node.Count; ++i) {
+		result.push_back(TId(Order[i]));
+	}
+}
+
+template<typename TId>
+template<typename F>
+void TOctree<TId>::Query(F&& classify, std::vector<TId>& result) const
+{
+	if (Items.empty()) {
+		return;
+	}
+
+	unsigned stack[8 * (MaxDepth + 1)];
+	int top = 0;
+	stack[top++] = 0;
+	while (top) {
+		const TNode& node = Nodes[stack[--top]];
+		const EContainment containment = classify(node.Bounds);
+		if (containment == EContainment::Outside) {
+			continue;
+		}
+		if (containment == EContainment::Inside) {
+			Emit(node, result);
+			continue;
+		}
+
+		if (!node.ChildCount) {
+			for (unsigned i = node.First; i < node.First + node.Count; ++i) {
+				if (classify(Items[i]) != EContainment::Outside) {
+					result.push_back(TId(Order[i]));
+				}
+			}
+			continue;
+		}
+
+		for (int i = node.ChildCount - 1; i >= 0; --i) {
+			stack[top++] = node.Child + i;
+		}
+	}
+}
+
+template<typename TId>
+void TOctree<TId>::QueryBox(const TBox& box, std::vector<TId>& result) const
+{
+	Query([&box](const TBox& bounds) {
+		if (!box.Overlaps(bounds)) {
+			return EContainment::Outside;
+		}
+		return box.Contains(bounds) ? EContainment::Inside : EContainment::Intersect;
+	}, result);
+}
+
+template<typename TId>
+void TOctree<TId>::QuerySphere(const TVectorF& center, float radius, std::vector<TId>& result) const
+{
+	Query([&center, radius](const TBox& bounds) {
+		return ClassifySphere(bounds, center, radius);
+	}, result);
+}
+
+template<typename TId>
+void TOctree<TId>::QueryFrustum(const TFrustum& frustum, std::vector<TId>& result) const
+{
+	Query([&frustum](const TBox& bounds) {
+		return frustum.Classify(bounds);
+	}, result);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace NParallel {
+
+	constexpr size_t DefaultGrain = 4096;
+
+	inline unsigned ThreadCount()
+	{
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// number of contiguous chunks [0, count) is split into, never more than ThreadCount()
+	inline unsigned ChunkCount(size_t count, size_t grain = DefaultGrain)
+	{
+		const size_t byGrain = (count + grain - 1) / std::max<size_t>(grain, 1);
+		return static_cast<unsigned>(std::clamp<size_t>(byGrain, 1, ThreadCount()));
+	}
+
+	// lambda(chunk, begin, end), chunk < ChunkCount(count, grain)
+	template<typename F>
+	void ForChunks(size_t count, F&& lambda, size_t grain = DefaultGrain)
+	{
+		if (count == 0) {
+			return;
+		}
+
+		const unsigned chunks = ChunkCount(count, grain);
+		if (chunks == 1) {
+			lambda(0u, size_t(0), count);
+			return;
+		}
+
+		const size_t step = (count + chunks - 1) / chunks;
+		std::vector<std::thread> threads;
+		threads.reserve(chunks - 1);
+		for (unsigned chunk = 1; chunk < chunks; ++chunk) {
+			const size_t begin = std::min(count, chunk * step);
+			const size_t end = std::min(count, begin + step);
+			threads.emplace_back([&lambda, chunk, begin, end]() {
+				lambda(chunk, begin, end);
+			});
+		}
+		lambda(0u, size_t(0), std::min(count, step));
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	// lambda(index)
+	template<typename F>
+	void For(size_t count, F&& lambda, size_t grain = DefaultGrain)
+	{
+		ForChunks(count, [&lambda](unsigned, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				lambda(i);
+			}
+		}, grain);
+	}
+
+	// replaces values with their exclusive prefix sums, returns the total
+	template<typename T>
+	T ExclusiveScan(std::vector<T>& values)
+	{
+		const unsigned chunks = ChunkCount(values.size());
+		std::vector<T> totals(chunks + 1, T{});
+
+		ForChunks(values.size(), [&values, &totals](unsigned chunk, size_t begin, size_t end) {
+			totals[chunk + 1] = std::accumulate(values.begin() + begin, values.begin() + end, T{});
+		});
+		std::partial_sum(totals.begin(), totals.end(), totals.begin());
+
+		ForChunks(values.size(), [&values, &totals](unsigned chunk, size_t begin, size_t end) {
+			T sum = totals[chunk];
+			for (size_t i = begin; i < end; ++i) {
+				const T value = values[i];
+				values[i] = sum;
+				sum += value;
+			}
+		});
+
+		return totals.back();
+	}
+
+} // namespace NParallel
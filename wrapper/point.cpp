@@ -42,14 +42,18 @@ bool TPointId::operator!=(const TPointId& rhs) const
 	return !(*this == rhs);
 }
 
-TPoint::TPoint(CLxUser_Point& point)
+TPoint::TPoint(CLxUser_Point& point, TMesh* mesh)
 	: Point(point)
+	, Mesh(mesh)
 {
 }
 
 void TPoint::SetMark(TMarkMode mark)
 {
 	Point.SetMarks(mark.Mode);
+	if (Mesh) {
+		Mesh->AddChange(LXf_MESHEDIT_UPDATE);
+	}
 }
 
 bool TPoint::TestMark(TMarkMode mark) const
@@ -103,7 +107,7 @@ TEdge TPoint::Get(CLxUser_Edge* e, unsigned index) const
 	LXtEdgeID id;
 	Point.EdgeByIndex(index, &id);
 	e->Select(id);
-	return TEdge(*e);
+	return TEdge(*e, Mesh);
 }
 
 TPolygon TPoint::Get(CLxUser_Polygon* p, unsigned index) const
@@ -111,7 +115,7 @@ TPolygon TPoint::Get(CLxUser_Polygon* p, unsigned index) const
 	LXtPolygonID id;
 	Point.PolygonByIndex(index, &id);
 	p->Select(id);
-	return TPolygon(*p);
+	return TPolygon(*p, Mesh);
 }
 
 void TPoint::Init(CLxUser_Polygon* polygon)
@@ -149,6 +153,9 @@ void TPoint::Pos(const TVectorF& pos)
 {
 	TVectorD posDouble(pos);
 	Point.SetPos(&posDouble.x);
+	if (Mesh) {
+		Mesh->AddChange(LXf_MESHEDIT_POSITION);
+	}
 }
 
 bool TPoint::Test() const
@@ -157,6 +164,6 @@ bool TPoint::Test() const
 }
 
 TPointHolder::TPointHolder(TMesh& mesh, LXtPointID id)
-    : TPoint(UserPoint_) {
+    : TPoint(UserPoint_, &mesh) {
     UserPoint_ = mesh.GetPoint(id);
 }
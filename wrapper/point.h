@@ -25,13 +25,15 @@ public:
 
 class TEdge;
 class TPolygon;
+class TMesh;
 
 class TPoint
 {
 public:
 	using TUserData = CLxUser_Point;
 
-	explicit TPoint(CLxUser_Point& point);
+	// edits are recorded in mesh when given
+	explicit TPoint(CLxUser_Point& point, TMesh* mesh = nullptr);
 	TPoint(const TPoint& rhs) = delete;
 	TPoint & operator=(const TPoint & rhs) = delete;
 	TPoint(TPoint&& rhs) = delete;
@@ -69,10 +71,9 @@ public:
 
 private:
 	CLxUser_Point& Point;
+	TMesh* Mesh = nullptr;
 };
 
-class TMesh;
-
 class TPointHolder : public TPoint {
 public:
     TPointHolder(TMesh& mesh, LXtPointID id);
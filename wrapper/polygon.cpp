@@ -15,8 +15,9 @@ TPolygonId::operator int() const
 }
 
 
-TPolygon::TPolygon(CLxUser_Polygon& polygon)
+TPolygon::TPolygon(CLxUser_Polygon& polygon, TMesh* mesh)
 	: Polygon(polygon)
+	, Mesh(mesh)
 {
 }
 
@@ -35,6 +36,9 @@ unsigned TPolygon::VertexCount() const
 void TPolygon::SetMark(TMarkMode mark)
 {
 	Polygon.SetMarks(mark.Mode);
+	if (Mesh) {
+		Mesh->AddChange(LXf_MESHEDIT_UPDATE);
+	}
 }
 
 bool TPolygon::TestMark(TMarkMode mark) const
@@ -98,13 +102,13 @@ TPoint TPolygon::Get(CLxUser_Point* p, unsigned index) const
 	LXtPointID id;
 	Polygon.VertexByIndex(index, &id);
 	p->Select(id);
-	return TPoint(*p);
+	return TPoint(*p, Mesh);
 }
 
 TEdge TPolygon::Get(CLxUser_Edge* p, unsigned index) const
 {
 	assert(false);
-	return TEdge(*p);
+	return TEdge(*p, Mesh);
 }
 
 void TPolygon::Init(CLxUser_Point* point)
@@ -149,6 +153,9 @@ void TPolygon::Delete()
 	// log << "TPolygon::Delete(" << ID() << ") = ";
 	auto res = Polygon.Remove();
 	// log << res;
+	if (Mesh) {
+		Mesh->AddChange(LXf_MESHEDIT_POLYGONS);
+	}
 }
 
 bool TPolygon::operator==(const TPolygon& rhs) const
@@ -195,5 +202,5 @@ TEdge TPolygon::TEdgeIterator::operator*()
 {
 	UserData->SelectEndpoints(PrevPointId, PointId);
 
-	return TEdge(*UserData);
+	return TEdge(*UserData, From->Mesh);
 }
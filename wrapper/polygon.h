@@ -10,6 +10,7 @@
 #include <memory>
 
 class TPoint;
+class TMesh;
 // class TEdge;
 
 class TPolygonId
@@ -27,7 +28,8 @@ class TPolygon
 public:
 	using TUserData = CLxUser_Polygon;
 
-	explicit TPolygon(CLxUser_Polygon& polygon);
+	// edits are recorded in mesh when given
+	explicit TPolygon(CLxUser_Polygon& polygon, TMesh* mesh = nullptr);
 	TPolygon(const TPolygon& rhs) = delete;
 	TPolygon& operator=(const TPolygon& rhs) = delete;
 	TPolygon(TPolygon&& rhs) = delete;
@@ -85,6 +87,7 @@ public:
 
 private:
 	CLxUser_Polygon& Polygon;
+	TMesh* Mesh = nullptr;
 
 
 };
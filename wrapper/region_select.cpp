@@ -0,0 +1,292 @@
+#include "region_select.h"
+
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+	constexpr unsigned Block = 64;
+	constexpr size_t CandidateGrain = 1024;
+
+	struct TBoxRegion
+	{
+		const TBox& Box;
+
+		template<typename TId>
+		void Candidates(const TOctree<TId>& tree, std::vector<TId>& result) const
+		{
+			tree.QueryBox(Box, result);
+		}
+
+		void Test(const float* x, const float* y, const float* z, unsigned count, uint8_t* inside) const
+		{
+			for (unsigned i = 0; i < count; ++i) {
+				inside[i] = (x[i] >= Box.Min.x) & (x[i] <= Box.Max.x)
+					& (y[i] >= Box.Min.y) & (y[i] <= Box.Max.y)
+					& (z[i] >= Box.Min.z) & (z[i] <= Box.Max.z);
+			}
+		}
+	};
+
+	struct TOrientedBoxRegion
+	{
+		const TOrientedBox& Box;
+
+		template<typename TId>
+		void Candidates(const TOctree<TId>& tree, std::vector<TId>& result) const
+		{
+			tree.QueryBox(Box.Bounds(), result);
+		}
+
+		void Test(const float* x, const float* y, const float* z, unsigned count, uint8_t* inside) const
+		{
+			const TVectorF c = Box.Center;
+			const TVectorF h = Box.HalfSize;
+			const TVectorF a0 = Box.Axes[0];
+			const TVectorF a1 = Box.Axes[1];
+			const TVectorF a2 = Box.Axes[2];
+			for (unsigned i = 0; i < count; ++i) {
+				const float dx = x[i] - c.x;
+				const float dy = y[i] - c.y;
+				const float dz = z[i] - c.z;
+				const float u = dx * a0.x + dy * a0.y + dz * a0.z;
+				const float v = dx * a1.x + dy * a1.y + dz * a1.z;
+				const float w = dx * a2.x + dy * a2.y + dz * a2.z;
+				inside[i] = (std::abs(u) <= h.x) & (std::abs(v) <= h.y) & (std::abs(w) <= h.z);
+			}
+		}
+	};
+
+	struct TFrustumRegion
+	{
+		const TFrustum& Frustum;
+
+		template<typename TId>
+		void Candidates(const TOctree<TId>& tree, std::vector<TId>& result) const
+		{
+			tree.QueryFrustum(Frustum, result);
+		}
+
+		void Test(const float* x, const float* y, const float* z, unsigned count, uint8_t* inside) const
+		{
+			std::fill(inside, inside + count, uint8_t(1));
+			for (const auto& plane : Frustum.Planes) {
+				for (unsigned i = 0; i < count; ++i) {
+					inside[i] &= plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w >= 0.0f;
+				}
+			}
+		}
+	};
+
+	struct TLassoRegion
+	{
+		explicit TLassoRegion(const TLasso& lasso)
+			: Lasso(lasso)
+		{
+			glm::vec2 min(1.0f, 1.0f);
+			glm::vec2 max(-1.0f, -1.0f);
+			for (const auto& point : Lasso.Points) {
+				min = glm::vec2(std::min(min.x, point.x), std::min(min.y, point.y));
+				max = glm::vec2(std::max(max.x, point.x), std::max(max.y, point.y));
+			}
+			Bounds = TFrustum::FromMatrix(Lasso.ViewProjection, min, max);
+		}
+
+		template<typename TId>
+		void Candidates(const TOctree<TId>& tree, std::vector<TId>& result) const
+		{
+			if (Lasso.Points.size() >= 3) {
+				tree.QueryFrustum(Bounds, result);
+			}
+		}
+
+		void Test(const float* x, const float* y, const float* z, unsigned count, uint8_t* inside) const
+		{
+			const glm::mat4& m = Lasso.ViewProjection;
+			float sx[Block];
+			float sy[Block];
+			for (unsigned i = 0; i < count; ++i) {
+				const float cx = m[0][0] * x[i] + m[1][0] * y[i] + m[2][0] * z[i] + m[3][0];
+				const float cy = m[0][1] * x[i] + m[1][1] * y[i] + m[2][1] * z[i] + m[3][1];
+				const float cw = m[0][3] * x[i] + m[1][3] * y[i] + m[2][3] * z[i] + m[3][3];
+				const float inv = cw > 0.0f ? 1.0f / cw : 0.0f;
+				sx[i] = cx * inv;
+				sy[i] = cy * inv;
+				inside[i] = cw > 0.0f;
+			}
+
+			// even-odd rule, one edge at a time across the whole block
+			uint8_t odd[Block] = {};
+			const auto& points = Lasso.Points;
+			for (size_t e = 0, prev = points.size() - 1; e < points.size(); prev = e++) {
+				const glm::vec2 a = points[prev];
+				const glm::vec2 b = points[e];
+				const float slope = (b.y != a.y) ? (b.x - a.x) / (b.y - a.y) : 0.0f;
+				for (unsigned i = 0; i < count; ++i) {
+					const bool spans = (a.y > sy[i]) != (b.y > sy[i]);
+					const bool left = sx[i] < a.x + (sy[i] - a.y) * slope;
+					odd[i] ^= spans & left;
+				}
+			}
+
+			for (unsigned i = 0; i < count; ++i) {
+				inside[i] &= odd[i];
+			}
+		}
+
+		const TLasso& Lasso;
+		TFrustum Bounds;
+	};
+} // anonymous namespace
+
+TRegionSelect::TRegionSelect(const TMeshSnapshot& snapshot)
+	: Snapshot(snapshot)
+	, PointTree(snapshot.Positions)
+	, PolygonTree(snapshot.PolygonBounds())
+{
+}
+
+template<typename TRegion>
+TBitSet TRegionSelect::SelectPoints(const TRegion& region) const
+{
+	TBitSet result(Snapshot.PointCount());
+
+	std::vector<TPointId> candidates;
+	region.Candidates(PointTree, candidates);
+
+	NParallel::ForChunks(candidates.size(), [&](unsigned, size_t begin, size_t end) {
+		float x[Block];
+		float y[Block];
+		float z[Block];
+		uint8_t inside[Block];
+		for (size_t first = begin; first < end; first += Block) {
+			const unsigned count = static_cast<unsigned>(std::min<size_t>(Block, end - first));
+			for (unsigned i = 0; i < count; ++i) {
+				const TVectorF& pos = Snapshot.Positions[candidates[first + i]];
+				x[i] = pos.x;
+				y[i] = pos.y;
+				z[i] = pos.z;
+			}
+			region.Test(x, y, z, count, inside);
+			for (unsigned i = 0; i < count; ++i) {
+				if (inside[i]) {
+					result.SetAtomic(candidates[first + i]);
+				}
+			}
+		}
+	}, CandidateGrain);
+
+	return result;
+}
+
+template<typename TRegion>
+TBitSet TRegionSelect::SelectPolygons(const TRegion& region, ERule rule) const
+{
+	TBitSet result(Snapshot.PolygonCount());
+
+	std::vector<TPolygonId> candidates;
+	region.Candidates(PolygonTree, candidates);
+
+	NParallel::ForChunks(candidates.size(), [&](unsigned, size_t begin, size_t end) {
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<uint8_t> inside;
+		std::vector<unsigned> start;
+
+		for (size_t first = begin; first < end; first += Block) {
+			const size_t last = std::min(end, first + Block);
+
+			// vertices or centers of the block, flattened
+			x.clear();
+			y.clear();
+			z.clear();
+			start.assign(1, 0);
+			for (size_t c = first; c < last; ++c) {
+				const unsigned polygon = static_cast<int>(candidates[c]);
+				const unsigned vBegin = Snapshot.PolygonStart[polygon];
+				const unsigned vEnd = Snapshot.PolygonStart[polygon + 1];
+				if (rule == ERule::Center) {
+					TVectorF center(0.0f);
+					for (unsigned slot = vBegin; slot < vEnd; ++slot) {
+						center += Snapshot.Positions[Snapshot.PolygonVertices[slot]];
+					}
+					center /= static_cast<float>(std::max(vEnd - vBegin, 1u));
+					x.push_back(center.x);
+					y.push_back(center.y);
+					z.push_back(center.z);
+				}
+				else {
+					for (unsigned slot = vBegin; slot < vEnd; ++slot) {
+						const TVectorF& pos = Snapshot.Positions[Snapshot.PolygonVertices[slot]];
+						x.push_back(pos.x);
+						y.push_back(pos.y);
+						z.push_back(pos.z);
+					}
+				}
+				start.push_back(static_cast<unsigned>(x.size()));
+			}
+
+			inside.resize(x.size());
+			for (size_t i = 0; i < x.size(); i += Block) {
+				const unsigned count = static_cast<unsigned>(std::min<size_t>(Block, x.size() - i));
+				region.Test(x.data() + i, y.data() + i, z.data() + i, count, inside.data() + i);
+			}
+
+			for (size_t c = first; c < last; ++c) {
+				const auto from = inside.begin() + start[c - first];
+				const auto to = inside.begin() + start[c - first + 1];
+				const bool selected = rule == ERule::AllVertices
+					? from != to && std::all_of(from, to, [](uint8_t v) { return v != 0; })
+					: std::any_of(from, to, [](uint8_t v) { return v != 0; });
+				if (selected) {
+					result.SetAtomic(static_cast<int>(candidates[c]));
+				}
+			}
+		}
+	}, CandidateGrain);
+
+	return result;
+}
+
+TBitSet TRegionSelect::Points(const TBox& box) const
+{
+	return SelectPoints(TBoxRegion{ box });
+}
+
+TBitSet TRegionSelect::Points(const TOrientedBox& box) const
+{
+	return SelectPoints(TOrientedBoxRegion{ box });
+}
+
+TBitSet TRegionSelect::Points(const TFrustum& frustum) const
+{
+	return SelectPoints(TFrustumRegion{ frustum });
+}
+
+TBitSet TRegionSelect::Points(const TLasso& lasso) const
+{
+	return SelectPoints(TLassoRegion(lasso));
+}
+
+TBitSet TRegionSelect::Polygons(const TBox& box, ERule rule) const
+{
+	return SelectPolygons(TBoxRegion{ box }, rule);
+}
+
+TBitSet TRegionSelect::Polygons(const TOrientedBox& box, ERule rule) const
+{
+	return SelectPolygons(TOrientedBoxRegion{ box }, rule);
+}
+
+TBitSet TRegionSelect::Polygons(const TFrustum& frustum, ERule rule) const
+{
+	return SelectPolygons(TFrustumRegion{ frustum }, rule);
+}
+
+TBitSet TRegionSelect::Polygons(const TLasso& lasso, ERule rule) const
+{
+	return SelectPolygons(TLassoRegion(lasso), rule);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "bitset.h"
+#include "bounds.h"
+#include "octree.h"
+#include "point.h"
+#include "polygon.h"
+
+#include <vector>
+
+class TMeshSnapshot;
+
+// Screen space lasso, points in normalized device coordinates.
+struct TLasso
+{
+	glm::mat4 ViewProjection;
+	std::vector<glm::vec2> Points;
+};
+
+// Region select over snapshot positions. Candidates come from octrees built
+// once per snapshot, exact tests then run over blocks of candidates laid out
+// as separate x/y/z arrays so the compiler can vectorize them.
+class TRegionSelect
+{
+public:
+	enum class ERule
+	{
+		Center,
+		AnyVertex,
+		AllVertices,
+	};
+
+	explicit TRegionSelect(const TMeshSnapshot& snapshot);
+
+	TBitSet Points(const TBox& box) const;
+	TBitSet Points(const TOrientedBox& box) const;
+	TBitSet Points(const TFrustum& frustum) const;
+	TBitSet Points(const TLasso& lasso) const;
+
+	TBitSet Polygons(const TBox& box, ERule rule = ERule::AnyVertex) const;
+	TBitSet Polygons(const TOrientedBox& box, ERule rule = ERule::AnyVertex) const;
+	TBitSet Polygons(const TFrustum& frustum, ERule rule = ERule::AnyVertex) const;
+	TBitSet Polygons(const TLasso& lasso, ERule rule = ERule::AnyVertex) const;
+
+private:
+	template<typename TRegion>
+	TBitSet SelectPoints(const TRegion& region) const;
+	template<typename TRegion>
+	TBitSet SelectPolygons(const TRegion& region, ERule rule) const;
+
+private:
+	const TMeshSnapshot& Snapshot;
+	TOctree<TPointId> PointTree;
+	TOctree<TPolygonId> PolygonTree;
+};
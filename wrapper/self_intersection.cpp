@@ -0,0 +1,176 @@
+#include "self_intersection.h"
+
+#include "geo_util.h"
+#include "mesh.h"
+#include "parallel.h"
+#include "snapshot.h"
+#include "triangulation.h"
+
+#include <algorithm>
+
+namespace {
+	constexpr size_t TasksPerThread = 32;
+
+	float Extent(const TBox& box)
+	{
+		const TVectorF size = box.Size();
+		return size.x + size.y + size.z;
+	}
+} // anonymous namespace
+
+TSelfIntersection::TSelfIntersection(const TTriangulation& triangulation)
+	: Triangulation(triangulation)
+	, Bvh(triangulation.Bounds())
+{
+	if (Bvh.Empty()) {
+		return;
+	}
+
+	// expand the traversal until there is enough independent work for every thread
+	std::vector<TTask> tasks = { { 0, 0 } };
+	const size_t target = NParallel::ThreadCount() * TasksPerThread;
+	for (bool split = true; split && tasks.size() < target;) {
+		std::vector<TTask> next;
+		for (const auto& task : tasks) {
+			Split(task, next);
+		}
+		split = next.size() != tasks.size();
+		tasks.swap(next);
+	}
+
+	std::vector<std::vector<TIntersection>> chunkResults(NParallel::ChunkCount(tasks.size(), 1));
+	NParallel::ForChunks(tasks.size(), [&](unsigned chunk, size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			Run(tasks[i], chunkResults[chunk]);
+		}
+	}, 1);
+
+	for (const auto& chunk : chunkResults) {
+		IntersectionsValue.insert(IntersectionsValue.end(), chunk.begin(), chunk.end());
+	}
+	std::sort(IntersectionsValue.begin(), IntersectionsValue.end(), [](const TIntersection& a, const TIntersection& b) {
+		return a.TriangleA != b.TriangleA ? a.TriangleA < b.TriangleA : a.TriangleB < b.TriangleB;
+	});
+}
+
+const std::vector<TIntersection>& TSelfIntersection::Intersections() const
+{
+	return IntersectionsValue;
+}
+
+std::vector<unsigned> TSelfIntersection::Polygons() const
+{
+	std::vector<unsigned> polygons;
+	polygons.reserve(IntersectionsValue.size() * 2);
+	for (const auto& intersection : IntersectionsValue) {
+		polygons.push_back(Triangulation.Polygons[intersection.TriangleA]);
+		polygons.push_back(Triangulation.Polygons[intersection.TriangleB]);
+	}
+	std::sort(polygons.begin(), polygons.end());
+	polygons.erase(std::unique(polygons.begin(), polygons.end()), polygons.end());
+	return polygons;
+}
+
+void TSelfIntersection::Mark(TMesh& mesh, TMarkMode mode) const
+{
+	const auto& snapshot = Triangulation.Snapshot;
+	TBitSet polygons(snapshot.PolygonCount());
+	for (const unsigned index : Polygons()) {
+		polygons.Set(index);
+	}
+	snapshot.MarkPolygons(mesh, polygons, mode);
+}
+
+// A == B stands for the node tested against itself
+void TSelfIntersection::Split(const TTask& task, std::vector<TTask>& tasks) const
+{
+	const auto& a = Bvh.Nodes[task.A];
+	const auto& b = Bvh.Nodes[task.B];
+
+	if (task.A == task.B) {
+		if (a.Leaf()) {
+			tasks.push_back(task);
+			return;
+		}
+		const unsigned left = task.A + 1;
+		tasks.push_back({ left, left });
+		tasks.push_back({ a.Right, a.Right });
+		tasks.push_back({ left, a.Right });
+		return;
+	}
+
+	if (!a.Bounds.Overlaps(b.Bounds)) {
+		return;
+	}
+
+	if (a.Leaf() && b.Leaf()) {
+		tasks.push_back(task);
+		return;
+	}
+
+	// descend the larger node
+	if (!a.Leaf() && (b.Leaf() || Extent(a.Bounds) >= Extent(b.Bounds))) {
+		tasks.push_back({ task.A + 1, task.B });
+		tasks.push_back({ a.Right, task.B });
+	}
+	else {
+		tasks.push_back({ task.A, task.B + 1 });
+		tasks.push_back({ task.A, b.Right });
+	}
+}
+
+void TSelfIntersection::Run(const TTask& task, std::vector<TIntersection>& result) const
+{
+	std::vector<TTask> stack = { task };
+	std::vector<TTask> children;
+	while (!stack.empty()) {
+		const TTask current = stack.back();
+		stack.pop_back();
+
+		const auto& a = Bvh.Nodes[current.A];
+		const auto& b = Bvh.Nodes[current.B];
+		if (current.A == current.B ? a.Leaf() : (a.Leaf() && b.Leaf())) {
+			if (a.Bounds.Overlaps(b.Bounds)) {
+				TestLeaves(a, b, result);
+			}
+			continue;
+		}
+
+		children.clear();
+		Split(current, children);
+		stack.insert(stack.end(), children.begin(), children.end());
+	}
+}
+
+void TSelfIntersection::TestLeaves(const TBvh::TNode& a, const TBvh::TNode& b, std::vector<TIntersection>& result) const
+{
+	const bool self = &a == &b;
+	for (unsigned i = a.First; i < a.First + a.Count; ++i) {
+		for (unsigned j = self ? i + 1 : b.First; j < b.First + b.Count; ++j) {
+			TestPair(Bvh.Items[i], Bvh.Items[j], result);
+		}
+	}
+}
+
+void TSelfIntersection::TestPair(unsigned a, unsigned b, std::vector<TIntersection>& result) const
+{
+	const auto& ta = Triangulation.Triangles[a];
+	const auto& tb = Triangulation.Triangles[b];
+	for (const unsigned va : ta) {
+		for (const unsigned vb : tb) {
+			if (va == vb) {
+				return;
+			}
+		}
+	}
+
+	const auto segment = NGeometry::IntersectTriangleTriangle(Triangulation.Corners(a), Triangulation.Corners(b));
+	if (!segment) {
+		return;
+	}
+
+	if (a > b) {
+		std::swap(a, b);
+	}
+	result.push_back({ a, b, (*segment)[0], (*segment)[1] });
+}
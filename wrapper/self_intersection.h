@@ -0,0 +1,50 @@
+#pragma once
+
+#include "bvh.h"
+#include "mark.h"
+#include "vector.h"
+
+#include <vector>
+
+class TMesh;
+class TTriangulation;
+
+struct TIntersection
+{
+	unsigned TriangleA;
+	unsigned TriangleB;
+	TVectorF Start;
+	TVectorF End;
+};
+
+// Finds intersecting triangle pairs by traversing the triangle BVH against
+// itself. Pairs sharing a vertex are adjacent by construction and skipped,
+// which also skips triangles of the same fan.
+class TSelfIntersection
+{
+public:
+	explicit TSelfIntersection(const TTriangulation& triangulation);
+
+	const std::vector<TIntersection>& Intersections() const;
+	// sorted snapshot indices of polygons with at least one intersection
+	std::vector<unsigned> Polygons() const;
+
+	void Mark(TMesh& mesh, TMarkMode mode) const;
+
+private:
+	struct TTask
+	{
+		unsigned A;
+		unsigned B;
+	};
+
+	void Split(const TTask& task, std::vector<TTask>& tasks) const;
+	void Run(const TTask& task, std::vector<TIntersection>& result) const;
+	void TestLeaves(const TBvh::TNode& a, const TBvh::TNode& b, std::vector<TIntersection>& result) const;
+	void TestPair(unsigned a, unsigned b, std::vector<TIntersection>& result) const;
+
+private:
+	const TTriangulation& Triangulation;
+	TBvh Bvh;
+	std::vector<TIntersection> IntersectionsValue;
+};
@@ -0,0 +1,118 @@
+#include "smoothing.h"
+
+#include "parallel.h"
+#include "snapshot.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// keeps obtuse triangles from pulling points outwards
+	constexpr float MinCotangent = 1e-3f;
+
+	float Cotangent(const TVectorF& apex, const TVectorF& a, const TVectorF& b)
+	{
+		const TVectorF u = a - apex;
+		const TVectorF v = b - apex;
+		const float sine = glm::length(glm::cross(u, v));
+		return sine > 0.0f ? glm::dot(u, v) / sine : 0.0f;
+	}
+} // anonymous namespace
+
+TSmoothing::TSmoothing(const TTopology& topology, ESmoothWeights weights)
+	: Topology(topology)
+	, WeightsType(weights)
+{
+}
+
+std::vector<float> TSmoothing::Weights(const std::vector<TVectorF>& positions) const
+{
+	const auto& snapshot = Topology.Snapshot;
+	const auto& vertices = snapshot.PolygonVertices;
+
+	// each polygon side contributes half the cotangent of the angle facing it:
+	// at the third point of triangles, at the centroid of larger polygons
+	std::vector<float> cornerCotangent;
+	if (WeightsType == ESmoothWeights::Cotangent) {
+		cornerCotangent.resize(Topology.CornerCount());
+		NParallel::For(snapshot.PolygonCount(), [&](size_t polygon) {
+			const unsigned begin = snapshot.PolygonStart[polygon];
+			const unsigned end = snapshot.PolygonStart[polygon + 1];
+			TVectorF centroid(0.0f);
+			for (unsigned corner = begin; corner < end; ++corner) {
+				centroid += positions[vertices[corner]];
+			}
+			centroid /= static_cast<float>(std::max(end - begin, 1u));
+
+			for (unsigned corner = begin; corner < end; ++corner) {
+				const unsigned next = Topology.NextCorner(corner);
+				const TVectorF apex = end - begin == 3 ? positions[vertices[Topology.NextCorner(next)]] : centroid;
+				cornerCotangent[corner] = 0.5f * Cotangent(apex, positions[vertices[corner]], positions[vertices[next]]);
+			}
+		}, 1024);
+	}
+
+	std::vector<float> weights(Topology.PointEdges.size());
+	NParallel::For(Topology.PointCount(), [&](size_t point) {
+		const unsigned begin = Topology.PointEdgeStart[point];
+		const unsigned end = Topology.PointEdgeStart[point + 1];
+		float sum = 0.0f;
+		for (unsigned slot = begin; slot < end; ++slot) {
+			float weight = 1.0f;
+			if (WeightsType == ESmoothWeights::Cotangent) {
+				const unsigned edge = Topology.PointEdges[slot];
+				weight = 0.0f;
+				for (unsigned i = Topology.EdgeCornerStart[edge]; i < Topology.EdgeCornerStart[edge + 1]; ++i) {
+					weight += cornerCotangent[Topology.EdgeCorners[i]];
+				}
+				weight = std::max(weight, MinCotangent);
+			}
+			weights[slot] = weight;
+			sum += weight;
+		}
+		for (unsigned slot = begin; slot < end; ++slot) {
+			weights[slot] /= sum;
+		}
+	});
+	return weights;
+}
+
+void TSmoothing::Step(const std::vector<TVectorF>& from, std::vector<TVectorF>& to, const std::vector<float>& weights, float factor, const TBitSet& pinned) const
+{
+	const bool anyPinned = pinned.Size() != 0;
+	NParallel::For(from.size(), [&](size_t point) {
+		const unsigned begin = Topology.PointEdgeStart[point];
+		const unsigned end = Topology.PointEdgeStart[point + 1];
+		if (begin == end || (anyPinned && pinned.Test(static_cast<unsigned>(point)))) {
+			to[point] = from[point];
+			return;
+		}
+
+		TVectorF average(0.0f);
+		for (unsigned slot = begin; slot < end; ++slot) {
+			average += weights[slot] * from[Topology.OtherPoint(Topology.PointEdges[slot], static_cast<unsigned>(point))];
+		}
+		to[point] = from[point] + factor * (average - from[point]);
+	});
+}
+
+void TSmoothing::Smooth(std::vector<TVectorF>& positions, unsigned iterations, float factor, const TBitSet& pinned) const
+{
+	const std::vector<float> weights = Weights(positions);
+	std::vector<TVectorF> buffer(positions.size());
+	for (unsigned iteration = 0; iteration < iterations; ++iteration) {
+		Step(positions, buffer, weights, factor, pinned);
+		positions.swap(buffer);
+	}
+}
+
+void TSmoothing::Taubin(std::vector<TVectorF>& positions, unsigned iterations, float lambda, float mu, const TBitSet& pinned) const
+{
+	const std::vector<float> weights = Weights(positions);
+	std::vector<TVectorF> buffer(positions.size());
+	for (unsigned iteration = 0; iteration < iterations; ++iteration) {
+		Step(positions, buffer, weights, lambda, pinned);
+		Step(buffer, positions, weights, mu, pinned);
+	}
+}
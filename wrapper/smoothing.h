@@ -0,0 +1,42 @@
+#pragma once
+
+#include "bitset.h"
+#include "vector.h"
+
+#include <vector>
+
+class TTopology;
+
+enum class ESmoothWeights
+{
+	Uniform,
+	Cotangent,
+};
+
+// Laplacian smoothing over topology adjacency. Iterations are Jacobi steps
+// between two position buffers, so every point of a step reads the previous
+// step only and all points are updated in parallel. Pinned points, usually
+// the locked ones or those outside the region, keep their position; an empty
+// set pins nothing. Cotangent weights are taken from the positions passed in
+// and kept for all iterations. Results are written back with
+// TMeshSnapshot::SetPositions.
+class TSmoothing
+{
+public:
+	explicit TSmoothing(const TTopology& topology, ESmoothWeights weights = ESmoothWeights::Uniform);
+
+	// factor in [0, 1] moves points towards the weighted average of their neighbours
+	void Smooth(std::vector<TVectorF>& positions, unsigned iterations, float factor = 0.5f, const TBitSet& pinned = TBitSet()) const;
+	// alternating lambda and mu steps, shrinks much less than Smooth
+	void Taubin(std::vector<TVectorF>& positions, unsigned iterations, float lambda = 0.5f, float mu = -0.53f, const TBitSet& pinned = TBitSet()) const;
+
+private:
+	// per PointEdges slot, normalized per point
+	std::vector<float> Weights(const std::vector<TVectorF>& positions) const;
+
+	void Step(const std::vector<TVectorF>& from, std::vector<TVectorF>& to, const std::vector<float>& weights, float factor, const TBitSet& pinned) const;
+
+private:
+	const TTopology& Topology;
+	const ESmoothWeights WeightsType;
+};
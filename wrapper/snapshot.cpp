@@ -0,0 +1,139 @@
+#include "snapshot.h"
+
+#include "mesh.h"
+#include "parallel.h"
+#include "point.h"
+#include "polygon.h"
+
+#include <algorithm>
+
+TMeshSnapshot::TMeshSnapshot(TMesh& mesh)
+{
+	const unsigned pointCount = mesh.PointCount();
+	PointIds.resize(pointCount);
+	Positions.resize(pointCount);
+
+	mesh.EachPoint([this](TPoint& point) {
+		const unsigned index = point.Index();
+		PointIds[index] = point.ID();
+		Positions[index] = point.Pos();
+	});
+
+	const unsigned polygonCount = mesh.PolygonCount();
+	PolygonIds.resize(polygonCount);
+	PolygonStart.assign(polygonCount + 1, 0);
+
+	// enumeration order is not guaranteed to be index order
+	std::vector<unsigned> order;
+	std::vector<unsigned> vertices;
+	order.reserve(polygonCount);
+	mesh.EachPolygon([&](TPolygon& polygon) {
+		const unsigned index = polygon.Index();
+		PolygonIds[index] = polygon.ID();
+		PolygonStart[index] = polygon.VertexCount();
+		order.push_back(index);
+		for (auto point : polygon.Vertexes()) {
+			vertices.push_back(point.Index());
+		}
+	});
+
+	unsigned total = 0;
+	for (unsigned polygon = 0; polygon <= polygonCount; ++polygon) {
+		const unsigned count = PolygonStart[polygon];
+		PolygonStart[polygon] = total;
+		total += count;
+	}
+
+	PolygonVertices.resize(vertices.size());
+	auto source = vertices.begin();
+	for (const unsigned polygon : order) {
+		const auto count = VertexCount(polygon);
+		std::copy(source, source + count, PolygonVertices.begin() + PolygonStart[polygon]);
+		source += count;
+	}
+}
+
+unsigned TMeshSnapshot::PointCount() const
+{
+	return static_cast<unsigned>(Positions.size());
+}
+
+unsigned TMeshSnapshot::PolygonCount() const
+{
+	return static_cast<unsigned>(PolygonIds.size());
+}
+
+unsigned TMeshSnapshot::VertexCount(unsigned polygon) const
+{
+	return PolygonStart[polygon + 1] - PolygonStart[polygon];
+}
+
+std::vector<TBox> TMeshSnapshot::PolygonBounds() const
+{
+	std::vector<TBox> bounds(PolygonCount());
+	NParallel::For(bounds.size(), [&](size_t polygon) {
+		for (unsigned slot = PolygonStart[polygon]; slot < PolygonStart[polygon + 1]; ++slot) {
+			bounds[polygon].Extend(Positions[PolygonVertices[slot]]);
+		}
+	});
+	return bounds;
+}
+
+void TMeshSnapshot::MarkPoints(TMesh& mesh, const TBitSet& points, TMarkMode mode) const
+{
+	auto point = mesh.InitPoint();
+	points.ForEach([&](unsigned index) {
+		point.Select(PointIds[index]);
+		point.SetMarks(mode.Mode);
+	});
+	mesh.AddChange(LXf_MESHEDIT_UPDATE);
+}
+
+void TMeshSnapshot::MarkPolygons(TMesh& mesh, const TBitSet& polygons, TMarkMode mode) const
+{
+	auto polygon = mesh.InitPolygon();
+	polygons.ForEach([&](unsigned index) {
+		polygon.Select(PolygonIds[index]);
+		polygon.SetMarks(mode.Mode);
+	});
+	mesh.AddChange(LXf_MESHEDIT_UPDATE);
+}
+
+TBitSet TMeshSnapshot::MarkedPoints(TMesh& mesh, TMarkMode mode) const
+{
+	TBitSet points(PointCount());
+	mesh.EachPoint([&points](TPoint& point) {
+		points.Set(point.Index());
+	}, mode);
+	return points;
+}
+
+TBitSet TMeshSnapshot::MarkedPolygons(TMesh& mesh, TMarkMode mode) const
+{
+	TBitSet polygons(PolygonCount());
+	mesh.EachPolygon([&polygons](TPolygon& polygon) {
+		polygons.Set(polygon.Index());
+	}, mode);
+	return polygons;
+}
+
+void TMeshSnapshot::SetPositions(TMesh& mesh, const std::vector<TVectorF>& positions) const
+{
+	TBitSet changed(PointCount());
+	NParallel::For(PointCount(), [&](size_t index) {
+		if (positions[index] != Positions[index]) {
+			changed.SetAtomic(static_cast<unsigned>(index));
+		}
+	});
+	if (!changed.Count()) {
+		return;
+	}
+
+	auto point = mesh.InitPoint();
+	changed.ForEach([&](unsigned index) {
+		const TVectorD pos(positions[index]);
+		point.Select(PointIds[index]);
+		point.SetPos(&pos.x);
+	});
+	mesh.AddChange(LXf_MESHEDIT_POSITION);
+}
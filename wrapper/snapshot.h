@@ -0,0 +1,44 @@
+#pragma once
+
+#include <lx_mesh.hpp>
+
+#include "bitset.h"
+#include "bounds.h"
+#include "mark.h"
+#include "vector.h"
+
+#include <vector>
+
+class TMesh;
+
+// Flat copy of the host mesh, indexed by host point and polygon index.
+// Vertices of polygon p are PolygonVertices[PolygonStart[p] .. PolygonStart[p + 1]).
+class TMeshSnapshot
+{
+public:
+	// empty, for meshes built locally
+	TMeshSnapshot() = default;
+	explicit TMeshSnapshot(TMesh& mesh);
+
+	unsigned PointCount() const;
+	unsigned PolygonCount() const;
+	unsigned VertexCount(unsigned polygon) const;
+
+	std::vector<TBox> PolygonBounds() const;
+
+	void MarkPoints(TMesh& mesh, const TBitSet& points, TMarkMode mode) const;
+	void MarkPolygons(TMesh& mesh, const TBitSet& polygons, TMarkMode mode) const;
+	TBitSet MarkedPoints(TMesh& mesh, TMarkMode mode) const;
+	TBitSet MarkedPolygons(TMesh& mesh, TMarkMode mode) const;
+
+	// writes the positions that differ from the snapshot, in one pass
+	void SetPositions(TMesh& mesh, const std::vector<TVectorF>& positions) const;
+
+public:
+	std::vector<LXtPointID> PointIds;
+	std::vector<TVectorF> Positions;
+
+	std::vector<LXtPolygonID> PolygonIds;
+	std::vector<unsigned> PolygonStart;
+	std::vector<unsigned> PolygonVertices;
+};
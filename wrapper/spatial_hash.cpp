@@ -0,0 +1,345 @@
+#include "spatial_hash.h"
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+namespace {
+	constexpr size_t BatchGrain = 256;
+	// a million cells across the farthest coordinate, well inside int range
+	constexpr float MinRelativeCellSize = 1e-6f;
+	constexpr float MaxCellCoordinate = 1 << 30;
+
+	int CellCoordinate(float value)
+	{
+		return static_cast<int>(std::clamp(std::floor(value), -MaxCellCoordinate, MaxCellCoordinate));
+	}
+
+	using TCandidate = std::pair<float, unsigned>;
+
+	void PushCandidate(std::vector<TCandidate>& heap, unsigned k, float dist2, unsigned index)
+	{
+		const TCandidate candidate(dist2, index);
+		if (heap.size() < k) {
+			heap.push_back(candidate);
+			std::push_heap(heap.begin(), heap.end());
+		}
+		else if (candidate < heap.front()) {
+			std::pop_heap(heap.begin(), heap.end());
+			heap.back() = candidate;
+			std::push_heap(heap.begin(), heap.end());
+		}
+	}
+} // anonymous namespace
+
+TSpatialHash::TSpatialHash(const std::vector<TVectorF>& positions, float cellSize)
+	: Positions(positions)
+{
+	const size_t count = Positions.size();
+
+	// tiny cells overflow the integer coordinates and put every point in one cell
+	float maxAbs = 0.0f;
+	for (const auto& pos : Positions) {
+		maxAbs = std::max(maxAbs, std::max(std::abs(pos.x), std::max(std::abs(pos.y), std::abs(pos.z))));
+	}
+	const float minCellSize = std::max(maxAbs * MinRelativeCellSize, std::numeric_limits<float>::min());
+	CellSizeValue = cellSize > 0.0f ? std::max(cellSize, minCellSize) : 1.0f;
+	InvCellSize = 1.0f / CellSizeValue;
+
+	const size_t tableSize = std::bit_ceil(std::max<size_t>(count, 1));
+	Mask = static_cast<unsigned>(tableSize - 1);
+
+	std::vector<unsigned> buckets(count);
+	BucketStart.assign(tableSize + 1, 0);
+
+	const unsigned chunks = NParallel::ChunkCount(count);
+	std::vector<TCell> chunkMin(chunks, CellOf(count ? Positions[0] : TVectorF(0, 0, 0)));
+	std::vector<TCell> chunkMax(chunkMin);
+
+	NParallel::ForChunks(count, [&](unsigned chunk, size_t begin, size_t end) {
+		TCell& lo = chunkMin[chunk];
+		TCell& hi = chunkMax[chunk];
+		for (size_t i = begin; i < end; ++i) {
+			const TCell cell = CellOf(Positions[i]);
+			for (int axis = 0; axis < 3; ++axis) {
+				lo[axis] = std::min(lo[axis], cell[axis]);
+				hi[axis] = std::max(hi[axis], cell[axis]);
+			}
+			buckets[i] = Bucket(cell);
+			std::atomic_ref<unsigned>(BucketStart[buckets[i]]).fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	MinCell = chunkMin[0];
+	MaxCell = chunkMax[0];
+	for (unsigned chunk = 1; chunk < chunks; ++chunk) {
+		for (int axis = 0; axis < 3; ++axis) {
+			MinCell[axis] = std::min(MinCell[axis], chunkMin[chunk][axis]);
+			MaxCell[axis] = std::max(MaxCell[axis], chunkMax[chunk][axis]);
+		}
+	}
+
+	NParallel::ExclusiveScan(BucketStart);
+
+	std::vector<unsigned> cursor(BucketStart.begin(), BucketStart.end() - 1);
+	Sorted.resize(count);
+	NParallel::For(count, [&](size_t i) {
+		const unsigned slot = std::atomic_ref<unsigned>(cursor[buckets[i]]).fetch_add(1, std::memory_order_relaxed);
+		Sorted[slot] = static_cast<unsigned>(i);
+	});
+
+	// scatter order is racy, keep buckets deterministic
+	NParallel::For(tableSize, [this](size_t bucket) {
+		const auto begin = Sorted.begin() + BucketStart[bucket];
+		const auto end = Sorted.begin() + BucketStart[bucket + 1];
+		if (end - begin > 1) {
+			std::sort(begin, end);
+		}
+	});
+}
+
+float TSpatialHash::SuggestCellSize(const std::vector<TVectorF>& positions)
+{
+	if (positions.empty()) {
+		return 1.0f;
+	}
+
+	TVectorF lo = positions[0];
+	TVectorF hi = positions[0];
+	for (const auto& pos : positions) {
+		lo = glm::min(lo, pos);
+		hi = glm::max(hi, pos);
+	}
+
+	const TVectorF extent = hi - lo;
+	const float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+	if (maxExtent <= 0.0f) {
+		return 1.0f;
+	}
+
+	// flat and linear meshes would otherwise get huge cells
+	const float minExtent = maxExtent / std::cbrt(static_cast<float>(positions.size()));
+	const float volume = std::max(extent.x, minExtent) * std::max(extent.y, minExtent) * std::max(extent.z, minExtent);
+	return std::cbrt(volume / positions.size());
+}
+
+float TSpatialHash::CellSize() const
+{
+	return CellSizeValue;
+}
+
+unsigned TSpatialHash::Count() const
+{
+	return static_cast<unsigned>(Sorted.size());
+}
+
+TSpatialHash::TCell TSpatialHash::CellOf(const TVectorF& pos) const
+{
+	return {
+		CellCoordinate(pos.x * InvCellSize),
+		CellCoordinate(pos.y * InvCellSize),
+		CellCoordinate(pos.z * InvCellSize),
+	};
+}
+
+unsigned TSpatialHash::Bucket(const TCell& cell) const
+{
+	const unsigned hash =
+		(static_cast<unsigned>(cell[0]) * 73856093u) ^
+		(static_cast<unsigned>(cell[1]) * 19349663u) ^
+		(static_cast<unsigned>(cell[2]) * 83492791u);
+	return hash & Mask;
+}
+
+bool TSpatialHash::Occupied(const TCell& cell) const
+{
+	for (int axis = 0; axis < 3; ++axis) {
+		if (cell[axis] < MinCell[axis] || cell[axis] > MaxCell[axis]) {
+			return false;
+		}
+	}
+	return !Sorted.empty();
+}
+
+template<typename F>
+void TSpatialHash::VisitCell(const TCell& cell, F&& lambda) const
+{
+	if (!Occupied(cell)) {
+		return;
+	}
+
+	const unsigned bucket = Bucket(cell);
+	for (unsigned slot = BucketStart[bucket]; slot < BucketStart[bucket + 1]; ++slot) {
+		const unsigned index = Sorted[slot];
+		// buckets are shared by colliding cells
+		if (CellOf(Positions[index]) == cell) {
+			lambda(index);
+		}
+	}
+}
+
+void TSpatialHash::Radius(const TVectorF& pos, float radius, std::vector<unsigned>& result) const
+{
+	if (Sorted.empty() || radius < 0.0f) {
+		return;
+	}
+
+	const size_t first = result.size();
+	const float radius2 = radius * radius;
+	auto test = [&](unsigned index) {
+		const TVectorF d = Positions[index] - pos;
+		if (dot(d, d) <= radius2) {
+			result.push_back(index);
+		}
+	};
+
+	TCell lo = CellOf(pos - TVectorF(radius, radius, radius));
+	TCell hi = CellOf(pos + TVectorF(radius, radius, radius));
+	double cells = 1.0;
+	for (int axis = 0; axis < 3; ++axis) {
+		lo[axis] = std::max(lo[axis], MinCell[axis]);
+		hi[axis] = std::min(hi[axis], MaxCell[axis]);
+		if (lo[axis] > hi[axis]) {
+			return;
+		}
+		cells *= static_cast<double>(hi[axis] - lo[axis]) + 1.0;
+	}
+
+	if (cells > Sorted.size()) {
+		for (unsigned index = 0; index < Sorted.size(); ++index) {
+			test(index);
+		}
+		return;
+	}
+
+	TCell cell;
+	for (cell[0] = lo[0]; cell[0] <= hi[0]; ++cell[0]) {
+		for (cell[1] = lo[1]; cell[1] <= hi[1]; ++cell[1]) {
+			for (cell[2] = lo[2]; cell[2] <= hi[2]; ++cell[2]) {
+				VisitCell(cell, test);
+			}
+		}
+	}
+
+	std::sort(result.begin() + first, result.end());
+}
+
+void TSpatialHash::Nearest(const TVectorF& pos, unsigned k, std::vector<unsigned>& result, float maxDistance) const
+{
+	if (Sorted.empty() || k == 0) {
+		return;
+	}
+
+	// the default distance squares to infinity
+	const float maxDist2 = maxDistance * maxDistance;
+	std::vector<TCandidate> heap;
+	heap.reserve(k);
+	auto test = [&](unsigned index) {
+		const TVectorF d = Positions[index] - pos;
+		const float dist2 = dot(d, d);
+		if (dist2 <= maxDist2) {
+			PushCandidate(heap, k, dist2, index);
+		}
+	};
+
+	const TCell center = CellOf(pos);
+	// rings closer than the occupied cells are empty
+	int minRing = 0;
+	int maxRing = 0;
+	for (int axis = 0; axis < 3; ++axis) {
+		minRing = std::max({minRing, MinCell[axis] - center[axis], center[axis] - MaxCell[axis]});
+		maxRing = std::max(maxRing, std::abs(center[axis] - MinCell[axis]));
+		maxRing = std::max(maxRing, std::abs(MaxCell[axis] - center[axis]));
+	}
+	// cells of ring r are at least r - 1 cells away
+	if (maxDistance < maxRing * CellSizeValue) {
+		maxRing = static_cast<int>(maxDistance * InvCellSize) + 1;
+	}
+
+	for (int ring = minRing; ring <= maxRing; ++ring) {
+		TCell cell;
+		const int xLow = std::max(-ring, MinCell[0] - center[0]);
+		const int xHigh = std::min(ring, MaxCell[0] - center[0]);
+		const int yLow = std::max(-ring, MinCell[1] - center[1]);
+		const int yHigh = std::min(ring, MaxCell[1] - center[1]);
+		for (int dx = xLow; dx <= xHigh; ++dx) {
+			cell[0] = center[0] + dx;
+			for (int dy = yLow; dy <= yHigh; ++dy) {
+				cell[1] = center[1] + dy;
+				// inner cells were visited by previous rings
+				const bool shell = std::abs(dx) == ring || std::abs(dy) == ring;
+				const int step = shell ? 1 : std::max(2 * ring, 1);
+				for (int dz = -ring; dz <= ring; dz += step) {
+					cell[2] = center[2] + dz;
+					VisitCell(cell, test);
+				}
+			}
+		}
+
+		// anything beyond this ring is at least ring cells away
+		const float reach = ring * CellSizeValue;
+		if (heap.size() == k && heap.front().first < reach * reach) {
+			break;
+		}
+	}
+
+	std::sort_heap(heap.begin(), heap.end());
+	for (const auto& candidate : heap) {
+		result.push_back(candidate.second);
+	}
+}
+
+std::optional<unsigned> TSpatialHash::Nearest(const TVectorF& pos, float maxDistance) const
+{
+	std::vector<unsigned> result;
+	Nearest(pos, 1, result, maxDistance);
+	if (result.empty()) {
+		return {};
+	}
+	return result[0];
+}
+
+TSpatialHash::TNeighbours TSpatialHash::BatchRadius(const std::vector<TVectorF>& queries, float radius) const
+{
+	TNeighbours neighbours;
+	neighbours.Offsets.assign(queries.size() + 1, 0);
+
+	std::vector<std::vector<unsigned>> chunkIndices(NParallel::ChunkCount(queries.size(), BatchGrain));
+	NParallel::ForChunks(queries.size(), [&](unsigned chunk, size_t begin, size_t end) {
+		auto& local = chunkIndices[chunk];
+		for (size_t i = begin; i < end; ++i) {
+			const size_t before = local.size();
+			Radius(queries[i], radius, local);
+			neighbours.Offsets[i] = static_cast<unsigned>(local.size() - before);
+		}
+	}, BatchGrain);
+
+	neighbours.Indices.resize(NParallel::ExclusiveScan(neighbours.Offsets));
+
+	NParallel::ForChunks(queries.size(), [&](unsigned chunk, size_t begin, size_t) {
+		std::copy(chunkIndices[chunk].begin(), chunkIndices[chunk].end(), neighbours.Indices.begin() + neighbours.Offsets[begin]);
+	}, BatchGrain);
+
+	return neighbours;
+}
+
+std::vector<unsigned> TSpatialHash::BatchNearest(const std::vector<TVectorF>& queries, unsigned k) const
+{
+	std::vector<unsigned> result(queries.size() * k, Invalid);
+
+	NParallel::ForChunks(queries.size(), [&](unsigned, size_t begin, size_t end) {
+		std::vector<unsigned> local;
+		local.reserve(k);
+		for (size_t i = begin; i < end; ++i) {
+			local.clear();
+			Nearest(queries[i], k, local);
+			std::copy(local.begin(), local.end(), result.begin() + i * k);
+		}
+	}, BatchGrain);
+
+	return result;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "vector.h"
+
+#include <array>
+#include <limits>
+#include <optional>
+#include <vector>
+
+// Uniform grid over point positions. Cells are hashed into a table with
+// one bucket per point and points are counting-sorted by bucket, so the
+// grid costs two integers per point whatever the extent of the mesh.
+// Positions are referenced, not copied, and must outlive the grid.
+class TSpatialHash
+{
+public:
+	static constexpr unsigned Invalid = std::numeric_limits<unsigned>::max();
+
+	// neighbours of query i are Indices[Offsets[i] .. Offsets[i + 1])
+	struct TNeighbours
+	{
+		std::vector<unsigned> Offsets;
+		std::vector<unsigned> Indices;
+	};
+
+	// cellSize is raised to a millionth of the largest coordinate
+	TSpatialHash(const std::vector<TVectorF>& positions, float cellSize);
+	TSpatialHash(const TSpatialHash& rhs) = delete;
+	TSpatialHash& operator=(const TSpatialHash& rhs) = delete;
+
+	static float SuggestCellSize(const std::vector<TVectorF>& positions);
+
+	float CellSize() const;
+	unsigned Count() const;
+
+	// appends points within radius of pos in ascending index order
+	void Radius(const TVectorF& pos, float radius, std::vector<unsigned>& result) const;
+	// appends up to k points nearest to pos and within maxDistance, closest first
+	void Nearest(const TVectorF& pos, unsigned k, std::vector<unsigned>& result, float maxDistance = std::numeric_limits<float>::max()) const;
+	std::optional<unsigned> Nearest(const TVectorF& pos, float maxDistance = std::numeric_limits<float>::max()) const;
+
+	TNeighbours BatchRadius(const std::vector<TVectorF>& queries, float radius) const;
+	// k entries per query, padded with Invalid
+	std::vector<unsigned> BatchNearest(const std::vector<TVectorF>& queries, unsigned k) const;
+
+private:
+	using TCell = std::array<int, 3>;
+
+	TCell CellOf(const TVectorF& pos) const;
+	unsigned Bucket(const TCell& cell) const;
+	bool Occupied(const TCell& cell) const;
+
+	template<typename F>
+	void VisitCell(const TCell& cell, F&& lambda) const;
+
+private:
+	const std::vector<TVectorF>& Positions;
+	float CellSizeValue = 1.0f;
+	float InvCellSize = 1.0f;
+	unsigned Mask = 0;
+	std::vector<unsigned> BucketStart;
+	std::vector<unsigned> Sorted;
+	TCell MinCell{};
+	TCell MaxCell{};
+};
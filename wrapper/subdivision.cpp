@@ -0,0 +1,335 @@
+#include "subdivision.h"
+
+#include "edge.h"
+#include "mesh.h"
+#include "parallel.h"
+#include "point.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+namespace {
+	constexpr size_t RowGrain = 1024;
+
+	using TRow = std::vector<std::pair<unsigned, float>>;
+
+	// row(index, entries) fills a row, duplicate columns are summed
+	template<typename F>
+	TSubdivision::TStencils BuildRows(unsigned rowCount, F&& row)
+	{
+		TSubdivision::TStencils stencils;
+		stencils.Start.assign(rowCount + 1, 0);
+
+		const unsigned chunks = NParallel::ChunkCount(rowCount, RowGrain);
+		std::vector<std::vector<unsigned>> chunkColumns(chunks);
+		std::vector<std::vector<float>> chunkWeights(chunks);
+		NParallel::ForChunks(rowCount, [&](unsigned chunk, size_t begin, size_t end) {
+			TRow entries;
+			for (size_t index = begin; index < end; ++index) {
+				entries.clear();
+				row(static_cast<unsigned>(index), entries);
+				std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+					return a.first < b.first;
+				});
+				const size_t before = chunkColumns[chunk].size();
+				for (size_t i = 0; i < entries.size(); ++i) {
+					if (i && entries[i].first == entries[i - 1].first) {
+						chunkWeights[chunk].back() += entries[i].second;
+						continue;
+					}
+					chunkColumns[chunk].push_back(entries[i].first);
+					chunkWeights[chunk].push_back(entries[i].second);
+				}
+				stencils.Start[index] = static_cast<unsigned>(chunkColumns[chunk].size() - before);
+			}
+		}, RowGrain);
+
+		const unsigned total = NParallel::ExclusiveScan(stencils.Start);
+		stencils.Columns.resize(total);
+		stencils.Weights.resize(total);
+		NParallel::ForChunks(rowCount, [&](unsigned chunk, size_t begin, size_t) {
+			std::copy(chunkColumns[chunk].begin(), chunkColumns[chunk].end(), stencils.Columns.begin() + stencils.Start[begin]);
+			std::copy(chunkWeights[chunk].begin(), chunkWeights[chunk].end(), stencils.Weights.begin() + stencils.Start[begin]);
+		}, RowGrain);
+		return stencils;
+	}
+
+	// one refinement step: vertex points keep their index, edge points
+	// follow at PointCount + edge and face points at PointCount + EdgeCount + polygon
+	class TRefinement
+	{
+	public:
+		TRefinement(const TTopology& topology, const TBitSet& creases)
+			: Topology(topology)
+			, Creases(creases)
+		{
+		}
+
+		unsigned Rows() const
+		{
+			return Topology.PointCount() + Topology.EdgeCount() + Topology.PolygonCount();
+		}
+
+		void Row(unsigned row, TRow& entries) const
+		{
+			const unsigned pointCount = Topology.PointCount();
+			const unsigned edgeCount = Topology.EdgeCount();
+			if (row < pointCount) {
+				VertexRow(row, entries);
+			}
+			else if (row < pointCount + edgeCount) {
+				EdgeRow(row - pointCount, entries);
+			}
+			else {
+				FaceRow(row - pointCount - edgeCount, 1.0f, entries);
+			}
+		}
+
+		// quads of the next level, four per corner
+		void Refine(TMeshSnapshot& next) const
+		{
+			const unsigned pointCount = Topology.PointCount();
+			const unsigned edgeCount = Topology.EdgeCount();
+			const unsigned cornerCount = Topology.CornerCount();
+			const auto& vertices = Topology.Snapshot.PolygonVertices;
+
+			next.Positions.resize(Rows());
+			next.PointIds.resize(Rows());
+			next.PolygonIds.resize(cornerCount);
+			next.PolygonStart.resize(cornerCount + 1);
+			next.PolygonVertices.resize(4 * size_t(cornerCount));
+			NParallel::For(cornerCount, [&](size_t corner) {
+				const unsigned prev = Topology.PrevCorner(static_cast<unsigned>(corner));
+				const unsigned point = vertices[corner];
+				// repeated points give degenerate quads
+				auto edgePoint = [&](unsigned c) {
+					return Topology.CornerEdge[c] == TTopology::Invalid ? point : pointCount + Topology.CornerEdge[c];
+				};
+				unsigned* quad = &next.PolygonVertices[4 * corner];
+				quad[0] = point;
+				quad[1] = edgePoint(static_cast<unsigned>(corner));
+				quad[2] = pointCount + edgeCount + Topology.CornerPolygon[corner];
+				quad[3] = edgePoint(prev);
+				next.PolygonStart[corner] = static_cast<unsigned>(4 * corner);
+			});
+			next.PolygonStart[cornerCount] = 4 * cornerCount;
+		}
+
+		// halves of crease edges stay creased
+		TBitSet RefineCreases(const TTopology& next) const
+		{
+			const unsigned pointCount = Topology.PointCount();
+			TBitSet result(next.EdgeCount());
+			Creases.ForEach([&](unsigned edge) {
+				const unsigned mid = pointCount + edge;
+				for (unsigned end = 0; end < 2; ++end) {
+					const unsigned half = next.FindEdge(Topology.Edges[edge][end], mid);
+					if (half != TTopology::Invalid) {
+						result.Set(half);
+					}
+				}
+			});
+			return result;
+		}
+
+	private:
+		bool IsSharp(unsigned edge) const
+		{
+			return Topology.EdgePolygonCount(edge) != 2 || Creases.Test(edge);
+		}
+
+		void FaceRow(unsigned polygon, float weight, TRow& entries) const
+		{
+			const auto& snapshot = Topology.Snapshot;
+			const unsigned begin = snapshot.PolygonStart[polygon];
+			const unsigned end = snapshot.PolygonStart[polygon + 1];
+			const float share = weight / static_cast<float>(end - begin);
+			for (unsigned corner = begin; corner < end; ++corner) {
+				entries.emplace_back(snapshot.PolygonVertices[corner], share);
+			}
+		}
+
+		void EdgeRow(unsigned edge, TRow& entries) const
+		{
+			const auto& points = Topology.Edges[edge];
+			if (IsSharp(edge)) {
+				entries.emplace_back(points[0], 0.5f);
+				entries.emplace_back(points[1], 0.5f);
+				return;
+			}
+
+			entries.emplace_back(points[0], 0.25f);
+			entries.emplace_back(points[1], 0.25f);
+			for (unsigned slot = Topology.EdgeCornerStart[edge]; slot < Topology.EdgeCornerStart[edge + 1]; ++slot) {
+				FaceRow(Topology.CornerPolygon[Topology.EdgeCorners[slot]], 0.25f, entries);
+			}
+		}
+
+		void VertexRow(unsigned point, TRow& entries) const
+		{
+			const unsigned edgeBegin = Topology.PointEdgeStart[point];
+			const unsigned edgeEnd = Topology.PointEdgeStart[point + 1];
+			const unsigned valence = edgeEnd - edgeBegin;
+			const unsigned corners = Topology.PointCornerStart[point + 1] - Topology.PointCornerStart[point];
+
+			unsigned sharp = 0;
+			std::array<unsigned, 2> sharpEnds{};
+			for (unsigned slot = edgeBegin; slot < edgeEnd; ++slot) {
+				const unsigned edge = Topology.PointEdges[slot];
+				if (IsSharp(edge)) {
+					if (sharp < 2) {
+						sharpEnds[sharp] = Topology.OtherPoint(edge, point);
+					}
+					++sharp;
+				}
+			}
+
+			// darts are smooth, a closed fan has as many corners as edges
+			if (valence && sharp <= 1 && corners == valence) {
+				const float n = static_cast<float>(valence);
+				const float share = 1.0f / (n * n);
+				entries.emplace_back(point, (n - 2.0f) / n);
+				for (unsigned slot = edgeBegin; slot < edgeEnd; ++slot) {
+					entries.emplace_back(Topology.OtherPoint(Topology.PointEdges[slot], point), share);
+				}
+				for (unsigned slot = Topology.PointCornerStart[point]; slot < Topology.PointCornerStart[point + 1]; ++slot) {
+					FaceRow(Topology.CornerPolygon[Topology.PointCorners[slot]], share, entries);
+				}
+				return;
+			}
+
+			if (sharp == 2) {
+				entries.emplace_back(point, 0.75f);
+				entries.emplace_back(sharpEnds[0], 0.125f);
+				entries.emplace_back(sharpEnds[1], 0.125f);
+				return;
+			}
+
+			// corners, non-manifold fans and isolated points
+			entries.emplace_back(point, 1.0f);
+		}
+
+	private:
+		const TTopology& Topology;
+		const TBitSet& Creases;
+	};
+} // anonymous namespace
+
+unsigned TSubdivision::TStencils::Rows() const
+{
+	return Start.empty() ? 0 : static_cast<unsigned>(Start.size() - 1);
+}
+
+TSubdivision::TSubdivision(const TTopology& topology, unsigned level, const TBitSet& creases)
+	: Topology(topology)
+{
+	level = std::clamp(level, 1u, MaxLevel);
+
+	std::unique_ptr<TMeshSnapshot> snapshot;
+	std::unique_ptr<TTopology> refined;
+	const TTopology* current = &Topology;
+	TBitSet currentCreases = creases.Size() == Topology.EdgeCount() ? creases : TBitSet(Topology.EdgeCount());
+	std::vector<unsigned> origin(Topology.PolygonCount());
+	for (unsigned polygon = 0; polygon < origin.size(); ++polygon) {
+		origin[polygon] = polygon;
+	}
+
+	for (unsigned step = 0; step < level; ++step) {
+		const TRefinement refinement(*current, currentCreases);
+		if (!step) {
+			StencilsValue = BuildRows(refinement.Rows(), [&refinement](unsigned row, TRow& entries) {
+				refinement.Row(row, entries);
+			});
+		}
+		else {
+			// compose with the stencils so far, so evaluation stays one product from the base
+			const TStencils previous = std::move(StencilsValue);
+			StencilsValue = BuildRows(refinement.Rows(), [&](unsigned row, TRow& entries) {
+				TRow local;
+				refinement.Row(row, local);
+				for (const auto& [column, weight] : local) {
+					for (unsigned i = previous.Start[column]; i < previous.Start[column + 1]; ++i) {
+						entries.emplace_back(previous.Columns[i], weight * previous.Weights[i]);
+					}
+				}
+			});
+		}
+
+		auto next = std::make_unique<TMeshSnapshot>();
+		refinement.Refine(*next);
+		std::vector<unsigned> nextOrigin(current->CornerCount());
+		NParallel::For(nextOrigin.size(), [&](size_t corner) {
+			nextOrigin[corner] = origin[current->CornerPolygon[corner]];
+		});
+		origin.swap(nextOrigin);
+
+		// the last level only needs its quads
+		if (step + 1 == level) {
+			snapshot = std::move(next);
+			break;
+		}
+		auto nextTopology = std::make_unique<TTopology>(*next);
+		currentCreases = refinement.RefineCreases(*nextTopology);
+		refined = std::move(nextTopology);
+		snapshot = std::move(next);
+		current = refined.get();
+	}
+
+	const unsigned quads = snapshot->PolygonCount();
+	Triangles.resize(2 * size_t(quads));
+	Polygons.resize(2 * size_t(quads));
+	NParallel::For(quads, [&](size_t quad) {
+		const unsigned* v = &snapshot->PolygonVertices[4 * quad];
+		Triangles[2 * quad] = {v[0], v[1], v[2]};
+		Triangles[2 * quad + 1] = {v[0], v[2], v[3]};
+		Polygons[2 * quad] = Polygons[2 * quad + 1] = origin[quad];
+	});
+}
+
+TBitSet TSubdivision::CreaseEdges(TMesh& mesh, const TTopology& topology, TMarkMode mode)
+{
+	TBitSet creases(topology.EdgeCount());
+	mesh.EachEdge([&](TEdge& edge) {
+		std::array<unsigned, 2> points{};
+		unsigned n = 0;
+		for (auto point : edge.Points()) {
+			points[n++] = point.Index();
+		}
+		const unsigned index = topology.FindEdge(points[0], points[1]);
+		if (index != TTopology::Invalid) {
+			creases.Set(index);
+		}
+	}, mode);
+	return creases;
+}
+
+unsigned TSubdivision::PointCount() const
+{
+	return StencilsValue.Rows();
+}
+
+const TSubdivision::TStencils& TSubdivision::Stencils() const
+{
+	return StencilsValue;
+}
+
+void TSubdivision::Evaluate(const std::vector<TVectorF>& base, std::vector<TVectorF>& result) const
+{
+	result.resize(PointCount());
+	NParallel::For(result.size(), [&](size_t row) {
+		TVectorF sum(0.0f);
+		for (unsigned i = StencilsValue.Start[row]; i < StencilsValue.Start[row + 1]; ++i) {
+			sum += StencilsValue.Weights[i] * base[StencilsValue.Columns[i]];
+		}
+		result[row] = sum;
+	});
+}
+
+std::vector<TVectorF> TSubdivision::Evaluate() const
+{
+	std::vector<TVectorF> result;
+	Evaluate(Topology.Snapshot.Positions, result);
+	return result;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "bitset.h"
+#include "mark.h"
+#include "topology.h"
+#include "vector.h"
+
+#include <array>
+#include <vector>
+
+class TMesh;
+
+// Catmull-Clark preview. Each level is a sparse matrix from the points of
+// the level above; the levels are multiplied out once, so evaluating new
+// base positions is a single parallel sparse matrix-vector product.
+// Crease edges and borders use the sharp rules: edge points at the
+// midpoint, points with two sharp edges on the crease curve and points with
+// more than two, or with non-manifold fans, kept in place.
+class TSubdivision
+{
+public:
+	static constexpr unsigned MaxLevel = 3;
+
+	// row r of the final level is sum(Weights[i] * base[Columns[i]]) over i in [Start[r], Start[r + 1])
+	struct TStencils
+	{
+		std::vector<unsigned> Start;
+		std::vector<unsigned> Columns;
+		std::vector<float> Weights;
+
+		unsigned Rows() const;
+	};
+
+	// level is clamped to [1, MaxLevel], creases are indexed by topology edge
+	TSubdivision(const TTopology& topology, unsigned level, const TBitSet& creases = TBitSet());
+
+	// edges marked with mode, indexed like topology edges
+	static TBitSet CreaseEdges(TMesh& mesh, const TTopology& topology, TMarkMode mode);
+
+	unsigned PointCount() const;
+	const TStencils& Stencils() const;
+
+	// base is indexed like the snapshot points
+	void Evaluate(const std::vector<TVectorF>& base, std::vector<TVectorF>& result) const;
+	std::vector<TVectorF> Evaluate() const;
+
+public:
+	// two per quad of the final level, indices into evaluated points
+	std::vector<std::array<unsigned, 3>> Triangles;
+	// base polygon each triangle comes from
+	std::vector<unsigned> Polygons;
+
+private:
+	const TTopology& Topology;
+	TStencils StencilsValue;
+};
@@ -0,0 +1,180 @@
+#include "topology.h"
+
+#include "mesh.h"
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+	// counting sort of items into buckets, each bucket sorted by less afterwards
+	template<typename FBucket, typename FLess>
+	void BucketSort(size_t itemCount, unsigned bucketCount, FBucket&& bucketOf, FLess&& less, std::vector<unsigned>& start, std::vector<unsigned>& items)
+	{
+		start.assign(bucketCount + 1, 0);
+		NParallel::For(itemCount, [&](size_t item) {
+			const unsigned bucket = bucketOf(static_cast<unsigned>(item));
+			if (bucket != TTopology::Invalid) {
+				std::atomic_ref<unsigned>(start[bucket]).fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+		items.resize(NParallel::ExclusiveScan(start));
+
+		std::vector<unsigned> cursor(start.begin(), start.end() - 1);
+		NParallel::For(itemCount, [&](size_t item) {
+			const unsigned bucket = bucketOf(static_cast<unsigned>(item));
+			if (bucket != TTopology::Invalid) {
+				items[std::atomic_ref<unsigned>(cursor[bucket]).fetch_add(1, std::memory_order_relaxed)] = static_cast<unsigned>(item);
+			}
+		});
+
+		NParallel::For(bucketCount, [&](size_t bucket) {
+			std::sort(items.begin() + start[bucket], items.begin() + start[bucket + 1], less);
+		}, 1024);
+	}
+} // anonymous namespace
+
+TTopology::TTopology(const TMeshSnapshot& snapshot)
+	: Snapshot(snapshot)
+{
+	const unsigned pointCount = Snapshot.PointCount();
+	const unsigned cornerCount = CornerCount();
+	const auto& vertices = Snapshot.PolygonVertices;
+
+	CornerPolygon.resize(cornerCount);
+	NParallel::For(Snapshot.PolygonCount(), [this](size_t polygon) {
+		std::fill(CornerPolygon.begin() + Snapshot.PolygonStart[polygon], CornerPolygon.begin() + Snapshot.PolygonStart[polygon + 1], static_cast<unsigned>(polygon));
+	}, 1024);
+
+	auto low = [&](unsigned corner) {
+		const unsigned a = vertices[corner];
+		const unsigned b = vertices[NextCorner(corner)];
+		return a == b ? Invalid : std::min(a, b);
+	};
+	auto high = [&](unsigned corner) {
+		return std::max(vertices[corner], vertices[NextCorner(corner)]);
+	};
+
+	// corners grouped by their lower point, then by higher point: each run is one edge
+	std::vector<unsigned> lowStart;
+	BucketSort(cornerCount, pointCount, low, [&high](unsigned a, unsigned b) {
+		const unsigned ha = high(a);
+		const unsigned hb = high(b);
+		return ha != hb ? ha < hb : a < b;
+	}, lowStart, EdgeCorners);
+
+	auto startsEdge = [&](unsigned point, unsigned slot) {
+		return slot == lowStart[point] || high(EdgeCorners[slot]) != high(EdgeCorners[slot - 1]);
+	};
+
+	std::vector<unsigned> edgeBase(pointCount + 1, 0);
+	NParallel::For(pointCount, [&](size_t point) {
+		for (unsigned slot = lowStart[point]; slot < lowStart[point + 1]; ++slot) {
+			edgeBase[point] += startsEdge(point, slot) ? 1 : 0;
+		}
+	}, 1024);
+	const unsigned edgeCount = NParallel::ExclusiveScan(edgeBase);
+
+	Edges.resize(edgeCount);
+	EdgeCornerStart.resize(edgeCount + 1);
+	EdgeCornerStart[edgeCount] = static_cast<unsigned>(EdgeCorners.size());
+	CornerEdge.assign(cornerCount, Invalid);
+	NParallel::For(pointCount, [&](size_t point) {
+		unsigned edge = edgeBase[point] - 1;
+		for (unsigned slot = lowStart[point]; slot < lowStart[point + 1]; ++slot) {
+			const unsigned corner = EdgeCorners[slot];
+			if (startsEdge(point, slot)) {
+				++edge;
+				Edges[edge] = {static_cast<unsigned>(point), high(corner)};
+				EdgeCornerStart[edge] = slot;
+			}
+			CornerEdge[corner] = edge;
+		}
+	}, 1024);
+
+	BucketSort(size_t(edgeCount) * 2, pointCount, [this](unsigned end) {
+		return Edges[end / 2][end % 2];
+	}, std::less<unsigned>(), PointEdgeStart, PointEdges);
+	NParallel::For(PointEdges.size(), [this](size_t slot) {
+		PointEdges[slot] /= 2;
+	});
+
+	BucketSort(cornerCount, pointCount, [&vertices](unsigned corner) {
+		return vertices[corner];
+	}, std::less<unsigned>(), PointCornerStart, PointCorners);
+}
+
+unsigned TTopology::PointCount() const
+{
+	return Snapshot.PointCount();
+}
+
+unsigned TTopology::PolygonCount() const
+{
+	return Snapshot.PolygonCount();
+}
+
+unsigned TTopology::EdgeCount() const
+{
+	return static_cast<unsigned>(Edges.size());
+}
+
+unsigned TTopology::CornerCount() const
+{
+	return static_cast<unsigned>(Snapshot.PolygonVertices.size());
+}
+
+unsigned TTopology::NextCorner(unsigned corner) const
+{
+	const unsigned polygon = CornerPolygon[corner];
+	return corner + 1 == Snapshot.PolygonStart[polygon + 1] ? Snapshot.PolygonStart[polygon] : corner + 1;
+}
+
+unsigned TTopology::PrevCorner(unsigned corner) const
+{
+	const unsigned polygon = CornerPolygon[corner];
+	return corner == Snapshot.PolygonStart[polygon] ? Snapshot.PolygonStart[polygon + 1] - 1 : corner - 1;
+}
+
+unsigned TTopology::EdgePolygonCount(unsigned edge) const
+{
+	return EdgeCornerStart[edge + 1] - EdgeCornerStart[edge];
+}
+
+bool TTopology::IsBoundary(unsigned edge) const
+{
+	return EdgePolygonCount(edge) == 1;
+}
+
+unsigned TTopology::OtherPoint(unsigned edge, unsigned point) const
+{
+	return Edges[edge][0] == point ? Edges[edge][1] : Edges[edge][0];
+}
+
+unsigned TTopology::FindEdge(unsigned a, unsigned b) const
+{
+	const std::array<unsigned, 2> key = {std::min(a, b), std::max(a, b)};
+	const auto begin = PointEdges.begin() + PointEdgeStart[key[0]];
+	const auto end = PointEdges.begin() + PointEdgeStart[key[0] + 1];
+	const auto found = std::lower_bound(begin, end, key, [this](unsigned edge, const std::array<unsigned, 2>& key) {
+		return Edges[edge] < key;
+	});
+	return found != end && Edges[*found] == key ? *found : Invalid;
+}
+
+unsigned TTopology::Valence(unsigned point) const
+{
+	return PointEdgeStart[point + 1] - PointEdgeStart[point];
+}
+
+void TTopology::MarkEdges(TMesh& mesh, const TBitSet& edges, TMarkMode mode) const
+{
+	auto edge = mesh.InitEdge();
+	edges.ForEach([&](unsigned index) {
+		if (edge.SelectEndpoints(Snapshot.PointIds[Edges[index][0]], Snapshot.PointIds[Edges[index][1]]) == LXe_OK) {
+			edge.SetMarks(mode.Mode);
+		}
+	});
+	mesh.AddChange(LXf_MESHEDIT_UPDATE);
+}
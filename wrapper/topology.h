@@ -0,0 +1,64 @@
+#pragma once
+
+#include "bitset.h"
+#include "mark.h"
+
+#include <array>
+#include <limits>
+#include <vector>
+
+class TMesh;
+class TMeshSnapshot;
+
+// Edge and adjacency tables derived from a snapshot without touching the host.
+// A corner is a slot of PolygonVertices; corner c of a polygon starts the
+// edge running from its vertex to the vertex of the next corner. Edges are
+// numbered by (lower point, higher point), so the numbering only depends on
+// the snapshot, not on host enumeration order.
+class TTopology
+{
+public:
+	static constexpr unsigned Invalid = std::numeric_limits<unsigned>::max();
+
+	explicit TTopology(const TMeshSnapshot& snapshot);
+	TTopology(const TTopology& rhs) = delete;
+	TTopology& operator=(const TTopology& rhs) = delete;
+
+	unsigned PointCount() const;
+	unsigned PolygonCount() const;
+	unsigned EdgeCount() const;
+	unsigned CornerCount() const;
+
+	unsigned NextCorner(unsigned corner) const;
+	unsigned PrevCorner(unsigned corner) const;
+
+	// number of polygon sides using the edge, 1 on boundaries
+	unsigned EdgePolygonCount(unsigned edge) const;
+	bool IsBoundary(unsigned edge) const;
+	unsigned OtherPoint(unsigned edge, unsigned point) const;
+	// edge joining a and b, Invalid if there is none
+	unsigned FindEdge(unsigned a, unsigned b) const;
+	unsigned Valence(unsigned point) const;
+
+	void MarkEdges(TMesh& mesh, const TBitSet& edges, TMarkMode mode) const;
+
+public:
+	const TMeshSnapshot& Snapshot;
+
+	// lower point index first
+	std::vector<std::array<unsigned, 2>> Edges;
+
+	std::vector<unsigned> CornerPolygon;
+	// Invalid for corners repeating their successor's point
+	std::vector<unsigned> CornerEdge;
+
+	// corners of edge e are EdgeCorners[EdgeCornerStart[e] .. EdgeCornerStart[e + 1]), ascending
+	std::vector<unsigned> EdgeCornerStart;
+	std::vector<unsigned> EdgeCorners;
+
+	// edges and corners around a point, ascending
+	std::vector<unsigned> PointEdgeStart;
+	std::vector<unsigned> PointEdges;
+	std::vector<unsigned> PointCornerStart;
+	std::vector<unsigned> PointCorners;
+};
@@ -0,0 +1,184 @@
+#include "topology_report.h"
+
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+	constexpr size_t ReportGrain = 2048;
+
+	// indices in [0, count) passing test, ascending
+	template<typename F>
+	std::vector<unsigned> Collect(size_t count, F&& test)
+	{
+		std::vector<std::vector<unsigned>> chunks(NParallel::ChunkCount(count, ReportGrain));
+		NParallel::ForChunks(count, [&](unsigned chunk, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				if (test(static_cast<unsigned>(i))) {
+					chunks[chunk].push_back(static_cast<unsigned>(i));
+				}
+			}
+		}, ReportGrain);
+
+		std::vector<unsigned> result;
+		for (const auto& chunk : chunks) {
+			result.insert(result.end(), chunk.begin(), chunk.end());
+		}
+		return result;
+	}
+
+	unsigned Find(std::vector<unsigned>& parents, unsigned i)
+	{
+		while (parents[i] != i) {
+			i = parents[i] = parents[parents[i]];
+		}
+		return i;
+	}
+
+	TBitSet ToBitSet(unsigned size, const std::vector<unsigned>& indices)
+	{
+		TBitSet bits(size);
+		for (const unsigned index : indices) {
+			bits.Set(index);
+		}
+		return bits;
+	}
+} // anonymous namespace
+
+TTopologyReport::TTopologyReport(const TTopology& topology)
+	: Topology(topology)
+{
+	const TMeshSnapshot& snapshot = topology.Snapshot;
+	const auto& vertices = snapshot.PolygonVertices;
+
+	NonManifoldEdges = Collect(topology.EdgeCount(), [&topology](unsigned edge) {
+		return topology.EdgePolygonCount(edge) > 2;
+	});
+
+	FlippedEdges = Collect(topology.EdgeCount(), [&](unsigned edge) {
+		if (topology.EdgePolygonCount(edge) != 2) {
+			return false;
+		}
+		const unsigned slot = topology.EdgeCornerStart[edge];
+		return vertices[topology.EdgeCorners[slot]] == vertices[topology.EdgeCorners[slot + 1]];
+	});
+
+	IsolatedPoints = Collect(topology.PointCount(), [&topology](unsigned point) {
+		return topology.PointCornerStart[point] == topology.PointCornerStart[point + 1];
+	});
+
+	NonManifoldPoints = Collect(topology.PointCount(), [&](unsigned point) {
+		const unsigned begin = topology.PointCornerStart[point];
+		const unsigned count = topology.PointCornerStart[point + 1] - begin;
+		if (count < 2) {
+			return false;
+		}
+
+		// corners around the point joined across manifold edges, one set per fan
+		std::vector<unsigned> parents(count);
+		std::iota(parents.begin(), parents.end(), 0u);
+		const unsigned* corners = topology.PointCorners.data() + begin;
+		auto slotOf = [&](unsigned corner) {
+			return static_cast<unsigned>(std::lower_bound(corners, corners + count, corner) - corners);
+		};
+
+		unsigned fans = count;
+		for (unsigned i = 0; i < count; ++i) {
+			// the edges leaving and reaching the point in this polygon
+			for (const unsigned side : {corners[i], topology.PrevCorner(corners[i])}) {
+				const unsigned edge = topology.CornerEdge[side];
+				if (edge == TTopology::Invalid || topology.EdgePolygonCount(edge) != 2) {
+					continue;
+				}
+				const unsigned slot = topology.EdgeCornerStart[edge];
+				const unsigned first = topology.EdgeCorners[slot];
+				const unsigned other = first == side ? topology.EdgeCorners[slot + 1] : first;
+				const unsigned across = vertices[other] == point ? other : topology.NextCorner(other);
+				const unsigned a = Find(parents, i);
+				const unsigned b = Find(parents, slotOf(across));
+				if (a != b) {
+					parents[a] = b;
+					--fans;
+				}
+			}
+		}
+		return fans > 1;
+	});
+
+	DegeneratePolygons = Collect(snapshot.PolygonCount(), [&](unsigned polygon) {
+		const unsigned begin = snapshot.PolygonStart[polygon];
+		const unsigned end = snapshot.PolygonStart[polygon + 1];
+		if (end - begin < 3) {
+			return true;
+		}
+
+		// Newell normal against the squared longest edge
+		TVectorD normal(0.0);
+		double longest = 0.0;
+		for (unsigned corner = begin; corner < end; ++corner) {
+			if (topology.CornerEdge[corner] == TTopology::Invalid) {
+				return true;
+			}
+			const TVectorD a(snapshot.Positions[vertices[corner]]);
+			const TVectorD b(snapshot.Positions[vertices[topology.NextCorner(corner)]]);
+			normal += glm::cross(a, b);
+			longest = std::max(longest, glm::dot(b - a, b - a));
+		}
+		return glm::length(normal) <= 1e-10 * longest;
+	});
+
+	// equal sorted point lists, the lowest polygon of a group is kept
+	const unsigned polygonCount = snapshot.PolygonCount();
+	std::vector<unsigned> sorted(vertices);
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		std::sort(sorted.begin() + snapshot.PolygonStart[polygon], sorted.begin() + snapshot.PolygonStart[polygon + 1]);
+	}, 1024);
+
+	auto less = [&](unsigned a, unsigned b) {
+		const auto beginA = sorted.begin() + snapshot.PolygonStart[a];
+		const auto beginB = sorted.begin() + snapshot.PolygonStart[b];
+		const unsigned countA = snapshot.VertexCount(a);
+		const unsigned countB = snapshot.VertexCount(b);
+		if (countA != countB) {
+			return countA < countB;
+		}
+		return std::lexicographical_compare(beginA, beginA + countA, beginB, beginB + countB);
+	};
+
+	std::vector<unsigned> order(polygonCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::sort(order.begin(), order.end(), [&less](unsigned a, unsigned b) {
+		return less(a, b) || (!less(b, a) && a < b);
+	});
+
+	DuplicatePolygons = Collect(polygonCount, [&](unsigned i) {
+		return i > 0 && !less(order[i - 1], order[i]);
+	});
+	for (auto& polygon : DuplicatePolygons) {
+		polygon = order[polygon];
+	}
+	std::sort(DuplicatePolygons.begin(), DuplicatePolygons.end());
+}
+
+bool TTopologyReport::Clean() const
+{
+	return NonManifoldEdges.empty() && NonManifoldPoints.empty() && IsolatedPoints.empty()
+		&& DuplicatePolygons.empty() && FlippedEdges.empty() && DegeneratePolygons.empty();
+}
+
+void TTopologyReport::Mark(TMesh& mesh, TMarkMode mode) const
+{
+	TBitSet points = ToBitSet(Topology.PointCount(), NonManifoldPoints);
+	points |= ToBitSet(Topology.PointCount(), IsolatedPoints);
+	Topology.Snapshot.MarkPoints(mesh, points, mode);
+
+	TBitSet edges = ToBitSet(Topology.EdgeCount(), NonManifoldEdges);
+	edges |= ToBitSet(Topology.EdgeCount(), FlippedEdges);
+	Topology.MarkEdges(mesh, edges, mode);
+
+	TBitSet polygons = ToBitSet(Topology.PolygonCount(), DuplicatePolygons);
+	polygons |= ToBitSet(Topology.PolygonCount(), DegeneratePolygons);
+	Topology.Snapshot.MarkPolygons(mesh, polygons, mode);
+}
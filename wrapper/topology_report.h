@@ -0,0 +1,37 @@
+#pragma once
+
+#include "mark.h"
+#include "topology.h"
+
+#include <vector>
+
+class TMesh;
+
+// Topology defects of a whole mesh, each list ascending.
+// Every category is computed by one parallel sweep over the topology tables.
+class TTopologyReport
+{
+public:
+	explicit TTopologyReport(const TTopology& topology);
+
+	bool Clean() const;
+
+	// marks the offending points, edges and polygons
+	void Mark(TMesh& mesh, TMarkMode mode) const;
+
+public:
+	// edges shared by more than two polygons
+	std::vector<unsigned> NonManifoldEdges;
+	// points whose polygons form more than one fan
+	std::vector<unsigned> NonManifoldPoints;
+	std::vector<unsigned> IsolatedPoints;
+	// polygons over the same points as a lower indexed one
+	std::vector<unsigned> DuplicatePolygons;
+	// edges whose two polygons run along it in the same direction
+	std::vector<unsigned> FlippedEdges;
+	// fewer than three distinct points, repeated points or no area
+	std::vector<unsigned> DegeneratePolygons;
+
+private:
+	const TTopology& Topology;
+};
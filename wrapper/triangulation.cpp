@@ -0,0 +1,50 @@
+#include "triangulation.h"
+
+#include "parallel.h"
+#include "snapshot.h"
+
+#include <algorithm>
+
+TTriangulation::TTriangulation(const TMeshSnapshot& snapshot)
+	: Snapshot(snapshot)
+{
+	const unsigned polygonCount = Snapshot.PolygonCount();
+	std::vector<unsigned> start(polygonCount + 1, 0);
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		start[polygon] = std::max(Snapshot.VertexCount(static_cast<unsigned>(polygon)), 2u) - 2;
+	});
+
+	const unsigned count = NParallel::ExclusiveScan(start);
+	Triangles.resize(count);
+	Polygons.resize(count);
+
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		const unsigned* vertices = Snapshot.PolygonVertices.data() + Snapshot.PolygonStart[polygon];
+		for (unsigned i = 0; i < start[polygon + 1] - start[polygon]; ++i) {
+			Triangles[start[polygon] + i] = { vertices[0], vertices[i + 1], vertices[i + 2] };
+			Polygons[start[polygon] + i] = static_cast<unsigned>(polygon);
+		}
+	});
+}
+
+unsigned TTriangulation::Count() const
+{
+	return static_cast<unsigned>(Triangles.size());
+}
+
+std::array<TVectorF, 3> TTriangulation::Corners(unsigned triangle) const
+{
+	const auto& t = Triangles[triangle];
+	return { Snapshot.Positions[t[0]], Snapshot.Positions[t[1]], Snapshot.Positions[t[2]] };
+}
+
+std::vector<TBox> TTriangulation::Bounds() const
+{
+	std::vector<TBox> bounds(Count());
+	NParallel::For(bounds.size(), [&](size_t triangle) {
+		for (const auto& corner : Corners(static_cast<unsigned>(triangle))) {
+			bounds[triangle].Extend(corner);
+		}
+	});
+	return bounds;
+}
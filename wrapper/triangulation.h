@@ -0,0 +1,26 @@
+#pragma once
+
+#include "bounds.h"
+
+#include <array>
+#include <vector>
+
+class TMeshSnapshot;
+
+// Fan triangulation of snapshot polygons, exact for convex faces.
+// Polygons with fewer than three vertices produce no triangles.
+class TTriangulation
+{
+public:
+	explicit TTriangulation(const TMeshSnapshot& snapshot);
+
+	unsigned Count() const;
+	std::array<TVectorF, 3> Corners(unsigned triangle) const;
+	std::vector<TBox> Bounds() const;
+
+public:
+	const TMeshSnapshot& Snapshot;
+	std::vector<std::array<unsigned, 3>> Triangles;
+	// source polygon per triangle
+	std::vector<unsigned> Polygons;
+};
@@ -0,0 +1,95 @@
+#include "uv_seams.h"
+
+#include "mesh_map.h"
+#include "parallel.h"
+#include "snapshot.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+	unsigned Find(std::vector<unsigned>& parent, unsigned index)
+	{
+		while (parent[index] != index) {
+			parent[index] = parent[parent[index]];
+			index = parent[index];
+		}
+		return index;
+	}
+} // anonymous namespace
+
+TUVSeams::TUVSeams(const TTopology& topology, const TMeshMapView& map, float tolerance)
+	: Seams(topology.EdgeCount())
+	, PolygonIsland(topology.PolygonCount())
+{
+	// without a map nothing joins: no seams, one island per polygon
+	if (!map.Valid()) {
+		std::iota(PolygonIsland.begin(), PolygonIsland.end(), 0u);
+		IslandCountValue = topology.PolygonCount();
+		return;
+	}
+
+	const auto& vertices = topology.Snapshot.PolygonVertices;
+	const unsigned dimension = map.Dimension();
+
+	auto same = [&](unsigned a, unsigned b) {
+		const float* va = map.Evaluate(a);
+		const float* vb = map.Evaluate(b);
+		if (!va || !vb) {
+			return va == vb;
+		}
+		for (unsigned i = 0; i < dimension; ++i) {
+			if (std::abs(va[i] - vb[i]) > tolerance) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	// the corner of polygon side c holding point, c itself or the next one
+	auto cornerAt = [&](unsigned corner, unsigned point) {
+		return vertices[corner] == point ? corner : topology.NextCorner(corner);
+	};
+
+	NParallel::For(topology.EdgeCount(), [&](size_t edge) {
+		const unsigned begin = topology.EdgeCornerStart[edge];
+		const unsigned end = topology.EdgeCornerStart[edge + 1];
+		const auto& points = topology.Edges[edge];
+		const unsigned first = topology.EdgeCorners[begin];
+		for (unsigned slot = begin + 1; slot < end; ++slot) {
+			const unsigned corner = topology.EdgeCorners[slot];
+			if (!same(cornerAt(first, points[0]), cornerAt(corner, points[0])) || !same(cornerAt(first, points[1]), cornerAt(corner, points[1]))) {
+				Seams.SetAtomic(static_cast<unsigned>(edge));
+				break;
+			}
+		}
+	});
+
+	std::vector<unsigned> parent(topology.PolygonCount());
+	std::iota(parent.begin(), parent.end(), 0u);
+	for (unsigned edge = 0; edge < topology.EdgeCount(); ++edge) {
+		if (Seams.Test(edge)) {
+			continue;
+		}
+		const unsigned begin = topology.EdgeCornerStart[edge];
+		const unsigned first = topology.CornerPolygon[topology.EdgeCorners[begin]];
+		for (unsigned slot = begin + 1; slot < topology.EdgeCornerStart[edge + 1]; ++slot) {
+			const unsigned a = Find(parent, first);
+			const unsigned b = Find(parent, topology.CornerPolygon[topology.EdgeCorners[slot]]);
+			// the lower polygon stays root, so islands number in polygon order
+			parent[std::max(a, b)] = std::min(a, b);
+		}
+	}
+
+	for (unsigned polygon = 0; polygon < PolygonIsland.size(); ++polygon) {
+		const unsigned root = Find(parent, polygon);
+		PolygonIsland[polygon] = root == polygon ? IslandCountValue++ : PolygonIsland[root];
+	}
+}
+
+unsigned TUVSeams::IslandCount() const
+{
+	return IslandCountValue;
+}
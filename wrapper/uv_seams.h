@@ -0,0 +1,29 @@
+#pragma once
+
+#include "bitset.h"
+
+#include <vector>
+
+class TMeshMapView;
+class TTopology;
+
+// UV seams from per corner values: an edge is a seam when the polygons
+// sharing it disagree on the value at either end. Islands are groups of
+// polygons joined across edges that are neither seams nor boundaries,
+// numbered in order of their lowest polygon. An invalid map gives no
+// seams and one island per polygon.
+class TUVSeams
+{
+public:
+	TUVSeams(const TTopology& topology, const TMeshMapView& map, float tolerance = 1e-6f);
+
+	unsigned IslandCount() const;
+
+public:
+	// indexed like topology edges
+	TBitSet Seams;
+	std::vector<unsigned> PolygonIsland;
+
+private:
+	unsigned IslandCountValue = 0;
+};
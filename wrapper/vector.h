@@ -6,7 +6,7 @@
 using TVectorF = glm::vec3;
 using TVectorD = glm::dvec3;
 
-TVectorF project(const TVectorF& p, const TVectorF& proj)
+inline TVectorF project(const TVectorF& p, const TVectorF& proj)
 {
 	if (proj == glm::vec3(0, 0, 0)) {
 		return glm::vec3(0, 0, 0);
@@ -0,0 +1,244 @@
+#include "weld.h"
+
+#include "mesh.h"
+#include "parallel.h"
+#include "snapshot.h"
+#include "spatial_hash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+
+namespace {
+	constexpr unsigned Invalid = TSpatialHash::Invalid;
+} // anonymous namespace
+
+TWeld::TWeld(const TMeshSnapshot& snapshot, float tolerance, EPosition position, const std::vector<uint8_t>& active)
+	: Snapshot(snapshot)
+{
+	Cluster(tolerance, position, active);
+	RewritePolygons();
+}
+
+const std::vector<unsigned>& TWeld::Remap() const
+{
+	return RemapValue;
+}
+
+unsigned TWeld::MergedCount() const
+{
+	return static_cast<unsigned>(Merged.size());
+}
+
+unsigned TWeld::ChangedPolygonCount() const
+{
+	return static_cast<unsigned>(Changed.size());
+}
+
+unsigned TWeld::DegeneratePolygonCount() const
+{
+	return static_cast<unsigned>(Degenerate.size());
+}
+
+void TWeld::Cluster(float tolerance, EPosition position, const std::vector<uint8_t>& active)
+{
+	if (tolerance <= 0.0f) {
+		ClusterExact(active);
+		return;
+	}
+
+	const unsigned count = Snapshot.PointCount();
+	auto isActive = [&active](unsigned point) {
+		return active.empty() || active[point];
+	};
+
+	std::vector<TVectorF> queries;
+	std::vector<unsigned> queryPoints;
+	for (unsigned point = 0; point < count; ++point) {
+		if (isActive(point)) {
+			queries.push_back(Snapshot.Positions[point]);
+			queryPoints.push_back(point);
+		}
+	}
+
+	const TSpatialHash grid(Snapshot.Positions, tolerance);
+	const auto neighbours = grid.BatchRadius(queries, tolerance);
+
+	RemapValue.assign(count, Invalid);
+	for (unsigned query = 0; query < queryPoints.size(); ++query) {
+		const unsigned point = queryPoints[query];
+		if (RemapValue[point] != Invalid) {
+			continue;
+		}
+
+		RemapValue[point] = point;
+		TVectorF sum = Snapshot.Positions[point];
+		unsigned clusterSize = 1;
+		for (unsigned slot = neighbours.Offsets[query]; slot < neighbours.Offsets[query + 1]; ++slot) {
+			const unsigned other = neighbours.Indices[slot];
+			if (RemapValue[other] == Invalid && isActive(other)) {
+				RemapValue[other] = point;
+				Merged.push_back(other);
+				sum += Snapshot.Positions[other];
+				++clusterSize;
+			}
+		}
+
+		if (position == EPosition::Average && clusterSize > 1) {
+			Moved.push_back(point);
+			MovedPositions.push_back(sum / static_cast<float>(clusterSize));
+		}
+	}
+
+	for (unsigned point = 0; point < count; ++point) {
+		if (RemapValue[point] == Invalid) {
+			RemapValue[point] = point;
+		}
+	}
+	std::sort(Merged.begin(), Merged.end());
+}
+
+void TWeld::ClusterExact(const std::vector<uint8_t>& active)
+{
+	const unsigned count = Snapshot.PointCount();
+	const auto& positions = Snapshot.Positions;
+
+	// equal positions end up next to each other, lowest index first
+	std::vector<unsigned> order;
+	for (unsigned point = 0; point < count; ++point) {
+		const TVectorF& pos = positions[point];
+		if ((active.empty() || active[point]) && !std::isnan(pos.x) && !std::isnan(pos.y) && !std::isnan(pos.z)) {
+			order.push_back(point);
+		}
+	}
+	std::sort(order.begin(), order.end(), [&positions](unsigned a, unsigned b) {
+		const TVectorF& p = positions[a];
+		const TVectorF& q = positions[b];
+		return std::tie(p.x, p.y, p.z, a) < std::tie(q.x, q.y, q.z, b);
+	});
+
+	RemapValue.resize(count);
+	std::iota(RemapValue.begin(), RemapValue.end(), 0u);
+	for (size_t first = 0; first < order.size();) {
+		size_t last = first + 1;
+		for (; last < order.size() && positions[order[last]] == positions[order[first]]; ++last) {
+			RemapValue[order[last]] = order[first];
+			Merged.push_back(order[last]);
+		}
+		first = last;
+	}
+	std::sort(Merged.begin(), Merged.end());
+}
+
+void TWeld::RewritePolygons()
+{
+	const unsigned polygonCount = Snapshot.PolygonCount();
+	if (Merged.empty()) {
+		return;
+	}
+
+	// 0 - untouched, 1 - rewritten, 2 - collapsed
+	std::vector<uint8_t> state(polygonCount, 0);
+	std::vector<unsigned> newCount(polygonCount + 1, 0);
+
+	NParallel::For(polygonCount, [&](size_t polygon) {
+		const unsigned begin = Snapshot.PolygonStart[polygon];
+		const unsigned end = Snapshot.PolygonStart[polygon + 1];
+
+		bool changed = false;
+		for (unsigned slot = begin; slot < end && !changed; ++slot) {
+			const unsigned point = Snapshot.PolygonVertices[slot];
+			changed = RemapValue[point] != point;
+		}
+		if (!changed) {
+			return;
+		}
+
+		unsigned distinct = 0;
+		for (unsigned slot = begin; slot < end; ++slot) {
+			const unsigned point = RemapValue[Snapshot.PolygonVertices[slot]];
+			const unsigned prev = RemapValue[Snapshot.PolygonVertices[slot == begin ? end - 1 : slot - 1]];
+			distinct += point != prev ? 1 : 0;
+		}
+
+		const unsigned minimum = std::min(end - begin, 3u);
+		state[polygon] = std::max(distinct, 1u) < minimum ? 2 : 1;
+		newCount[polygon] = state[polygon] == 1 ? std::max(distinct, 1u) : 0;
+	});
+
+	for (unsigned polygon = 0; polygon < polygonCount; ++polygon) {
+		if (state[polygon] == 1) {
+			Changed.push_back(polygon);
+			ChangedStart.push_back(newCount[polygon]);
+		}
+		else if (state[polygon] == 2) {
+			Degenerate.push_back(polygon);
+		}
+	}
+	ChangedStart.push_back(0);
+	ChangedVertices.resize(NParallel::ExclusiveScan(ChangedStart));
+
+	NParallel::For(Changed.size(), [&](size_t changed) {
+		const unsigned polygon = Changed[changed];
+		const unsigned begin = Snapshot.PolygonStart[polygon];
+		const unsigned end = Snapshot.PolygonStart[polygon + 1];
+
+		unsigned out = ChangedStart[changed];
+		for (unsigned slot = begin; slot < end; ++slot) {
+			const unsigned point = RemapValue[Snapshot.PolygonVertices[slot]];
+			const unsigned prev = RemapValue[Snapshot.PolygonVertices[slot == begin ? end - 1 : slot - 1]];
+			if (point != prev) {
+				ChangedVertices[out++] = point;
+			}
+		}
+		// every vertex collapsed onto one point
+		if (out == ChangedStart[changed]) {
+			ChangedVertices[out] = RemapValue[Snapshot.PolygonVertices[begin]];
+		}
+	});
+}
+
+void TWeld::Apply(TMesh& mesh) const
+{
+	if (Merged.empty()) {
+		return;
+	}
+
+	mesh.BeginEditBatch();
+
+	auto polygon = mesh.InitPolygon();
+	std::vector<LXtPointID> vertices;
+	for (unsigned changed = 0; changed < Changed.size(); ++changed) {
+		vertices.clear();
+		for (unsigned slot = ChangedStart[changed]; slot < ChangedStart[changed + 1]; ++slot) {
+			vertices.push_back(Snapshot.PointIds[ChangedVertices[slot]]);
+		}
+		polygon.Select(Snapshot.PolygonIds[Changed[changed]]);
+		polygon.SetVertexList(vertices.data(), static_cast<unsigned>(vertices.size()), 0);
+	}
+	mesh.AddChange(LXf_MESHEDIT_POLYGONS);
+
+	for (const unsigned degenerate : Degenerate) {
+		polygon.Select(Snapshot.PolygonIds[degenerate]);
+		polygon.Remove();
+	}
+
+	auto point = mesh.InitPoint();
+	for (unsigned moved = 0; moved < Moved.size(); ++moved) {
+		const TVectorD pos(MovedPositions[moved]);
+		point.Select(Snapshot.PointIds[Moved[moved]]);
+		point.SetPos(&pos.x);
+	}
+	if (!Moved.empty()) {
+		mesh.AddChange(LXf_MESHEDIT_POSITION);
+	}
+
+	for (const unsigned merged : Merged) {
+		point.Select(Snapshot.PointIds[merged]);
+		point.Remove();
+	}
+	mesh.AddChange(LXf_MESHEDIT_POINTS);
+
+	mesh.EndEditBatch();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstdint>
+#include <vector>
+
+class TMesh;
+class TMeshSnapshot;
+
+// Merge by distance. Points are visited in index order and each point not
+// yet merged becomes the representative of every free point within
+// tolerance, so the result does not depend on thread scheduling.
+class TWeld
+{
+public:
+	enum class EPosition
+	{
+		Representative,
+		Average,
+	};
+
+	// active is indexed by point, empty means every point takes part
+	TWeld(const TMeshSnapshot& snapshot, float tolerance, EPosition position = EPosition::Representative, const std::vector<uint8_t>& active = {});
+
+	// representative per point, points not merged map to themselves
+	const std::vector<unsigned>& Remap() const;
+	unsigned MergedCount() const;
+	unsigned ChangedPolygonCount() const;
+	unsigned DegeneratePolygonCount() const;
+
+	// rewrites polygons, removes degenerate ones and the merged points in one edit batch
+	void Apply(TMesh& mesh) const;
+
+private:
+	void Cluster(float tolerance, EPosition position, const std::vector<uint8_t>& active);
+	// zero tolerance, groups equal positions by sorting instead of a grid
+	void ClusterExact(const std::vector<uint8_t>& active);
+	void RewritePolygons();
+
+private:
+	const TMeshSnapshot& Snapshot;
+
+	std::vector<unsigned> RemapValue;
+	std::vector<unsigned> Merged;
+	std::vector<unsigned> Moved;
+	std::vector<TVectorF> MovedPositions;
+
+	std::vector<unsigned> Changed;
+	std::vector<unsigned> ChangedStart;
+	std::vector<unsigned> ChangedVertices;
+	std::vector<unsigned> Degenerate;
+};